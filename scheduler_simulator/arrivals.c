@@ -0,0 +1,494 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "arrivals.h"
+
+static int sort_enabled = 0;
+static size_t sort_memory = SORT_DEFAULT_MEMORY;
+
+static void *checked(void *ptr)
+{
+    if (ptr == NULL)
+    {
+        fprintf(stderr, "arrivals: out of memory\n");
+        exit(1);
+    }
+    return ptr;
+}
+
+// ---------------------------------------------------------------------------
+// Cursor
+// ---------------------------------------------------------------------------
+
+typedef struct Arrival
+{
+    sim_time_t time;
+    int index;
+} Arrival;
+
+static int by_arrival(const void *a, const void *b)
+{
+    const Arrival *x = a, *y = b;
+    if (x->time != y->time)
+        return x->time < y->time ? -1 : 1;
+    return x->index - y->index;
+}
+
+void arrivals_begin(ArrivalCursor *c, const Process processes[], int num_processes)
+{
+    c->order = NULL;
+    c->count = num_processes;
+    c->next = 0;
+
+    int sorted = 1;
+    for (int i = 1; i < num_processes && sorted; i++)
+        sorted = processes[i].arrival_time >= processes[i - 1].arrival_time;
+    if (sorted)
+        return;
+
+    Arrival *arrivals = checked(malloc(num_processes * sizeof(Arrival)));
+    for (int i = 0; i < num_processes; i++)
+        arrivals[i] = (Arrival){processes[i].arrival_time, i};
+    qsort(arrivals, num_processes, sizeof(Arrival), by_arrival);
+
+    c->order = checked(malloc(num_processes * sizeof(int)));
+    for (int i = 0; i < num_processes; i++)
+        c->order[i] = arrivals[i].index;
+    free(arrivals);
+}
+
+void arrivals_end(ArrivalCursor *c)
+{
+    free(c->order);
+    c->order = NULL;
+}
+
+// ---------------------------------------------------------------------------
+// External merge sort of workload files
+// ---------------------------------------------------------------------------
+
+void arrivals_configure_sort(int enabled, size_t memory)
+{
+    sort_enabled = enabled;
+    sort_memory = memory;
+}
+
+int arrivals_sort_enabled(void)
+{
+    return sort_enabled;
+}
+
+int arrivals_parse_memory(const char *s, size_t *bytes)
+{
+    if (*s < '0' || *s > '9')
+        return -1;
+
+    char *end;
+    unsigned long long v = strtoull(s, &end, 10);
+    int shift = 0;
+    switch (*end)
+    {
+    case 'K': case 'k': shift = 10; end++; break;
+    case 'M': case 'm': shift = 20; end++; break;
+    case 'G': case 'g': shift = 30; end++; break;
+    }
+    if (*end != '\0' || v == 0 || v > (SIZE_MAX >> shift))
+        return -1;
+    *bytes = (size_t)v << shift;
+    return 0;
+}
+
+//* One line in a run: (arrival, line number) orders it, ties cannot happen
+typedef struct SortRecord
+{
+    sim_time_t key;
+    uint64_t seq;
+    size_t offset;          // into the run's text
+    uint32_t length;        // without the newline
+} SortRecord;
+
+static int by_key(const void *a, const void *b)
+{
+    const SortRecord *x = a, *y = b;
+    if (x->key != y->key)
+        return x->key < y->key ? -1 : 1;
+    return x->seq < y->seq ? -1 : x->seq > y->seq;
+}
+
+// Arrival of a process line: the first token after the pid that is not a
+// key=value attribute, as load_workload() reads it
+static int line_arrival(const char *line, sim_time_t *arrival)
+{
+    int field = 0;
+    for (const char *c = line; *(c += strspn(c, " \t\r\n")) != '\0'; )
+    {
+        size_t length = strcspn(c, " \t\r\n");
+        if (memchr(c, '=', length) == NULL && field++ == 1)
+        {
+            char token[64];
+            if (length >= sizeof(token))
+                return -1;
+            memcpy(token, c, length);
+            token[length] = '\0';
+            return sim_parse_duration(token, arrival);
+        }
+        c += length;
+    }
+    return -1;
+}
+
+// Spill file next to out, already unlinked: it goes away when closed
+static FILE *new_run(const char *out)
+{
+    char *name = checked(malloc(strlen(out) + sizeof(".runXXXXXX")));
+    sprintf(name, "%s.runXXXXXX", out);
+    int fd = mkstemp(name);
+    if (fd < 0)
+    {
+        perror(name);
+        free(name);
+        return NULL;
+    }
+    unlink(name);
+    free(name);
+    return fdopen(fd, "w+b");
+}
+
+static int write_record(FILE *f, sim_time_t key, uint64_t seq, const char *line, uint32_t length)
+{
+    return fwrite(&key, sizeof(key), 1, f) == 1 && fwrite(&seq, sizeof(seq), 1, f) == 1 &&
+           fwrite(&length, sizeof(length), 1, f) == 1 && fwrite(line, 1, length, f) == length ? 0 : -1;
+}
+
+//* Sort the records in memory and write them to a new run file
+static FILE *spill(const char *out, SortRecord *records, int count, const char *text)
+{
+    qsort(records, count, sizeof(SortRecord), by_key);
+
+    FILE *run = new_run(out);
+    if (run == NULL)
+        return NULL;
+    for (int i = 0; i < count; i++)
+    {
+        if (write_record(run, records[i].key, records[i].seq, text + records[i].offset, records[i].length) != 0)
+        {
+            perror(out);
+            fclose(run);
+            return NULL;
+        }
+    }
+    return run;
+}
+
+typedef struct RunReader
+{
+    FILE *f;
+    sim_time_t key;
+    uint64_t seq;
+    uint32_t length;
+    char *line;
+    uint32_t capacity;
+} RunReader;
+
+// 1: read a record, 0: end of run
+static int read_record(RunReader *r)
+{
+    if (fread(&r->key, sizeof(r->key), 1, r->f) != 1)
+        return 0;
+    if (fread(&r->seq, sizeof(r->seq), 1, r->f) != 1 || fread(&r->length, sizeof(r->length), 1, r->f) != 1)
+        return 0;
+    if (r->length > r->capacity)
+    {
+        r->capacity = r->length;
+        r->line = checked(realloc(r->line, r->capacity));
+    }
+    return fread(r->line, 1, r->length, r->f) == r->length;
+}
+
+static int reader_before(const RunReader *a, const RunReader *b)
+{
+    return a->key < b->key || (a->key == b->key && a->seq < b->seq);
+}
+
+// Merge count runs into dest, as text lines if text, else as another run.
+// Closes the runs.
+static int merge(FILE **runs, int count, FILE *dest, int text)
+{
+    RunReader *readers = checked(calloc(count, sizeof(RunReader)));
+    int *heap = checked(malloc(count * sizeof(int)));
+    int size = 0;
+
+    //* Min-heap of readers on their current record
+    for (int r = 0; r < count; r++)
+    {
+        readers[r].f = runs[r];
+        rewind(runs[r]);
+        if (!read_record(&readers[r]))
+            continue;
+        int i = size++;
+        while (i > 0 && reader_before(&readers[r], &readers[heap[(i - 1) / 2]]))
+        {
+            heap[i] = heap[(i - 1) / 2];
+            i = (i - 1) / 2;
+        }
+        heap[i] = r;
+    }
+
+    int status = 0;
+    while (size > 0 && status == 0)
+    {
+        RunReader *top = &readers[heap[0]];
+        if (text)
+            status = fwrite(top->line, 1, top->length, dest) == top->length && fputc('\n', dest) != EOF ? 0 : -1;
+        else
+            status = write_record(dest, top->key, top->seq, top->line, top->length);
+
+        // Next record of the same run, or drop the run; then sift down
+        int r = heap[0];
+        if (!read_record(top))
+            r = heap[--size];
+        int i = 0;
+        for (;;)
+        {
+            int child = 2 * i + 1;
+            if (child >= size)
+                break;
+            if (child + 1 < size && reader_before(&readers[heap[child + 1]], &readers[heap[child]]))
+                child++;
+            if (!reader_before(&readers[heap[child]], &readers[r]))
+                break;
+            heap[i] = heap[child];
+            i = child;
+        }
+        if (size > 0)
+            heap[i] = r;
+    }
+
+    for (int r = 0; r < count; r++)
+    {
+        free(readers[r].line);
+        fclose(runs[r]);
+    }
+    free(readers);
+    free(heap);
+    return status;
+}
+
+// Merge runs SORT_FAN_IN at a time until one pass can write dest
+static int merge_runs(FILE **runs, int num_runs, const char *out, FILE *dest)
+{
+    while (num_runs > SORT_FAN_IN)
+    {
+        FILE *merged = new_run(out);
+        if (merged == NULL || merge(runs, SORT_FAN_IN, merged, 0) != 0)
+        {
+            if (merged != NULL)
+                fclose(merged);
+            for (int r = merged != NULL ? SORT_FAN_IN : 0; r < num_runs; r++)
+                fclose(runs[r]);
+            return -1;
+        }
+        memmove(runs, runs + SORT_FAN_IN, (num_runs - SORT_FAN_IN) * sizeof(FILE *));
+        num_runs -= SORT_FAN_IN;
+        runs[num_runs++] = merged;
+    }
+    return merge(runs, num_runs, dest, 1);
+}
+
+// Sort path into out (through out.tmp), header first. Memory holds one run
+// of lines and their records at a time.
+static int sort_file(const char *path, const char *out, const char *header)
+{
+    FILE *in = fopen(path, "r");
+    if (in == NULL)
+    {
+        perror(path);
+        return -1;
+    }
+
+    char *tmp = checked(malloc(strlen(out) + sizeof(".tmp")));
+    sprintf(tmp, "%s.tmp", out);
+    FILE *dest = fopen(tmp, "w");
+    if (dest == NULL)
+    {
+        perror(tmp);
+        free(tmp);
+        fclose(in);
+        return -1;
+    }
+    fputs(header, dest);
+
+    char *text = NULL;
+    size_t text_used = 0, text_capacity = 0;
+    SortRecord *records = NULL;
+    int count = 0, capacity = 0;
+
+    FILE **runs = NULL;
+    int num_runs = 0, runs_capacity = 0;
+
+    char *line = NULL;
+    size_t line_capacity = 0;
+    uint64_t line_no = 0;
+    int status = 0;
+
+    while (status == 0 && getline(&line, &line_capacity, in) != -1)
+    {
+        line_no++;
+
+        char *comment = strchr(line, '#');
+        if (comment != NULL)
+            *comment = '\0';
+        size_t length = strlen(line);
+        while (length > 0 && strchr(" \t\r\n", line[length - 1]) != NULL)
+            length--;
+        if (strspn(line, " \t") >= length)
+            continue; // blank line
+        line[length] = '\0';
+
+        sim_time_t key;
+        if (line_arrival(line, &key) != 0 || length > UINT32_MAX)
+        {
+            fprintf(stderr, "%s:%llu: malformed process line\n", path, (unsigned long long)line_no);
+            status = -1;
+            break;
+        }
+
+        //* Run full: sort it and spill it to disk
+        if (count > 0 && text_used + length + (count + 1) * sizeof(SortRecord) > sort_memory)
+        {
+            if (num_runs == runs_capacity)
+            {
+                runs_capacity = runs_capacity ? runs_capacity * 2 : 16;
+                runs = checked(realloc(runs, runs_capacity * sizeof(FILE *)));
+            }
+            if ((runs[num_runs] = spill(out, records, count, text)) == NULL)
+            {
+                status = -1;
+                break;
+            }
+            num_runs++;
+            count = 0;
+            text_used = 0;
+        }
+
+        // Grow by doubling, but not past the budget (unless one line is bigger)
+        if (text_used + length > text_capacity)
+        {
+            text_capacity = text_capacity ? text_capacity * 2 : 1 << 16;
+            if (text_capacity > sort_memory)
+                text_capacity = sort_memory;
+            if (text_capacity < text_used + length)
+                text_capacity = text_used + length;
+            text = checked(realloc(text, text_capacity));
+        }
+        if (count == capacity)
+        {
+            capacity = capacity ? capacity * 2 : 1024;
+            if ((size_t)capacity > sort_memory / sizeof(SortRecord))
+                capacity = (int)(sort_memory / sizeof(SortRecord)) + 1;
+            records = checked(realloc(records, capacity * sizeof(SortRecord)));
+        }
+        memcpy(text + text_used, line, length);
+        records[count++] = (SortRecord){key, line_no, text_used, (uint32_t)length};
+        text_used += length;
+    }
+    free(line);
+    fclose(in);
+
+    if (status == 0 && num_runs == 0)
+    {
+        // It all fit: no runs on disk
+        qsort(records, count, sizeof(SortRecord), by_key);
+        for (int i = 0; i < count && status == 0; i++)
+        {
+            if (fwrite(text + records[i].offset, 1, records[i].length, dest) != records[i].length ||
+                fputc('\n', dest) == EOF)
+            {
+                perror(tmp);
+                status = -1;
+            }
+        }
+    }
+    else if (status == 0)
+    {
+        if (count > 0)
+        {
+            if (num_runs == runs_capacity)
+                runs = checked(realloc(runs, ++runs_capacity * sizeof(FILE *)));
+            if ((runs[num_runs] = spill(out, records, count, text)) == NULL)
+                status = -1;
+            else
+                num_runs++;
+        }
+        free(text);
+        free(records);
+        text = NULL;
+        records = NULL;
+
+        if (status == 0)
+        {
+            fprintf(stderr, "%s: sorting by arrival, %d runs\n", path, num_runs);
+            if ((status = merge_runs(runs, num_runs, out, dest)) != 0)
+                perror(tmp);
+            num_runs = 0;
+        }
+    }
+
+    for (int r = 0; r < num_runs; r++)
+        fclose(runs[r]);
+    free(runs);
+    free(text);
+    free(records);
+
+    int closed = fclose(dest) == 0;
+    if (status == 0 && (!closed || rename(tmp, out) != 0))
+    {
+        perror(out);
+        status = -1;
+    }
+    if (status != 0)
+        unlink(tmp);
+    free(tmp);
+    return status;
+}
+
+// The cached copy is current if its header is the one we would write
+static int up_to_date(const char *sorted, const char *header)
+{
+    FILE *f = fopen(sorted, "r");
+    if (f == NULL)
+        return 0;
+
+    char first[256];
+    int current = fgets(first, sizeof(first), f) != NULL && strcmp(first, header) == 0;
+    fclose(f);
+    return current;
+}
+
+char *arrivals_sorted_workload(const char *path)
+{
+    struct stat st;
+    if (stat(path, &st) != 0)
+    {
+        perror(path);
+        return NULL;
+    }
+
+    char header[160];
+    snprintf(header, sizeof(header), "# sorted by arrival: %lld bytes, mtime %lld.%09ld, tick %" PRId64 "ns\n",
+             (long long)st.st_size, (long long)st.st_mtim.tv_sec, (long)st.st_mtim.tv_nsec, sim_tick_ns);
+
+    char *sorted = checked(malloc(strlen(path) + sizeof(".sorted")));
+    sprintf(sorted, "%s.sorted", path);
+
+    if (!up_to_date(sorted, header) && sort_file(path, sorted, header) != 0)
+    {
+        free(sorted);
+        return NULL;
+    }
+    return sorted;
+}
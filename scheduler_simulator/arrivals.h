@@ -0,0 +1,71 @@
+#ifndef ARRIVALS_H
+#define ARRIVALS_H
+
+#include <stddef.h>
+
+#include "process.h"
+
+//* Arrival cursor
+//
+// Processes in arrival order, equal arrival times in workload order, so the
+// tick loops take each tick's arrivals in O(1) instead of testing every
+// process against the clock. Enqueue order is the same as the old scan's.
+// A workload that is already sorted (e.g. loaded with --sort-workload) is
+// walked in place, without the index.
+
+typedef struct ArrivalCursor
+{
+    int *order;             // process indices by arrival; NULL = already sorted
+    int count;
+    int next;               // first one that has not arrived yet
+} ArrivalCursor;
+
+void arrivals_begin(ArrivalCursor *c, const Process processes[], int num_processes);
+void arrivals_end(ArrivalCursor *c);
+
+// Index of the next process arriving at or before t, -1 if none (yet)
+static inline int arrivals_next(ArrivalCursor *c, const Process processes[], sim_time_t t)
+{
+    if (c->next == c->count)
+        return -1;
+    int i = c->order != NULL ? c->order[c->next] : c->next;
+    if (processes[i].arrival_time > t)
+        return -1;
+    c->next++;
+    return i;
+}
+
+// Arrival time of the next process that has not arrived yet, SIM_TIME_MAX
+// if none is left
+static inline sim_time_t arrivals_peek(const ArrivalCursor *c, const Process processes[])
+{
+    if (c->next == c->count)
+        return SIM_TIME_MAX;
+    return processes[c->order != NULL ? c->order[c->next] : c->next].arrival_time;
+}
+
+//* Arrival-sorted workload files (--sort-workload)
+//
+// <path>.sorted holds the workload's process lines ordered by arrival,
+// equal arrivals in file order, with comments and blank lines dropped. It is
+// built once by an external merge sort: the input is cut into runs of at
+// most --sort-memory bytes (default 256M), each sorted in memory and
+// spilled next to the output, and the runs are merged SORT_FAN_IN at a
+// time. Its first line records the input's size, modification time and the
+// tick length; later loads reuse it while those still match.
+
+#define SORT_DEFAULT_MEMORY ((size_t)256 << 20)
+#define SORT_FAN_IN 64              // runs open at once while merging
+
+// "--sort-workload" for the loads that follow, with this run budget
+void arrivals_configure_sort(int enabled, size_t memory);
+int arrivals_sort_enabled(void);
+
+// "64M", "512K", "2G" or plain bytes; returns -1 if malformed
+int arrivals_parse_memory(const char *s, size_t *bytes);
+
+// Path of an up-to-date sorted copy of path, built if needed; NULL (after
+// saying why) on failure. The caller frees it.
+char *arrivals_sorted_workload(const char *path);
+
+#endif
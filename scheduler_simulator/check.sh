@@ -0,0 +1,136 @@
+#!/bin/sh
+# make check: end-to-end checks of the workload and trace tools
+#
+#   1. text -> packed -> text round trip (--pack-workload, --unpack-workload)
+#   2. external sort (--sort-workload) against sort -s, in tiny runs
+#   3. --diff of identical and of perturbed traces
+#
+# Usage: check.sh [path to scheduler]
+
+SCHEDULER=${1:-./scheduler}
+DIR=$(mktemp -d "${TMPDIR:-/tmp}/schedcheck.XXXXXX") || exit 1
+trap 'rm -rf "$DIR"' EXIT INT TERM
+
+failures=0
+
+pass()
+{
+    echo "  ok    $1"
+}
+
+fail()
+{
+    echo "  FAIL  $1"
+    failures=$((failures + 1))
+}
+
+# Quiet wrapper: output goes to $DIR/log, shown only when a step fails
+run()
+{
+    "$SCHEDULER" "$@" > "$DIR/log" 2>&1
+}
+
+# n processes in the form --unpack-workload writes: arrivals with
+# repeats (ties keep file order), pids sharing prefixes across block
+# boundaries, and I/O bursts on default and named devices
+generate()
+{
+    awk -v n="$1" 'BEGIN {
+        seed = 7;
+        for (i = 0; i < n; i++)
+        {
+            seed = (seed * 16807) % 2147483647;
+            line = sprintf("proc%05d %d %d", i, seed % 97, 1 + seed % 9);
+            for (b = 0; b < seed % 4; b++)
+            {
+                io = 1 + (seed + b) % 6;
+                if (b % 3 == 1)
+                    io = "disk:" io "@" (1 + (seed + b) % 200);
+                else if (b % 3 == 2)
+                    io = "net:" io;
+                line = line " " io " " (1 + (seed + 3 * b) % 7);
+            }
+            print line;
+        }
+    }'
+}
+
+echo "Round trip text -> packed -> text"
+
+# Attributes, and columns whose range needs 57 to 64 bits: the arrival
+# deltas zig-zag to 2^63 (64 bits), the CPU bursts span 2^60 and the I/O
+# times 2^56 (57 bits)
+generate 600 > "$DIR/rt.txt"
+cat >> "$DIR/rt.txt" <<EOF
+wide1 0 3 2 4
+wide2 4611686018427387904 1152921504606846976 disk:72057594037927937@12 1 prio=3 group=web/api
+wide3 0 1 net:1 2 5@7 1 node=1 dist=uniform:30
+wide4 5 2 3 4 job=2 dist=exp
+wide5 9 1 prio=7 group=web node=0 dist=normal:5
+wide6 9 4 dist=fixed
+EOF
+
+OPTS="--devices disk:2:elevator,net --groups web,web/api"
+if run $OPTS --workload "$DIR/rt.txt" --pack-workload "$DIR/rt.schw" &&
+   run $OPTS --workload "$DIR/rt.schw" --unpack-workload "$DIR/rt2.txt" &&
+   cmp -s "$DIR/rt.txt" "$DIR/rt2.txt"
+then
+    pass "606 processes, tags, attributes and 57-64 bit columns"
+else
+    cat "$DIR/log"
+    fail "round trip changed the workload"
+fi
+
+echo "External sort against sort -s"
+
+# 1K runs hold under 20 lines each, so the 3000 lines make well over
+# SORT_FAN_IN runs and the merge takes more than one pass
+generate 3000 > "$DIR/sort.txt"
+if run --devices disk,net --workload "$DIR/sort.txt" --sort-workload --sort-memory 1K --unpack-workload "$DIR/sorted.txt"
+then
+    tail -n +2 "$DIR/sort.txt.sorted" > "$DIR/got.txt"
+    LC_ALL=C sort -s -n -k2,2 "$DIR/sort.txt" > "$DIR/want.txt"
+    if cmp -s "$DIR/got.txt" "$DIR/want.txt"
+    then
+        pass "3000 lines in 1K runs"
+    else
+        fail "sorted copy differs from sort -s"
+    fi
+else
+    cat "$DIR/log"
+    fail "--sort-workload failed"
+fi
+
+echo "Trace diff"
+
+generate 200 > "$DIR/a.txt"
+sed '100s/ [0-9]*$/ 50/' "$DIR/a.txt" > "$DIR/b.txt"
+OPTS="--devices disk,net --algorithm RR --quiet"
+run $OPTS --workload "$DIR/a.txt" --trace "$DIR/a.trace"
+run $OPTS --workload "$DIR/a.txt" --trace "$DIR/a2.trace"
+run $OPTS --workload "$DIR/b.txt" --trace "$DIR/b.trace"
+
+run --diff "$DIR/a.trace" "$DIR/a2.trace"
+if [ $? -eq 0 ] && grep -q "identical" "$DIR/log"
+then
+    pass "identical traces"
+else
+    cat "$DIR/log"
+    fail "identical traces reported as different"
+fi
+
+run --diff "$DIR/a.trace" "$DIR/b.trace"
+if [ $? -eq 1 ] && grep -q "First divergence" "$DIR/log"
+then
+    pass "perturbed traces"
+else
+    cat "$DIR/log"
+    fail "perturbed traces not reported"
+fi
+
+if [ $failures -gt 0 ]
+then
+    echo "$failures check(s) failed"
+    exit 1
+fi
+echo "All checks passed"
@@ -0,0 +1,365 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+
+#include "compare.h"
+#include "simulator.h"
+
+#define COMPARE_METRICS 6
+#define BOOTSTRAP_SALT 0x626f6f7473747261ULL   // keeps resample draws apart from burst draws
+
+static const char *metric_names[COMPARE_METRICS] = {
+    "mean wait", "p99 wait", "mean turnaround", "p99 turnaround", "throughput/1k", "switches",
+};
+
+static void *checked(void *ptr)
+{
+    if (ptr == NULL)
+    {
+        fprintf(stderr, "compare: out of memory\n");
+        exit(1);
+    }
+    return ptr;
+}
+
+void compare_config_defaults(CompareConfig *c)
+{
+    memset(c, 0, sizeof(*c));
+    c->resamples = COMPARE_RESAMPLES;
+}
+
+int compare_parse_option(CompareConfig *c, int argc, char *argv[], int *i)
+{
+    const char *opt = argv[*i];
+    if (strcmp(opt, "--compare") != 0 && strcmp(opt, "--bootstrap") != 0)
+        return 0;
+
+    const char *value = option_value(argc, argv, i);
+    if (value == NULL)
+        return -1;
+
+    if (strcmp(opt, "--bootstrap") == 0)
+    {
+        c->resamples = atoi(value);
+        if (c->resamples < 100)
+        {
+            printf("--bootstrap takes at least 100 resamples.\n");
+            return -1;
+        }
+        return 1;
+    }
+
+    if (strlen(value) >= sizeof(c->list))
+    {
+        printf("--compare: policy list too long.\n");
+        return -1;
+    }
+    strcpy(c->list, value);
+    c->count = 0;
+    char *save = NULL;
+    for (char *name = strtok_r(c->list, ",", &save); name != NULL; name = strtok_r(NULL, ",", &save))
+    {
+        if (c->count == COMPARE_MAX)
+        {
+            printf("--compare takes at most %d policies.\n", COMPARE_MAX);
+            return -1;
+        }
+        c->policies[c->count++] = name;
+    }
+    if (c->count < 2)
+    {
+        printf("--compare takes two or more policies, e.g. FIFO,SJF,RR.\n");
+        return -1;
+    }
+    return 1;
+}
+
+static void compare_values(const SimResults *res, double v[COMPARE_METRICS])
+{
+    const RunSummary *s = &res->summary;
+    v[0] = s->avg_wait;
+    v[1] = s->p99_wait;
+    v[2] = s->avg_turnaround;
+    v[3] = s->p99_turnaround;
+    v[4] = s->makespan > 0 ? 1000.0 * s->finished / s->makespan : 0.0;
+    v[5] = res->cost.context_switches;
+}
+
+// ---------------------------------------------------------------------------
+// Paired bootstrap
+// ---------------------------------------------------------------------------
+
+//* values[(r * policies + k) * COMPARE_METRICS + m]: metric m of policy k in
+//* replication r. ratios[((k - 1) * COMPARE_METRICS + m) * resamples + b]:
+//* resample b's mean of policy k over the baseline's, NAN if that is 0.
+typedef struct Bootstrap
+{
+    const double *values;
+    int replications;
+    int policies;
+    int resamples;
+    uint64_t seed;
+    double *ratios;
+    int thread;
+    int threads;
+} Bootstrap;
+
+static void *bootstrap_share(void *arg)
+{
+    const Bootstrap *bs = arg;
+    int n = bs->replications;
+    int *pick = checked(malloc(n * sizeof(int)));
+    double *sums = checked(malloc((size_t)bs->policies * COMPARE_METRICS * sizeof(double)));
+
+    for (int b = bs->thread; b < bs->resamples; b += bs->threads)
+    {
+        for (int j = 0; j < n; j++)
+            pick[j] = (int)(mc_uniform01(bs->seed, b, 0, j) * n);
+
+        memset(sums, 0, (size_t)bs->policies * COMPARE_METRICS * sizeof(double));
+        for (int j = 0; j < n; j++)
+        {
+            const double *row = &bs->values[(size_t)pick[j] * bs->policies * COMPARE_METRICS];
+            for (int x = 0; x < bs->policies * COMPARE_METRICS; x++)
+                sums[x] += row[x];
+        }
+
+        for (int k = 1; k < bs->policies; k++)
+        {
+            for (int m = 0; m < COMPARE_METRICS; m++)
+            {
+                double base = sums[m];
+                double ratio = base != 0.0 ? sums[k * COMPARE_METRICS + m] / base - 1.0 : NAN;
+                bs->ratios[((size_t)(k - 1) * COMPARE_METRICS + m) * bs->resamples + b] = ratio;
+            }
+        }
+    }
+
+    free(sums);
+    free(pick);
+    return NULL;
+}
+
+static void bootstrap(Bootstrap *shared, int threads)
+{
+    Bootstrap *parts = checked(malloc(threads * sizeof(Bootstrap)));
+    pthread_t *ids = checked(malloc(threads * sizeof(pthread_t)));
+    int *running = checked(calloc(threads, sizeof(int)));
+
+    for (int t = 0; t < threads; t++)
+    {
+        parts[t] = *shared;
+        parts[t].thread = t;
+        parts[t].threads = threads;
+        if (t > 0)
+            running[t] = pthread_create(&ids[t], NULL, bootstrap_share, &parts[t]) == 0;
+    }
+
+    //* Share 0 runs here, and so do shares whose thread could not be started
+    bootstrap_share(&parts[0]);
+    for (int t = 1; t < threads; t++)
+    {
+        if (running[t])
+            pthread_join(ids[t], NULL);
+        else
+            bootstrap_share(&parts[t]);
+    }
+
+    free(running);
+    free(ids);
+    free(parts);
+}
+
+static int compare_doubles(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Percentile q of the sorted values, interpolated
+static double percentile(const double *sorted, int n, double q)
+{
+    double position = q * (n - 1);
+    int lo = (int)position;
+    if (lo + 1 >= n)
+        return sorted[n - 1];
+    return sorted[lo] + (position - lo) * (sorted[lo + 1] - sorted[lo]);
+}
+
+// ---------------------------------------------------------------------------
+// Report
+// ---------------------------------------------------------------------------
+
+static void print_change(double value, double base)
+{
+    if (base != 0.0)
+        printf(" %+9.2f%%", 100.0 * (value / base - 1.0));
+    else
+        printf(" %10s", "-");
+}
+
+int compare_run(const CompareConfig *c, const McConfig *mc, const RunConfig *run,
+                Process processes[], int num_processes)
+{
+    int policies = c->count;
+    if (policies < 2 || policies > COMPARE_MAX)
+        return -1;
+    RunConfig runs[COMPARE_MAX];
+    for (int k = 0; k < policies; k++)
+    {
+        runs[k] = *run;
+        runs[k].algorithm = c->policies[k];
+        const char *problem = run_check(&runs[k]);
+        if (problem != NULL)
+        {
+            printf("%s: %s\n", c->policies[k], problem);
+            return -1;
+        }
+    }
+
+    //* Every policy on every replication, or once each on the workload as loaded
+    int replications = mc->replications > 0 ? mc->replications : 1;
+    McSample *samples = checked(calloc((size_t)replications * policies, sizeof(McSample)));
+    int workers = 1;
+    if (mc->replications > 0)
+    {
+        workers = mc_simulate(mc, runs, policies, processes, num_processes, samples);
+        if (workers < 0)
+        {
+            free(samples);
+            return -1;
+        }
+    }
+    else
+    {
+        Simulator *sim = checked(sim_create_from(processes, num_processes));
+        for (int k = 0; k < policies; k++)
+        {
+            samples[k].ok = sim_run(sim, &runs[k], &samples[k].results) == 0;
+            if (!samples[k].ok)
+                printf("%s\n", sim_error(sim));
+        }
+        sim_reset(sim);
+        sim_destroy(sim);
+    }
+
+    //* Only replications in which every policy ran are paired
+    double *values = checked(malloc((size_t)replications * policies * COMPARE_METRICS * sizeof(double)));
+    int paired = 0;
+    for (int r = 0; r < replications; r++)
+    {
+        int ok = 1;
+        for (int k = 0; k < policies; k++)
+            ok &= samples[r * policies + k].ok;
+        if (!ok)
+            continue;
+        for (int k = 0; k < policies; k++)
+            compare_values(&samples[r * policies + k].results,
+                           &values[((size_t)paired * policies + k) * COMPARE_METRICS]);
+        paired++;
+    }
+    free(samples);
+
+    double means[COMPARE_MAX][COMPARE_METRICS] = {{0}};
+    for (int r = 0; r < paired; r++)
+    {
+        for (int x = 0; x < policies * COMPARE_METRICS; x++)
+            means[x / COMPARE_METRICS][x % COMPARE_METRICS] += values[(size_t)r * policies * COMPARE_METRICS + x];
+    }
+    for (int k = 0; k < policies; k++)
+    {
+        for (int m = 0; m < COMPARE_METRICS && paired > 0; m++)
+            means[k][m] /= paired;
+    }
+
+    //* Intervals need replications to resample
+    int intervals = mc->replications > 0 && paired >= 2;
+    double *ratios = NULL;
+    int threads = mc_default_workers(mc);
+    if (intervals)
+    {
+        if (threads > c->resamples)
+            threads = c->resamples;
+        ratios = checked(malloc((size_t)(policies - 1) * COMPARE_METRICS * c->resamples * sizeof(double)));
+        Bootstrap shared = {values, paired, policies, c->resamples, mc->seed ^ BOOTSTRAP_SALT, ratios, 0, 1};
+        bootstrap(&shared, threads);
+    }
+
+    printf("\n=== Comparison: ");
+    for (int k = 0; k < policies; k++)
+        printf("%s%s", k > 0 ? ", " : "", c->policies[k]);
+    printf(" on %d processes ===\n", num_processes);
+    if (mc->replications > 0)
+    {
+        printf("  %d paired replications (%s", mc->replications, mc_dist_name(mc->dist));
+        if (mc->dist == DIST_UNIFORM || mc->dist == DIST_NORMAL)
+            printf(":%d", mc->spread);
+        printf(" bursts, seed %llu, %d worker%s), %d bootstrap resamples on %d thread%s\n",
+               (unsigned long long)mc->seed, workers, workers == 1 ? "" : "s",
+               c->resamples, threads, threads == 1 ? "" : "s");
+        if (paired < replications)
+            printf("  %d replications left out: not every policy ran\n", replications - paired);
+        printf("  change: against %s, with a 95%% paired bootstrap interval; * = it excludes 0\n",
+               c->policies[0]);
+    }
+    else
+    {
+        printf("  one run each on the loaded workload: the changes are exact\n");
+        printf("  (--replications N compares on paired random replicas, with intervals)\n");
+    }
+    if (paired == 0)
+    {
+        printf("  no run in which every policy finished\n");
+        free(values);
+        return -1;
+    }
+
+    printf("\n  %-16s %-8s %14s %11s", "metric", "policy", mc->replications > 0 ? "mean" : "value", "change");
+    if (intervals)
+        printf("  %22s", "95% CI");
+    printf("\n");
+
+    double *sorted = intervals ? checked(malloc(c->resamples * sizeof(double))) : NULL;
+    for (int m = 0; m < COMPARE_METRICS; m++)
+    {
+        for (int k = 0; k < policies; k++)
+        {
+            printf("  %-16s %-8s %14.3f", k == 0 ? metric_names[m] : "", c->policies[k], means[k][m]);
+            if (k == 0)
+            {
+                printf(" %10s\n", "baseline");
+                continue;
+            }
+            print_change(means[k][m], means[0][m]);
+
+            if (intervals && means[0][m] != 0.0)
+            {
+                const double *row = &ratios[((size_t)(k - 1) * COMPARE_METRICS + m) * c->resamples];
+                int n = 0;
+                for (int b = 0; b < c->resamples; b++)
+                {
+                    if (!isnan(row[b]))
+                        sorted[n++] = row[b];
+                }
+                if (n == c->resamples)
+                {
+                    qsort(sorted, n, sizeof(double), compare_doubles);
+                    double lo = percentile(sorted, n, 0.025), hi = percentile(sorted, n, 0.975);
+                    printf("  [%+8.2f%%, %+8.2f%%]%s", 100.0 * lo, 100.0 * hi, lo > 0 || hi < 0 ? " *" : "");
+                }
+                else
+                {
+                    printf("  %22s", "-");    // the baseline is 0 in some resample
+                }
+            }
+            printf("\n");
+        }
+    }
+
+    free(sorted);
+    free(ratios);
+    free(values);
+    return paired == replications ? 0 : 1;
+}
@@ -0,0 +1,56 @@
+#ifndef COMPARE_H
+#define COMPARE_H
+
+#include "process.h"
+#include "experiment.h"
+#include "montecarlo.h"
+
+//* Policy comparison (--compare FIFO,SJF,STCF,RR)
+//
+// Runs every listed algorithm on the same workload, with the other run
+// options shared, and prints one table: per metric, each policy's value
+// and its relative change against the first policy (the baseline).
+//
+//   mean wait, p99 wait, mean turnaround, p99 turnaround
+//   throughput     processes finished per 1000 ticks
+//   switches       context switches
+//
+// Without --replications each policy runs once on the loaded workload.
+// The simulation is deterministic, so the changes are exact and there is
+// nothing to put an interval on.
+//
+// With --replications N every replication draws its bursts once (see
+// montecarlo.h) and runs all policies on them, so policies are compared
+// on paired samples. Values are means over the replications, and each
+// change gets a 95% paired bootstrap interval: --bootstrap resamples
+// (default COMPARE_RESAMPLES) of the replications with replacement, the
+// same replications for the baseline and the policy, each giving a ratio
+// of means; the interval runs from the 2.5th to the 97.5th percentile of
+// those ratios. A change whose interval excludes 0 is marked significant.
+// Resampling runs on --workers threads, with draws that depend only on
+// --seed and the resample number, so intervals do not depend on the
+// thread count.
+
+#define COMPARE_MAX 8               // policies
+#define COMPARE_RESAMPLES 2000
+
+typedef struct CompareConfig
+{
+    int count;                      // policies, 0 = off
+    const char *policies[COMPARE_MAX];
+    int resamples;
+    char list[256];                 // --compare value, split at the commas
+} CompareConfig;
+
+void compare_config_defaults(CompareConfig *c);
+
+// Parse the comparison option at argv[*i], like parse_run_option()
+int compare_parse_option(CompareConfig *c, int argc, char *argv[], int *i);
+
+// Simulate every policy with run's other options, on mc->replications
+// paired replications if set, and print the table. Returns 0 if every run
+// succeeded.
+int compare_run(const CompareConfig *c, const McConfig *mc, const RunConfig *run,
+                Process processes[], int num_processes);
+
+#endif
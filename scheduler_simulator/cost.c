@@ -0,0 +1,116 @@
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+
+#include "cost.h"
+
+//* Per-CPU, cache-line aligned: CPUs simulated on different host threads
+//* (--cpus) never write to the same line
+typedef struct CpuState
+{
+    Process *last;          // process whose context is loaded
+    int stall;              // ticks left before it makes progress
+    CostStats stats;
+} __attribute__((aligned(64))) CpuState;
+
+static int switch_cost = 0;
+static int cache_max = 0;
+static int cache_halflife = 10;
+
+static CpuState cpus[COST_MAX_CPUS];
+
+void cost_configure(int switch_ticks, int cache_penalty, int halflife)
+{
+    switch_cost = switch_ticks > 0 ? switch_ticks : 0;
+    cache_max = cache_penalty > 0 ? cache_penalty : 0;
+    if (halflife <= 0)
+    {
+        sim_time_t ticks = sim_ns_to_ticks(COST_HALFLIFE_NS);
+        halflife = ticks < INT_MAX ? (int)ticks : INT_MAX;
+    }
+    cache_halflife = halflife;
+}
+
+int cost_enabled(void)
+{
+    return switch_cost > 0 || cache_max > 0;
+}
+
+int cost_halflife(void)
+{
+    return cache_halflife;
+}
+
+static int cache_penalty(Process *p, int cpu, sim_time_t current_time)
+{
+    if (cache_max == 0)
+        return 0;
+    if (p->last_cpu != cpu)
+        return cache_max; // cold: never ran here
+
+    sim_time_t off_cpu = current_time - p->last_ran - 1;
+    sim_time_t halvings = off_cpu / cache_halflife;
+    int warm = halvings >= 31 ? 0 : cache_max >> halvings;
+    return cache_max - warm;
+}
+
+void cost_dispatch(Process *p, int cpu, sim_time_t current_time)
+{
+    CpuState *c = &cpus[cpu];
+
+    if (c->last == p)
+    {
+        c->stall = 0; // same context still loaded (e.g. RR re-picks it)
+        return;
+    }
+
+    int cache = cache_penalty(p, cpu, current_time);
+
+    c->stats.context_switches++;
+    c->stats.switch_ticks += switch_cost;
+    c->stats.cache_ticks += cache;
+
+    c->last = p;
+    c->stall = switch_cost + cache;
+    p->last_cpu = cpu;
+}
+
+int cost_stalled(int cpu)
+{
+    if (cpus[cpu].stall == 0)
+        return 0;
+    cpus[cpu].stall--;
+    return 1;
+}
+
+void cost_reset(void)
+{
+    memset(cpus, 0, sizeof(cpus));
+}
+
+CostStats cost_totals(void)
+{
+    CostStats total = {0};
+    for (int i = 0; i < COST_MAX_CPUS; i++)
+    {
+        total.context_switches += cpus[i].stats.context_switches;
+        total.switch_ticks += cpus[i].stats.switch_ticks;
+        total.cache_ticks += cpus[i].stats.cache_ticks;
+    }
+    return total;
+}
+
+void cost_report(void)
+{
+    if (!cost_enabled())
+        return;
+
+    CostStats cost_stats = cost_totals();
+
+    printf("\n=== Context Switches ===\n");
+    printf("  switches:        %ld\n", cost_stats.context_switches);
+    printf("  switch overhead: %ld ticks (%d per switch)\n", cost_stats.switch_ticks, switch_cost);
+    printf("  cache refill:    %ld ticks (max %d, half-life %d)\n",
+           cost_stats.cache_ticks, cache_max, cache_halflife);
+    printf("  total overhead:  %ld ticks\n", cost_stats.switch_ticks + cost_stats.cache_ticks);
+}
@@ -0,0 +1,50 @@
+#ifndef COST_H
+#define COST_H
+
+#include "process.h"
+
+#define COST_MAX_CPUS 1024
+#define COST_HALFLIFE_NS (10 * (int64_t)SIM_NS_PER_MS) // default cache half-life
+
+//* Context-switch cost model
+//
+// Dispatching a process other than the one that last ran on a CPU costs
+// switch_ticks, plus a cache-refill penalty of up to cache_penalty ticks.
+// The process's cache footprint on its last CPU halves every
+// cache_halflife ticks it spends off that CPU, so a process that was just
+// preempted comes back almost warm and one that ran elsewhere (or never
+// ran) pays the full penalty. During the stall the CPU is busy but the
+// process makes no progress.
+//
+// The three knobs are ticks, as given. The default half-life is
+// COST_HALFLIFE_NS, converted at the --tick of the run.
+
+typedef struct CostStats
+{
+    long context_switches;
+    long switch_ticks;      // ticks spent on the switch itself
+    long cache_ticks;       // ticks spent refilling caches
+} CostStats;
+
+// cache_halflife 0 = COST_HALFLIFE_NS
+void cost_configure(int switch_ticks, int cache_penalty, int cache_halflife);
+int cost_enabled(void);
+
+// The half-life in use, in ticks
+int cost_halflife(void);
+
+// Called right after p is dequeued onto cpu
+void cost_dispatch(Process *p, int cpu, sim_time_t current_time);
+
+// True (and consumes one tick) while cpu is still switching in its process
+int cost_stalled(int cpu);
+
+// Forget loaded contexts, pending stalls and stats (between runs)
+void cost_reset(void);
+
+// Summed over all CPUs
+CostStats cost_totals(void);
+
+void cost_report(void);
+
+#endif
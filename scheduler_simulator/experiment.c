@@ -0,0 +1,483 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#include "experiment.h"
+#include "simulator.h"
+#include "fifo.h"
+#include "sjf.h"
+#include "stcf.h"
+#include "rr.h"
+#include "priority.h"
+#include "gang.h"
+#include "io_device.h"
+#include "group.h"
+#include "workload.h"
+#include "cost.h"
+#include "predict.h"
+#include "readyq.h"
+#include "power.h"
+#include "numa.h"
+#include "metrics.h"
+#include "trace.h"
+
+#define MANIFEST_LINE_LEN 1024
+#define MANIFEST_MAX_ARGS 64
+#define MAX_WORKLOADS 64
+
+void run_config_defaults(RunConfig *run)
+{
+    *run = (RunConfig){
+        .algorithm = "FIFO",
+        .quantum = 1,
+        .workload_path = NULL,
+        .switch_cost = 0,
+        .cache_penalty = 0,
+        .cache_halflife = 0,        // 0 = COST_HALFLIFE_NS
+        .adaptive_percentile = 0.0,
+        .predict_alpha = 0.0,
+        .predict_initial = 5.0,
+        .ready_queue = RQ_AUTO,
+        .preemptive = 0,
+        .aging = 0,
+        .smp = {.cpus = 0, .threads = 1, .window = 4},
+        .gang_rows = 4,
+        .dvfs = NULL,
+        .numa = NULL,
+        .remote_penalty = 30,
+        .smt_penalty = 40,
+    };
+}
+
+const char *option_value(int argc, char *argv[], int *i)
+{
+    if (*i + 1 >= argc)
+    {
+        printf("%s needs a value.\n", argv[*i]);
+        return NULL;
+    }
+    return argv[++*i];
+}
+
+int parse_run_option(RunConfig *run, int argc, char *argv[], int *i)
+{
+    const char *opt = argv[*i];
+    const char *value;
+
+    //* Flags without a value
+    if (strcmp(opt, "--preemptive") == 0)
+    {
+        run->preemptive = 1;
+        return 1;
+    }
+
+    if (strcmp(opt, "--algorithm") != 0 && strcmp(opt, "--quantum") != 0 &&
+        strcmp(opt, "--workload") != 0 && strcmp(opt, "--cpus") != 0 &&
+        strcmp(opt, "--threads") != 0 && strcmp(opt, "--smp-window") != 0 &&
+        strcmp(opt, "--cs-cost") != 0 && strcmp(opt, "--cache-penalty") != 0 &&
+        strcmp(opt, "--cache-halflife") != 0 && strcmp(opt, "--adaptive-quantum") != 0 &&
+        strcmp(opt, "--predict") != 0 && strcmp(opt, "--predict-initial") != 0 &&
+        strcmp(opt, "--aging") != 0 && strcmp(opt, "--gang-rows") != 0 &&
+        strcmp(opt, "--dvfs") != 0 && strcmp(opt, "--numa") != 0 &&
+        strcmp(opt, "--remote-penalty") != 0 && strcmp(opt, "--smt-penalty") != 0 &&
+        strcmp(opt, "--rq") != 0)
+        return 0;
+
+    if ((value = option_value(argc, argv, i)) == NULL)
+        return -1;
+
+    if (strcmp(opt, "--algorithm") == 0)
+    {
+        run->algorithm = value;
+    }
+    else if (strcmp(opt, "--quantum") == 0)
+    {
+        //* Ticks, or a duration converted at --tick (10ms)
+        sim_time_t quantum;
+        if (sim_parse_duration(value, &quantum) != 0 || quantum < 1 || quantum > INT_MAX)
+        {
+            printf("--quantum takes a positive number of ticks or a duration, e.g. 4 or 10ms.\n");
+            return -1;
+        }
+        run->quantum = (int)quantum;
+    }
+    else if (strcmp(opt, "--workload") == 0)
+    {
+        run->workload_path = value;
+    }
+    else if (strcmp(opt, "--cpus") == 0)
+    {
+        run->smp.cpus = atoi(value);
+        if (run->smp.cpus < 1 || run->smp.cpus > SMP_MAX_CPUS)
+        {
+            printf("--cpus takes 1..%d CPUs.\n", SMP_MAX_CPUS);
+            return -1;
+        }
+    }
+    else if (strcmp(opt, "--threads") == 0)
+    {
+        run->smp.threads = atoi(value);
+        if (run->smp.threads < 1)
+        {
+            printf("--threads takes a positive thread count.\n");
+            return -1;
+        }
+    }
+    else if (strcmp(opt, "--smp-window") == 0)
+    {
+        run->smp.window = atoi(value);
+        if (run->smp.window < 1)
+        {
+            printf("--smp-window takes a positive number of ticks.\n");
+            return -1;
+        }
+    }
+    else if (strcmp(opt, "--cs-cost") == 0)
+    {
+        run->switch_cost = atoi(value);
+    }
+    else if (strcmp(opt, "--cache-penalty") == 0)
+    {
+        run->cache_penalty = atoi(value);
+    }
+    else if (strcmp(opt, "--cache-halflife") == 0)
+    {
+        run->cache_halflife = atoi(value);
+    }
+    else if (strcmp(opt, "--adaptive-quantum") == 0)
+    {
+        run->adaptive_percentile = atof(value);
+        if (run->adaptive_percentile <= 0 || run->adaptive_percentile >= 100)
+        {
+            printf("--adaptive-quantum takes a percentile between 0 and 100.\n");
+            return -1;
+        }
+    }
+    else if (strcmp(opt, "--predict") == 0)
+    {
+        run->predict_alpha = atof(value);
+        if (run->predict_alpha <= 0 || run->predict_alpha > 1)
+        {
+            printf("--predict takes an averaging weight alpha in (0, 1].\n");
+            return -1;
+        }
+    }
+    else if (strcmp(opt, "--predict-initial") == 0)
+    {
+        run->predict_initial = atof(value);
+    }
+    else if (strcmp(opt, "--rq") == 0)
+    {
+        run->ready_queue = rq_parse(value);
+        if (run->ready_queue < 0)
+        {
+            printf("--rq takes auto, array, heap, pairing, skiplist or bucket.\n");
+            return -1;
+        }
+    }
+    else if (strcmp(opt, "--aging") == 0)
+    {
+        run->aging = atoi(value);
+    }
+    else if (strcmp(opt, "--dvfs") == 0)
+    {
+        if (power_configure(value) != 0)
+            return -1;
+        run->dvfs = value;
+    }
+    else if (strcmp(opt, "--numa") == 0)
+    {
+        NumaTopology topology;
+        if (numa_parse(value, &topology) != 0)
+            return -1;
+        run->numa = value;
+        run->smp.cpus = topology.sockets * topology.cores * topology.threads;
+    }
+    else if (strcmp(opt, "--remote-penalty") == 0 || strcmp(opt, "--smt-penalty") == 0)
+    {
+        int penalty = atoi(value);
+        if (penalty < 0)
+        {
+            printf("%s takes a slowdown in percent.\n", opt);
+            return -1;
+        }
+        if (strcmp(opt, "--remote-penalty") == 0)
+            run->remote_penalty = penalty;
+        else
+            run->smt_penalty = penalty;
+    }
+    else if (strcmp(opt, "--gang-rows") == 0)
+    {
+        run->gang_rows = atoi(value);
+        if (run->gang_rows < 1 || run->gang_rows > GANG_MAX_ROWS)
+        {
+            printf("--gang-rows takes 1..%d rows.\n", GANG_MAX_ROWS);
+            return -1;
+        }
+    }
+
+    return 1;
+}
+
+const char *run_check(const RunConfig *run)
+{
+    int gang = strcmp(run->algorithm, "GANG") == 0;
+
+    if (gang && run->smp.cpus == 0)
+        return "GANG needs --cpus.";
+    if (run->smp.cpus > 0 && !gang && strcmp(run->algorithm, "FIFO") != 0 && strcmp(run->algorithm, "RR") != 0)
+        return "--cpus supports the FIFO, RR and GANG algorithms.";
+    if (run->smp.cpus > 0 && (io_num_devices() > 1 || groups_enabled))
+        return "--cpus does not support --devices or --groups.";
+    if (run->numa != NULL)
+    {
+        NumaTopology topology;
+        numa_parse(run->numa, &topology);
+        if (gang)
+            return "--numa supports the FIFO and RR algorithms.";
+        if (run->smp.cpus != topology.sockets * topology.cores * topology.threads)
+            return "--cpus does not match the --numa topology (--numa sets the CPU count).";
+    }
+    return NULL;
+}
+
+void run_configure(const RunConfig *run)
+{
+    cost_configure(run->switch_cost, run->cache_penalty, run->cache_halflife);
+    rr_set_adaptive(run->adaptive_percentile);
+    priority_set_aging(run->aging);
+    power_configure(run->dvfs);
+    numa_configure(run->numa, run->remote_penalty, run->smt_penalty);
+    rq_configure(run->ready_queue);
+    predict_reset();
+    if (run->predict_alpha > 0)
+        predict_configure(run->predict_alpha, run->predict_initial);
+}
+
+int run_schedule(const RunConfig *run, Process processes[], int num_processes)
+{
+    if (run->smp.cpus > 0 && strcmp(run->algorithm, "GANG") == 0)
+    {
+        GangConfig gang = {.cpus = run->smp.cpus, .quantum = run->quantum, .rows = run->gang_rows};
+        if (gang_schedule(processes, num_processes, &gang) != 0)
+            return 1;
+    }
+    else if (run->smp.cpus > 0)
+    {
+        SmpConfig smp = run->smp;
+        smp.quantum = strcmp(run->algorithm, "RR") == 0 ? run->quantum : 0;
+        smp_schedule(processes, num_processes, &smp);
+    }
+    else if (strcmp(run->algorithm, "FIFO") == 0)
+        fifo_schedule(processes, num_processes);
+    else if (strcmp(run->algorithm, "SJF") == 0)
+        sjf_schedule(processes, num_processes);
+    else if (strcmp(run->algorithm, "STCF") == 0)
+        stcf_schedule(processes, num_processes);
+    else if (strcmp(run->algorithm, "RR") == 0)
+        rr_schedule(processes, num_processes, run->quantum);
+    else if (strcmp(run->algorithm, "PRIORITY") == 0)
+        priority_schedule(processes, num_processes, run->preemptive);
+    else
+        return -1;
+
+    power_finish(run->smp.cpus > 0 ? run->smp.cpus : 1);
+    return 0;
+}
+
+//* Workloads loaded so far, one simulator each, found by path
+static Simulator *loaded[MAX_WORKLOADS];
+static int num_loaded = 0;
+
+static Simulator *workload_get(const char *path)
+{
+    for (int i = 0; i < num_loaded; i++)
+    {
+        if (strcmp(sim_workload(loaded[i]), path) == 0)
+            return loaded[i];
+    }
+
+    if (num_loaded == MAX_WORKLOADS)
+    {
+        printf("Manifest uses more than %d workload files.\n", MAX_WORKLOADS);
+        return NULL;
+    }
+
+    Simulator *sim = sim_create(path);
+    if (sim != NULL)
+        loaded[num_loaded++] = sim;
+    return sim;
+}
+
+static void workloads_free(void)
+{
+    for (int i = 0; i < num_loaded; i++)
+        sim_destroy(loaded[i]);
+    num_loaded = 0;
+}
+
+// Split a manifest line into argv-style words (argv[0] is unused, like a
+// program name). Cuts the line at '#'. Returns the word count.
+static int split_line(char *line, char *argv[], int max_args)
+{
+    int argc = 1;
+    argv[0] = "manifest";
+
+    char *hash = strchr(line, '#');
+    if (hash != NULL)
+        *hash = '\0';
+
+    for (char *word = strtok(line, " \t\r\n"); word != NULL; word = strtok(NULL, " \t\r\n"))
+    {
+        if (argc == max_args)
+            return -1;
+        argv[argc++] = word;
+    }
+    return argc;
+}
+
+static void write_header(FILE *out)
+{
+    fprintf(out, "run,line,workload,algorithm,quantum,cpus,cs_cost,cache_penalty,cache_halflife,"
+                 "adaptive_quantum,predict,preemptive,aging,"
+                 "processes,makespan,avg_turnaround,avg_wait,avg_response,utilization,context_switches,"
+                 "p50_turnaround,p99_turnaround,p99_wait,p99_response,p99_slowdown,dvfs,energy_j,avg_power_w,"
+                 "numa,remote_fraction,cross_node_migrations,cross_node_wakeups\n");
+}
+
+static void write_row(FILE *out, int run_number, int line_number, const RunConfig *run,
+                      const SimResults *r)
+{
+    const RunSummary *s = &r->summary;
+
+    fprintf(out, "%d,%d,%s,%s,%d,%d,%d,%d,%d,%g,%g,%d,%d,%d,%" PRIdTIME ",%.3f,%.3f,%.3f,%.4f,%ld,%ld,%ld,%ld,%ld,%.2f,\"%s\",%.4f,%.4f,%s,%.4f,%ld,%ld\n",
+            run_number, line_number,
+            run->workload_path != NULL ? run->workload_path : "demo",
+            run->algorithm, run->quantum, run->smp.cpus,
+            run->switch_cost, run->cache_penalty, cost_halflife(),
+            run->adaptive_percentile, run->predict_alpha, run->preemptive, run->aging,
+            s->processes, s->makespan, s->avg_turnaround, s->avg_wait, s->avg_response,
+            r->utilization, r->cost.context_switches,
+            s->p50_turnaround, s->p99_turnaround, s->p99_wait, s->p99_response, s->p99_slowdown,
+            run->dvfs != NULL ? run->dvfs : "off", r->energy_j, r->avg_power_w,
+            run->numa != NULL ? run->numa : "off", r->remote_fraction,
+            r->cross_node_migrations, r->cross_node_wakeups);
+}
+
+int run_manifest(const char *manifest_path, const char *results_path, const RunConfig *base,
+                 Process demo[], int num_demo)
+{
+    FILE *manifest = fopen(manifest_path, "r");
+    if (manifest == NULL)
+    {
+        printf("Cannot open manifest %s\n", manifest_path);
+        return -1;
+    }
+
+    FILE *out = stdout;
+    if (results_path != NULL && (out = fopen(results_path, "w")) == NULL)
+    {
+        printf("Cannot create results file %s\n", results_path);
+        fclose(manifest);
+        return -1;
+    }
+
+    Simulator *demo_sim = sim_create_from(demo, num_demo);
+    write_header(out);
+
+    char line[MANIFEST_LINE_LEN];
+    char *args[MANIFEST_MAX_ARGS];
+    int line_number = 0;
+    int runs = 0;
+    int failed = 0;
+
+    while (fgets(line, sizeof(line), manifest) != NULL)
+    {
+        line_number++;
+
+        //* A full buffer without its newline: the rest of the line must not
+        //* come back as another run
+        size_t len = strlen(line);
+        if (len == sizeof(line) - 1 && line[len - 1] != '\n')
+        {
+            int c = fgetc(manifest);
+            if (c != EOF && c != '\n')
+            {
+                while (c != EOF && c != '\n')
+                    c = fgetc(manifest);
+                printf("%s:%d: line too long (over %d characters)\n", manifest_path, line_number,
+                       MANIFEST_LINE_LEN - 1);
+                failed++;
+                continue;
+            }
+        }
+
+        int argc = split_line(line, args, MANIFEST_MAX_ARGS);
+        if (argc == 1)
+            continue;
+
+        RunConfig run = *base;
+        int ok = argc > 0;
+
+        if (!ok)
+            printf("%s:%d: too many options\n", manifest_path, line_number);
+
+        for (int i = 1; ok && i < argc; i++)
+        {
+            int parsed = parse_run_option(&run, argc, args, &i);
+            if (parsed == 0)
+                printf("%s:%d: %s is not a run option\n", manifest_path, line_number, args[i]);
+            ok = parsed == 1;
+        }
+
+        const char *problem = ok ? run_check(&run) : NULL;
+        if (problem != NULL)
+        {
+            printf("%s:%d: %s\n", manifest_path, line_number, problem);
+            ok = 0;
+        }
+
+        Simulator *sim = demo_sim;
+        if (ok && run.workload_path != NULL)
+        {
+            if ((sim = workload_get(run.workload_path)) == NULL)
+                ok = 0;
+            else
+                run.workload_path = sim_workload(sim); // outlives this line
+        }
+
+        if (!ok)
+        {
+            failed++;
+            continue;
+        }
+
+        //* Every run starts from the same state
+        SimResults results;
+        if (sim_run(sim, &run, &results) != 0)
+        {
+            printf("%s:%d: %s\n", manifest_path, line_number, sim_error(sim));
+            failed++;
+            continue;
+        }
+
+        runs++;
+        write_row(out, runs, line_number, &run, &results);
+        if (out != stdout)
+            printf("run %d (line %d): %s %s makespan %" PRIdTIME ", avg turnaround %.2f\n",
+                   runs, line_number, run.workload_path != NULL ? run.workload_path : "demo",
+                   run.algorithm, results.summary.makespan, results.summary.avg_turnaround);
+    }
+
+    fclose(manifest);
+    if (out != stdout)
+    {
+        fclose(out);
+        printf("%d runs, %d failed, results in %s\n", runs, failed, results_path);
+    }
+    workloads_free();
+    sim_destroy(demo_sim);
+
+    return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,85 @@
+#ifndef EXPERIMENT_H
+#define EXPERIMENT_H
+
+#include "process.h"
+#include "smp.h"
+
+//* Everything that can vary from one simulation run to the next
+typedef struct RunConfig
+{
+    const char *algorithm;
+    int quantum;
+    const char *workload_path;      // NULL = built-in demo workload
+
+    //* context-switch cost model, off by default
+    int switch_cost;
+    int cache_penalty;
+    int cache_halflife;
+
+    //* adaptive RR quantum: percentile of recent CPU bursts (0 = fixed quantum)
+    double adaptive_percentile;
+
+    //* SJF/STCF burst prediction: exponential-averaging weight (0 = use true bursts)
+    double predict_alpha;
+    double predict_initial;
+
+    //* SJF/STCF ready-queue structure (rq_kind_t, RQ_AUTO = by workload size)
+    int ready_queue;
+
+    //* priority scheduling: preemptive variant and aging (ticks per level, 0 = off)
+    int preemptive;
+    int aging;
+
+    //* partitioned SMP simulation (cpus = 0: single-CPU schedulers)
+    SmpConfig smp;
+
+    //* gang scheduling: rows of the Ousterhout matrix
+    int gang_rows;
+
+    //* frequency scaling and idle states: "governor[:GHz,...]" (NULL = off)
+    const char *dvfs;
+
+    //* NUMA topology "SxCxT" (NULL = flat --cpus) and its slowdowns in percent
+    const char *numa;
+    int remote_penalty;
+    int smt_penalty;
+} RunConfig;
+
+void run_config_defaults(RunConfig *run);
+
+// Value of the option at argv[*i], advancing *i; prints an error and
+// returns NULL if the command line ends first
+const char *option_value(int argc, char *argv[], int *i);
+
+// Parse the run option at argv[*i] (advancing *i past its value).
+// Returns 1 if it was one, 0 if argv[*i] is not a run option, -1 on a bad
+// or missing value (already reported).
+int parse_run_option(RunConfig *run, int argc, char *argv[], int *i);
+
+// NULL if the run can be simulated, otherwise why not
+const char *run_check(const RunConfig *run);
+
+// Set the per-run knobs of the cost model, RR, priority and prediction
+void run_configure(const RunConfig *run);
+
+// Simulate with run->algorithm (on run->smp.cpus CPUs if set).
+// Returns -1 for an unknown algorithm, 1 if the workload cannot run under
+// it (already reported).
+int run_schedule(const RunConfig *run, Process processes[], int num_processes);
+
+//* Batch experiments
+//
+// A manifest lists one run per line, written as command-line run options
+// on top of the ones given to the program ('#' starts a comment):
+//
+//   --workload big.txt --algorithm RR --quantum 2
+//   --workload big.txt --algorithm RR --quantum 4 --cs-cost 1
+//   --workload big.txt --algorithm FIFO --cpus 16 --threads 4
+//
+// Each workload file is loaded once and reset between runs. Results go to
+// one CSV row per run. Devices and groups come from the command line and
+// apply to every run. Returns 0 if every run succeeded.
+int run_manifest(const char *manifest_path, const char *results_path, const RunConfig *base,
+                 Process demo[], int num_demo);
+
+#endif
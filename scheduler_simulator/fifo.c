@@ -1,9 +1,20 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include "fifo.h"
+#include "io_device.h"
+#include "cost.h"
+#include "power.h"
+#include "trace.h"
+#include "group.h"
+#include "profile.h"
+#include "arrivals.h"
+#include "horizon.h"
 
 // Initialize empty queue
-void init_queue(readyQueue *q)
+void init_queue(readyQueue *q, int capacity)
 {
+    q->queue = malloc(capacity * sizeof(Process *));
+    q->capacity = capacity;
     q->front = 0;
     q->rear = 0;
     q->size = 0;
@@ -12,11 +23,12 @@ void init_queue(readyQueue *q)
 // enqueue logic
 void enqueue(readyQueue *q, Process *p)
 {
-    if (q->size >= MAX_PROCESSES)
+    PROF_COUNT(COUNT_ENQUEUE);
+    if (q->size >= q->capacity)
         return; // Queue full
 
     q->queue[q->rear] = p;
-    q->rear = (q->rear + 1) % MAX_PROCESSES;
+    q->rear = (q->rear + 1) % q->capacity;
     p->in_queue = 1;
     q->size++;
 }
@@ -24,11 +36,12 @@ void enqueue(readyQueue *q, Process *p)
 // dequeue logic
 Process *dequeue(readyQueue *q)
 {
+    PROF_COUNT(COUNT_DEQUEUE);
     if (q->size == 0)
         return NULL; // Queue empty
 
     Process *p = q->queue[q->front];
-    q->front = (q->front + 1) % MAX_PROCESSES;
+    q->front = (q->front + 1) % q->capacity;
     q->size--;
     p->in_queue = 0;
     return p;
@@ -40,38 +53,36 @@ int is_empty(readyQueue *q)
     return q->size == 0;
 }
 
-void check_new_arrivals(Process processes[], int num_processes, int current_time, readyQueue *q)
+void check_new_arrivals(Process processes[], ArrivalCursor *arrivals, sim_time_t current_time, readyQueue *q)
 {
-    for (int i = 0; i < num_processes; i++)
+    for (int i; (i = arrivals_next(arrivals, processes, current_time)) >= 0; )
     {
-        if (processes[i].arrival_time == current_time && processes[i].completed_flag == 0)
+        if (processes[i].completed_flag == 0)
         {
             enqueue(q, &processes[i]);
         }
     }
 }
 
-void printing(Process processes[], int num_processes, int current_time, Process *running_process, readyQueue rq, int completed)
+void printing(Process processes[], int num_processes, sim_time_t current_time, Process *running_process, readyQueue rq, int completed)
 {
     // Replace your printing section with this enhanced version
 
-    printf("\n=== Time %d ===\n", current_time);
+    trace_line(TEXT_TICK, NULL, current_time, 0, 0);
 
     // Print what happened during I/O completions
     for (int i = 0; i < num_processes; i++)
     {
         if (processes[i].state == BLOCKED && processes[i].io_end_time == current_time)
         {
-            printf("  ✓ %s completed I/O, ", processes[i].pid);
             if (processes[i].current_burst + 1 < processes[i].num_bursts)
             {
-                printf("moving to CPU burst %d (duration: %d)\n",
-                       processes[i].current_burst + 1,
-                       processes[i].cpu_bursts[processes[i].current_burst + 1]);
+                trace_line(TEXT_IO_DONE, &processes[i], current_time, processes[i].current_burst + 1,
+                           processes[i].cpu_bursts[processes[i].current_burst + 1]);
             }
             else
             {
-                printf("all bursts completed - FINISHED\n");
+                trace_line(TEXT_IO_DONE, &processes[i], current_time, -1, 0);
             }
         }
     }
@@ -81,7 +92,7 @@ void printing(Process processes[], int num_processes, int current_time, Process
     {
         if (processes[i].arrival_time == current_time)
         {
-            printf("  → %s arrived and added to ready queue\n", processes[i].pid);
+            trace_line(TEXT_ARRIVED, &processes[i], current_time, 0, 0);
         }
     }
 
@@ -89,87 +100,82 @@ void printing(Process processes[], int num_processes, int current_time, Process
     if (running_process == NULL && !is_empty(&rq))
     {
         Process *next = rq.queue[rq.front]; // Peek at next process
-        printf("  🖥️  CPU assigned to %s (burst %d, duration: %d)\n",
-               next->pid, next->current_burst, next->remaining_time);
+        trace_line(TEXT_ASSIGNED, next, current_time, 0, 0);
+        trace_line(TEXT_ASSIGNED_REST, next, current_time, next->current_burst, next->remaining_time);
     }
 
     // Print execution
     if (running_process != NULL)
     {
-        printf("  ⚡ %s executing (remaining: %d → %d)\n",
-               running_process->pid,
-               running_process->remaining_time,
-               running_process->remaining_time - 1);
+        trace_line(TEXT_EXECUTING, running_process, current_time, running_process->remaining_time, 0);
 
         // Check if this will complete the burst
         if (running_process->remaining_time == 1)
         {
             if (running_process->current_burst == running_process->num_bursts - 1)
             {
-                printf("     └─ Will FINISH after this tick\n");
+                trace_line(TEXT_WILL_FINISH, running_process, current_time, 0, 0);
             }
             else
             {
-                int io_duration = running_process->io_times[running_process->current_burst];
-                printf("     └─ Will go to I/O (duration: %d) after this tick\n", io_duration);
+                sim_time_t io_duration = running_process->io_times[running_process->current_burst];
+                trace_line(TEXT_WILL_IO, running_process, current_time, io_duration, 0);
             }
         }
     }
     else
     {
-        printf("  💤 CPU: IDLE\n");
+        trace_line(TEXT_IDLE_NOTE, NULL, current_time, 0, 0);
     }
 
     // Print current system state
-    printf("  📊 System State:\n");
-    printf("     Running: ");
+    trace_line(TEXT_STATE, NULL, current_time, 0, 0);
     if (running_process != NULL)
     {
-        printf("%s (burst %d, remaining: %d after execution)\n",
-               running_process->pid, running_process->current_burst,
-               running_process->remaining_time - 1);
+        trace_line(TEXT_RUNNING, running_process, current_time, 0, 0);
+        trace_line(TEXT_RUNNING_REST, running_process, current_time, running_process->current_burst,
+                   running_process->remaining_time - 1);
     }
     else
     {
-        printf("None\n");
+        trace_line(TEXT_RUNNING_NONE, NULL, current_time, 0, 0);
     }
 
-    printf("     Ready Queue: [");
+    trace_line(TEXT_READY_OPEN, NULL, current_time, 0, 0);
     for (int i = 0; i < rq.size; i++)
     {
-        int idx = (rq.front + i) % MAX_PROCESSES;
-        printf("%s", rq.queue[idx]->pid);
-        if (i < rq.size - 1)
-            printf(", ");
+        int idx = (rq.front + i) % rq.capacity;
+        trace_line(TEXT_ITEM, rq.queue[idx], current_time, 0, 0);
     }
-    printf("]\n");
+    trace_line(TEXT_CLOSE, NULL, current_time, 0, 0);
 
-    printf("     Blocked (I/O): [");
-    int first_blocked = 1;
+    trace_line(TEXT_BLOCKED_OPEN, NULL, current_time, 0, 0);
     for (int i = 0; i < num_processes; i++)
     {
         if (processes[i].state == BLOCKED)
         {
-            if (!first_blocked)
-                printf(", ");
-            printf("%s(ends@%d)", processes[i].pid, processes[i].io_end_time);
-            first_blocked = 0;
+            if (io_is_queued(&processes[i]))
+                trace_line(TEXT_ITEM_QUEUED, &processes[i], current_time, 0, 0);
+            else
+                trace_line(TEXT_ITEM_ENDS, &processes[i], current_time, processes[i].io_end_time, 0);
         }
     }
-    printf("]\n");
+    trace_line(TEXT_CLOSE, NULL, current_time, 0, 0);
 
-    printf("     Completed: %d/%d\n", completed, num_processes);
+    trace_line(TEXT_COMPLETED, NULL, current_time, completed, num_processes);
 }
 
 void fifo_schedule(Process processes[], int num_processes)
 {
-    int current_time = 0;
+    sim_time_t current_time = 0;
     int completed = 0;
 
     Process *running_process = NULL;
 
     readyQueue rq;
-    init_queue(&rq);
+    init_queue(&rq, num_processes);
+    ArrivalCursor arrivals;
+    arrivals_begin(&arrivals, processes, num_processes);
 
     // @note
     //* Check I/O completions (blocked → ready)
@@ -179,54 +185,118 @@ void fifo_schedule(Process processes[], int num_processes)
 
     while (completed < num_processes)
     {
+        PROF_COUNT(COUNT_TICKS);
+        PROF_BEGIN(PHASE_IO);
+
+        //* 0) Advance I/O devices (frees units, starts queued requests)
+        io_tick(current_time);
+
+        // Groups whose period rolled over hand their parked processes back
+        Process *released;
+        while ((released = group_release(current_time)) != NULL)
+            enqueue(&rq, released);
 
         //* 1. Check I/O completions (blocked → ready)
-        for (int i = 0; i < num_processes; i++)
+        Process *done;
+        while ((done = io_next_done(current_time)) != NULL)
         {
-            if (processes[i].state == BLOCKED && processes[i].io_end_time == current_time)
-            {
+            int i = done - processes;
+            PROF_COUNT(COUNT_PROCESS_SCAN);
 
-                // I/O completed, move back to READY
-                processes[i].state = READY;
-                processes[i].current_burst++; // Move to next CPU burst
+            // I/O completed, move back to READY
+            processes[i].state = READY;
+            trace_event(TRACE_UNBLOCK, i, current_time);
+            processes[i].current_burst++; // Move to next CPU burst
 
-                // Check if remaining CPU bursts
-                if (processes[i].current_burst < processes[i].num_bursts)
-                {
-                    // More CPU bursts remaining
-                    processes[i].remaining_time = processes[i].cpu_bursts[processes[i].current_burst];
-                    if (!processes[i].in_queue)
-                    {
-                        enqueue(&rq, &processes[i]);
-                    }
-                }
-                else
+            // Check if remaining CPU bursts
+            if (processes[i].current_burst < processes[i].num_bursts)
+            {
+                // More CPU bursts remaining
+                processes[i].remaining_time = processes[i].cpu_bursts[processes[i].current_burst];
+                if (!processes[i].in_queue)
                 {
-                    // No more CPU bursts - process is finished
-                    processes[i].state = FINISHED;
-                    processes[i].completed_flag = 1;
-                    completed++;
+                    enqueue(&rq, &processes[i]);
                 }
             }
+            else
+            {
+                // No more CPU bursts - process is finished
+                processes[i].state = FINISHED;
+                processes[i].completed_flag = 1;
+                completed++;
+                trace_event(TRACE_FINISH, i, current_time);
+            }
         }
 
+        PROF_END(PHASE_IO);
+        PROF_BEGIN(PHASE_ARRIVALS);
+
         //* 2. Check new arrivals
-        check_new_arrivals(processes, num_processes, current_time, &rq);
+        check_new_arrivals(processes, &arrivals, current_time, &rq);
+
+        PROF_END(PHASE_ARRIVALS);
+        PROF_BEGIN(PHASE_SELECT);
 
         //* 3. Get next process from ready queue if CPU is free
-        if (running_process == NULL && !is_empty(&rq))
+        while (running_process == NULL && !is_empty(&rq))
         {
             running_process = dequeue(&rq);
+            if (group_throttled(running_process))
+            {
+                // Group is out of quota: the process waits there, try the next one
+                group_park(running_process, current_time);
+                running_process = NULL;
+                continue;
+            }
             running_process->state = RUNNING;
+            cost_dispatch(running_process, 0, current_time);
+            trace_event(TRACE_DISPATCH, running_process - processes, current_time);
+            PROF_COUNT(COUNT_DISPATCH);
         }
 
+        PROF_END(PHASE_SELECT);
+        PROF_BEGIN(PHASE_EXECUTE);
+
         //* 4. Execute current running process
-        if (running_process != NULL)
+        int slowed = power_tick(0, running_process != NULL, current_time);
+
+        if (running_process != NULL && slowed != POWER_RUN)
+        {
+            // Waking from an idle state / below top frequency: busy, no progress
+            if (trace_text)
+            {
+                if (slowed == POWER_WAKING)
+                    trace_line(TEXT_WAKING, running_process, current_time, 0, 0);
+                else
+                    trace_line_ghz(TEXT_SLOW, running_process, current_time, power_frequency(0));
+            }
+        }
+        else if (running_process != NULL && cost_stalled(0))
+        {
+            // Context switch / cache refill: CPU busy, process makes no progress
+            if (trace_text)
+            {
+                trace_line(TEXT_SWITCHING, running_process, current_time, 0, 0);
+            }
+        }
+        else if (running_process != NULL)
         {
             // printf("Running: %s (remaining: %d) \n", running_process->pid, running_process->remaining_time);
-            printing(processes, num_processes, current_time, running_process, rq, completed);
+            if (trace_text)
+            {
+                PROF_BEGIN(PHASE_PRINT);
+                printing(processes, num_processes, current_time, running_process, rq, completed);
+                PROF_END(PHASE_PRINT);
+            }
+            //* Up to the next event at once when nothing needs every tick (horizon.h)
+            sim_time_t run = horizon_run(&arrivals, processes, current_time,
+                                         running_process->remaining_time, SIM_TIME_MAX);
+            PROF_ADD(COUNT_TICKS, run - 1);
+            current_time += run - 1;
+            running_process->last_ran = current_time;
             // ! run and try to understand which of the two will be up and down
-            running_process->remaining_time--;
+            running_process->remaining_time -= run;
+            int throttled = group_charge(running_process, current_time);
 
             // Check if current CPU burst is complete
             if (running_process->remaining_time == 0)
@@ -239,24 +309,49 @@ void fifo_schedule(Process processes[], int num_processes)
                     running_process->state = FINISHED;
                     running_process->completed_flag = 1;
                     completed++;
+                    trace_event(TRACE_FINISH, running_process - processes, current_time + 1);
                     running_process = NULL;
                 }
                 else
                 {
                     // Move to I/O
                     running_process->state = BLOCKED;
-                    int io_duration = running_process->io_times[running_process->current_burst];
-                    running_process->io_end_time = current_time + io_duration + 1;
+                    io_submit(running_process, current_time);
+                    trace_event(TRACE_BLOCK, running_process - processes, current_time + 1);
                     running_process = NULL;
                 }
             }
+            else if (throttled)
+            {
+                // Group ran out of quota: off the CPU until its next period
+                running_process->state = READY;
+                group_park(running_process, current_time + 1);
+                trace_event(TRACE_PREEMPT, running_process - processes, current_time + 1);
+                PROF_COUNT(COUNT_PREEMPT);
+                running_process = NULL;
+            }
         }
         else
         {
-            printf("[Time %d] ", current_time);
-            printf("CPU: IDLE \n");
+            PROF_COUNT(COUNT_IDLE_TICKS);
+            if (trace_text)
+            {
+                trace_line_str(TEXT_IDLE, NULL, current_time, 0, power_idle_name(0));
+            }
+
+            // Idle until the next event (horizon.h)
+            sim_time_t last = horizon_idle(&arrivals, processes, current_time);
+            PROF_ADD(COUNT_TICKS, last - current_time);
+            PROF_ADD(COUNT_IDLE_TICKS, last - current_time);
+            current_time = last;
         }
 
+        PROF_END(PHASE_EXECUTE);
+
         current_time++;
+        progress_tick(current_time, completed);
     }
+
+    arrivals_end(&arrivals);
+    free(rq.queue);
 }
@@ -3,11 +3,10 @@
 
 #include "process.h"
 
-#define MAX_PROCESSES 100
-
 typedef struct readyQueue
 {
-    Process* queue[MAX_PROCESSES];
+    Process** queue;    // sized to the workload at init
+    int capacity;
     int front;
     int rear;
     int size;
@@ -0,0 +1,667 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "gang.h"
+#include "cost.h"
+#include "io_device.h"
+#include "metrics.h"
+#include "power.h"
+#include "trace.h"
+
+#define WORD_BITS 64
+
+typedef struct GangJob
+{
+    int id;                 // job= value, 0 for a single-thread job
+    Process **threads;
+    int size;
+    sim_time_t arrival;     // earliest thread arrival
+    sim_time_t placed_at;
+    sim_time_t finish;
+    int done;               // threads finished
+
+    //* Placement
+    int row;                // -1 until placed
+    int *columns;           // column per thread
+    int lo, hi;             // words [lo, hi] hold the job's columns
+    uint64_t *mask;         // mask[w - lo]: columns in word w
+} GangJob;
+
+typedef struct GangRow
+{
+    uint64_t *busy;         // columns taken; bits past the last CPU stay set
+    int used;
+    GangJob **jobs;         // in placement order
+    int num_jobs;
+} GangRow;
+
+typedef struct GangMachine
+{
+    Process *processes;
+    int num_processes;
+    int cpus;
+    int words;
+    int quantum;
+    int num_rows;
+
+    GangJob *jobs;
+    int num_jobs;
+    int *order;             // jobs by arrival
+    int next_arrival;
+    int live_jobs;
+    int finished;           // threads finished
+
+    GangRow rows[GANG_MAX_ROWS];
+    int active;
+    int slice_used;         // ticks of the slice in which no CPU was switching
+
+    //* Jobs waiting for a row, strict arrival order
+    GangJob **waiting;
+    int wait_front;
+    int wait_size;
+
+    //* This slice: the active row's jobs, then jobs of other rows that
+    //* fit into its unused columns. Rebuilt when the matrix changes.
+    GangJob **slice;
+    int slice_size;
+    int slice_primary;      // slice[0 .. slice_primary) come from the active row
+    uint64_t *covered;
+    int dirty;
+
+    //* Threads that ran the last tick, and their columns
+    Process **ran;
+    int *ran_column;
+    int num_ran;
+    Process **next_ran;
+    int *next_column;
+    sim_time_t *stamp;      // per process: last tick it was scheduled
+    sim_time_t *column_stamp; // per CPU: last tick it had a thread
+    int *job_of;            // per process: index into jobs
+
+    //* Blocked threads, min-heap on io_end_time
+    Process **io;
+    int io_size;
+} GangMachine;
+
+//* Last run, for gang_report()
+static struct
+{
+    int ran;
+    int cpus;
+    int quantum;
+    int rows;
+    int jobs;
+    int threads;
+    sim_time_t makespan;
+    int max_rows_used;
+    int max_waiting;
+    long slices;
+    long busy;              // thread executed
+    long stall;             // no progress: switching in, waking up, low frequency
+    long held;              // column belongs to a thread that cannot run
+    long fragmented;        // column unused while jobs waited for a row
+    long empty;             // column unused, nothing waiting
+    long alternate;         // executed by a thread from another row
+    double turnaround;
+    double placement_wait;
+} summary;
+
+static void *checked(void *ptr)
+{
+    if (ptr == NULL)
+    {
+        fprintf(stderr, "gang: out of memory\n");
+        exit(1);
+    }
+    return ptr;
+}
+
+// ---------------------------------------------------------------------------
+// I/O heap
+// ---------------------------------------------------------------------------
+
+static void io_push(GangMachine *m, Process *p)
+{
+    int i = m->io_size++;
+    while (i > 0)
+    {
+        int parent = (i - 1) / 2;
+        if (m->io[parent]->io_end_time <= p->io_end_time)
+            break;
+        m->io[i] = m->io[parent];
+        i = parent;
+    }
+    m->io[i] = p;
+}
+
+static Process *io_pop(GangMachine *m)
+{
+    Process *top = m->io[0];
+    Process *last = m->io[--m->io_size];
+    int i = 0;
+
+    for (;;)
+    {
+        int child = 2 * i + 1;
+        if (child >= m->io_size)
+            break;
+        if (child + 1 < m->io_size && m->io[child + 1]->io_end_time < m->io[child]->io_end_time)
+            child++;
+        if (last->io_end_time <= m->io[child]->io_end_time)
+            break;
+        m->io[i] = m->io[child];
+        i = child;
+    }
+    if (m->io_size > 0)
+        m->io[i] = last;
+    return top;
+}
+
+// ---------------------------------------------------------------------------
+// Matrix
+// ---------------------------------------------------------------------------
+
+// Give job the lowest free columns of row r
+static void place(GangMachine *m, GangJob *job, int r, sim_time_t t)
+{
+    GangRow *row = &m->rows[r];
+    int taken = 0;
+
+    job->lo = -1;
+    for (int w = 0; w < m->words && taken < job->size; w++)
+    {
+        uint64_t free_bits = ~row->busy[w];
+        while (free_bits != 0 && taken < job->size)
+        {
+            int bit = __builtin_ctzll(free_bits);
+            free_bits &= free_bits - 1;
+            row->busy[w] |= 1ULL << bit;
+            job->columns[taken++] = w * WORD_BITS + bit;
+            if (job->lo < 0)
+                job->lo = w;
+            job->hi = w;
+        }
+    }
+
+    job->mask = checked(calloc(job->hi - job->lo + 1, sizeof(uint64_t)));
+    for (int i = 0; i < job->size; i++)
+        job->mask[job->columns[i] / WORD_BITS - job->lo] |= 1ULL << (job->columns[i] % WORD_BITS);
+
+    row->jobs[row->num_jobs++] = job;
+    row->used += job->size;
+    job->row = r;
+    job->placed_at = t;
+    m->dirty = 1;
+}
+
+static void unplace(GangMachine *m, GangJob *job)
+{
+    GangRow *row = &m->rows[job->row];
+
+    for (int w = job->lo; w <= job->hi; w++)
+        row->busy[w] &= ~job->mask[w - job->lo];
+    row->used -= job->size;
+
+    int i = 0;
+    while (row->jobs[i] != job)
+        i++;
+    memmove(&row->jobs[i], &row->jobs[i + 1], (row->num_jobs - i - 1) * sizeof(GangJob *));
+    row->num_jobs--;
+
+    free(job->mask);
+    job->mask = NULL;
+    m->dirty = 1;
+}
+
+// Place waiting jobs in arrival order, first row with room; stop at the
+// first one that fits nowhere so big jobs are not starved
+static void place_waiting(GangMachine *m, sim_time_t t)
+{
+    while (m->wait_size > 0)
+    {
+        GangJob *job = m->waiting[m->wait_front];
+        int r = 0;
+        while (r < m->num_rows && m->cpus - m->rows[r].used < job->size)
+            r++;
+        if (r == m->num_rows)
+            break;
+
+        place(m, job, r, t);
+        m->wait_front++;
+        m->wait_size--;
+    }
+}
+
+static int overlaps(const GangMachine *m, const GangJob *job)
+{
+    for (int w = job->lo; w <= job->hi; w++)
+    {
+        if (m->covered[w] & job->mask[w - job->lo])
+            return 1;
+    }
+    return 0;
+}
+
+static void cover(GangMachine *m, const GangJob *job)
+{
+    for (int w = job->lo; w <= job->hi; w++)
+        m->covered[w] |= job->mask[w - job->lo];
+}
+
+// Active row first, then alternates from the following rows in turn
+static void build_slice(GangMachine *m)
+{
+    GangRow *active = &m->rows[m->active];
+
+    m->slice_size = 0;
+    memcpy(m->covered, active->busy, m->words * sizeof(uint64_t));
+    for (int j = 0; j < active->num_jobs; j++)
+        m->slice[m->slice_size++] = active->jobs[j];
+    m->slice_primary = m->slice_size;
+
+    // Only columns the active row leaves free are candidates
+    if (active->used < m->cpus)
+    {
+        for (int k = 1; k < m->num_rows; k++)
+        {
+            GangRow *row = &m->rows[(m->active + k) % m->num_rows];
+            for (int j = 0; j < row->num_jobs; j++)
+            {
+                if (overlaps(m, row->jobs[j]))
+                    continue;
+                cover(m, row->jobs[j]);
+                m->slice[m->slice_size++] = row->jobs[j];
+            }
+        }
+    }
+
+    m->dirty = 0;
+}
+
+// ---------------------------------------------------------------------------
+// Jobs
+// ---------------------------------------------------------------------------
+
+//* qsort comparators' view of the machine being built
+static const GangMachine *sorting;
+
+static int by_job(const void *a, const void *b)
+{
+    const Process *processes = sorting->processes;
+    int x = *(const int *)a, y = *(const int *)b;
+    int jx = processes[x].job, jy = processes[y].job;
+
+    // Single-thread jobs (job 0) stay apart, in workload order, after the rest
+    if (jx != jy)
+        return jx == 0 ? 1 : jy == 0 ? -1 : jx < jy ? -1 : 1;
+    return x - y;
+}
+
+static int by_arrival(const void *a, const void *b)
+{
+    const GangJob *jobs = sorting->jobs;
+    const GangJob *x = &jobs[*(const int *)a], *y = &jobs[*(const int *)b];
+
+    if (x->arrival != y->arrival)
+        return x->arrival < y->arrival ? -1 : 1;
+    return (int)(x->threads[0] - y->threads[0]);
+}
+
+// Group threads into jobs. Returns -1 if a job has more threads than CPUs.
+static int build_jobs(GangMachine *m, Process **members)
+{
+    int n = m->num_processes;
+    int *index = checked(malloc(n * sizeof(int)));
+    for (int i = 0; i < n; i++)
+        index[i] = i;
+    sorting = m;
+    qsort(index, n, sizeof(int), by_job);
+
+    m->jobs = checked(calloc(n, sizeof(GangJob)));
+    int *columns = checked(malloc(n * sizeof(int)));
+
+    for (int i = 0; i < n; )
+    {
+        Process *first = &m->processes[index[i]];
+        GangJob *job = &m->jobs[m->num_jobs++];
+        job->id = first->job;
+        job->threads = &members[i];
+        job->columns = &columns[i];
+        job->arrival = first->arrival_time;
+        job->row = -1;
+
+        do
+        {
+            Process *p = &m->processes[index[i]];
+            members[i++] = p;
+            job->size++;
+            if (p->arrival_time < job->arrival)
+                job->arrival = p->arrival_time;
+        } while (i < n && first->job != 0 && m->processes[index[i]].job == first->job);
+
+        if (job->size > m->cpus)
+        {
+            printf("Job %d has %d threads but the machine has %d CPUs.\n", job->id, job->size, m->cpus);
+            free(index);
+            return -1;
+        }
+    }
+
+    m->order = checked(malloc(m->num_jobs * sizeof(int)));
+    for (int j = 0; j < m->num_jobs; j++)
+        m->order[j] = j;
+    qsort(m->order, m->num_jobs, sizeof(int), by_arrival);
+
+    free(index);
+    return 0;
+}
+
+static void finish_job(GangMachine *m, GangJob *job, sim_time_t t)
+{
+    job->finish = t;
+    unplace(m, job);
+    m->live_jobs--;
+    summary.turnaround += job->finish - job->arrival;
+    summary.placement_wait += job->placed_at - job->arrival;
+}
+
+// ---------------------------------------------------------------------------
+// Simulation
+// ---------------------------------------------------------------------------
+
+static void run_tick(GangMachine *m, sim_time_t t)
+{
+    // @note tick t
+    // @note 1. jobs arriving now queue up; place what fits
+    while (m->next_arrival < m->num_jobs && m->jobs[m->order[m->next_arrival]].arrival == t)
+    {
+        GangJob *job = &m->jobs[m->order[m->next_arrival++]];
+        m->waiting[m->wait_front + m->wait_size++] = job;
+    }
+    place_waiting(m, t);
+    if (m->wait_size > summary.max_waiting)
+        summary.max_waiting = m->wait_size;
+
+    // @note 2. I/O completions
+    while (m->io_size > 0 && m->io[0]->io_end_time == t)
+    {
+        Process *p = io_pop(m);
+        p->current_burst++;
+        p->remaining_time = p->cpu_bursts[p->current_burst];
+        p->state = READY;
+        metrics_event(TRACE_UNBLOCK, (int)(p - m->processes), t);
+        progress_event();
+    }
+
+    // @note 3. next row when the slice is used up or the active row emptied
+    if (m->slice_used >= m->quantum || m->rows[m->active].num_jobs == 0)
+    {
+        for (int k = 1; k <= m->num_rows; k++)
+        {
+            int r = (m->active + k) % m->num_rows;
+            if (m->rows[r].num_jobs > 0)
+            {
+                m->active = r;
+                break;
+            }
+        }
+        m->slice_used = 0;
+        m->dirty = 1;
+        summary.slices++;
+    }
+    if (m->dirty)
+        build_slice(m);
+
+    int used_rows = 0;
+    for (int r = 0; r < m->num_rows; r++)
+        used_rows += m->rows[r].num_jobs > 0;
+    if (used_rows > summary.max_rows_used)
+        summary.max_rows_used = used_rows;
+
+    // @note 4. every runnable thread of the slice gets its column
+    int covered = 0;
+    int num_next = 0;
+    for (int s = 0; s < m->slice_size; s++)
+    {
+        GangJob *job = m->slice[s];
+        covered += job->size;
+
+        for (int i = 0; i < job->size; i++)
+        {
+            Process *p = job->threads[i];
+            if (p->state == BLOCKED || p->state == FINISHED || p->arrival_time > t)
+            {
+                summary.held++;
+                continue;
+            }
+
+            if (p->state != RUNNING)
+            {
+                p->state = RUNNING;
+                cost_dispatch(p, job->columns[i], t);
+                metrics_event(TRACE_DISPATCH, (int)(p - m->processes), t);
+                progress_event();
+            }
+            m->stamp[p - m->processes] = t;
+            m->column_stamp[job->columns[i]] = t;
+            m->next_ran[num_next] = p;
+            m->next_column[num_next++] = job->columns[i];
+            if (s >= m->slice_primary)
+                summary.alternate++;
+        }
+    }
+
+    if (m->wait_size > 0)
+        summary.fragmented += m->cpus - covered;
+    else
+        summary.empty += m->cpus - covered;
+
+    // @note 5. threads that ran last tick and lost their column were preempted;
+    // @note    columns left without a thread go idle
+    for (int i = 0; i < m->num_ran; i++)
+    {
+        Process *p = m->ran[i];
+        if (m->column_stamp[m->ran_column[i]] != t)
+            power_tick(m->ran_column[i], 0, t);
+        if (p->state == RUNNING && m->stamp[p - m->processes] != t)
+        {
+            p->state = READY;
+            metrics_event(TRACE_PREEMPT, (int)(p - m->processes), t);
+            progress_event();
+        }
+    }
+
+    Process **swap = m->ran;
+    m->ran = m->next_ran;
+    m->next_ran = swap;
+    int *swap_column = m->ran_column;
+    m->ran_column = m->next_column;
+    m->next_column = swap_column;
+    m->num_ran = num_next;
+
+    // @note 6. execute; like an RR quantum, the slice does not run out
+    // @note    while its threads are still being switched in or CPUs wake up
+    // @note    (running below top frequency does use it up)
+    int stalled = 0;
+    for (int i = 0; i < m->num_ran; i++)
+    {
+        Process *p = m->ran[i];
+        int power = power_tick(m->ran_column[i], 1, t);
+        if (power != POWER_RUN || cost_stalled(m->ran_column[i]))
+        {
+            summary.stall++;
+            if (power != POWER_SLOW)
+                stalled = 1;
+            continue;
+        }
+
+        summary.busy++;
+        p->last_ran = t;
+        p->remaining_time--;
+        if (p->remaining_time > 0)
+            continue;
+
+        if (p->current_burst == p->num_bursts - 1)
+        {
+            p->state = FINISHED;
+            p->completed_flag = 1;
+            m->finished++;
+            metrics_event(TRACE_FINISH, (int)(p - m->processes), t + 1);
+            progress_event();
+
+            GangJob *job = &m->jobs[m->job_of[p - m->processes]];
+            if (++job->done == job->size)
+                finish_job(m, job, t + 1);
+        }
+        else
+        {
+            p->state = BLOCKED;
+            p->io_end_time = io_default_end(t, p->io_times[p->current_burst]);
+            io_push(m, p);
+            progress_event();
+        }
+    }
+
+    if (!stalled)
+        m->slice_used++;
+}
+
+static void machine_free(GangMachine *m)
+{
+    for (int j = 0; j < m->num_jobs; j++)
+        free(m->jobs[j].mask);
+    if (m->num_jobs > 0)
+        free(m->jobs[0].columns);
+    for (int r = 0; r < m->num_rows; r++)
+    {
+        free(m->rows[r].busy);
+        free(m->rows[r].jobs);
+    }
+    free(m->jobs);
+    free(m->order);
+    free(m->waiting);
+    free(m->slice);
+    free(m->covered);
+    free(m->ran);
+    free(m->ran_column);
+    free(m->next_ran);
+    free(m->next_column);
+    free(m->stamp);
+    free(m->column_stamp);
+    free(m->io);
+    free(m->job_of);
+}
+
+int gang_schedule(Process processes[], int num_processes, const GangConfig *config)
+{
+    GangMachine m;
+    memset(&m, 0, sizeof(m));
+    memset(&summary, 0, sizeof(summary));
+
+    m.processes = processes;
+    m.num_processes = num_processes;
+    m.cpus = config->cpus;
+    m.words = (config->cpus + WORD_BITS - 1) / WORD_BITS;
+    m.quantum = config->quantum;
+    m.num_rows = config->rows;
+
+    Process **members = checked(malloc(num_processes * sizeof(Process *)));
+    if (build_jobs(&m, members) != 0)
+    {
+        free(members);
+        machine_free(&m);
+        return -1;
+    }
+
+    m.job_of = checked(malloc(num_processes * sizeof(int)));
+    for (int j = 0; j < m.num_jobs; j++)
+    {
+        for (int i = 0; i < m.jobs[j].size; i++)
+            m.job_of[m.jobs[j].threads[i] - processes] = j;
+    }
+
+    for (int r = 0; r < m.num_rows; r++)
+    {
+        m.rows[r].busy = checked(calloc(m.words, sizeof(uint64_t)));
+        if (m.cpus % WORD_BITS != 0)
+            m.rows[r].busy[m.words - 1] = ~0ULL << (m.cpus % WORD_BITS);
+        m.rows[r].jobs = checked(malloc(m.cpus * sizeof(GangJob *)));
+    }
+
+    m.waiting = checked(malloc(m.num_jobs * sizeof(GangJob *)));
+    m.slice = checked(malloc(m.num_jobs * sizeof(GangJob *)));
+    m.covered = checked(malloc(m.words * sizeof(uint64_t)));
+    m.ran = checked(malloc(m.cpus * sizeof(Process *)));
+    m.ran_column = checked(malloc(m.cpus * sizeof(int)));
+    m.next_ran = checked(malloc(m.cpus * sizeof(Process *)));
+    m.next_column = checked(malloc(m.cpus * sizeof(int)));
+    m.stamp = checked(malloc(num_processes * sizeof(sim_time_t)));
+    m.column_stamp = checked(malloc(m.cpus * sizeof(sim_time_t)));
+    m.io = checked(malloc(num_processes * sizeof(Process *)));
+    for (int i = 0; i < num_processes; i++)
+        m.stamp[i] = -1;
+    for (int i = 0; i < m.cpus; i++)
+        m.column_stamp[i] = -1;
+
+    m.live_jobs = m.num_jobs;
+    sim_time_t t = 0;
+
+    while (m.live_jobs > 0)
+    {
+        //* Machine empty: skip to the next arrival
+        if (m.wait_size == 0 && m.io_size == 0 && m.num_ran == 0)
+        {
+            int used = 0;
+            for (int r = 0; r < m.num_rows && !used; r++)
+                used = m.rows[r].num_jobs > 0;
+
+            sim_time_t next = m.next_arrival < m.num_jobs ? m.jobs[m.order[m.next_arrival]].arrival : t;
+            if (!used && next > t)
+            {
+                summary.empty += (long)(next - t) * m.cpus;
+                t = next;
+            }
+        }
+
+        run_tick(&m, t);
+        t++;
+        progress_tick(t, m.finished);
+    }
+
+    summary.ran = 1;
+    summary.cpus = m.cpus;
+    summary.quantum = m.quantum;
+    summary.rows = m.num_rows;
+    summary.jobs = m.num_jobs;
+    summary.threads = num_processes;
+    summary.makespan = t;
+
+    free(members);
+    machine_free(&m);
+    return 0;
+}
+
+void gang_report(void)
+{
+    if (!summary.ran)
+        return;
+
+    double slots = (double)summary.cpus * (summary.makespan > 0 ? summary.makespan : 1);
+
+    printf("\n=== Gang: %d CPUs, %d rows, slice %d ===\n", summary.cpus, summary.rows, summary.quantum);
+    printf("  jobs:            %d (%d threads)\n", summary.jobs, summary.threads);
+    printf("  makespan:        %" PRIdTIME " ticks (%ld slices)\n", summary.makespan, summary.slices);
+    printf("  avg turnaround:  %.2f ticks per job\n", summary.jobs ? summary.turnaround / summary.jobs : 0.0);
+    printf("  avg row wait:    %.2f ticks (max %d jobs waiting)\n",
+           summary.jobs ? summary.placement_wait / summary.jobs : 0.0, summary.max_waiting);
+    printf("  rows used:       %d max\n", summary.max_rows_used);
+    printf("  CPU slots (CPUs x ticks):\n");
+    printf("    running:       %5.1f%% (%.1f%% filled from other rows)\n",
+           100.0 * summary.busy / slots, 100.0 * summary.alternate / slots);
+    printf("    stalled:       %5.1f%% (context switch, idle exit, low frequency)\n", 100.0 * summary.stall / slots);
+    printf("    held idle:     %5.1f%% (thread blocked, finished or not arrived)\n", 100.0 * summary.held / slots);
+    printf("    fragmented:    %5.1f%% (unused while jobs waited for a row)\n", 100.0 * summary.fragmented / slots);
+    printf("    empty:         %5.1f%%\n", 100.0 * summary.empty / slots);
+}
@@ -0,0 +1,41 @@
+#ifndef GANG_H
+#define GANG_H
+
+#include "process.h"
+
+#define GANG_MAX_ROWS 64
+
+//* Gang scheduling (Ousterhout matrix)
+//
+// Threads of a parallel job carry the same job=N attribute in the
+// workload; a process without one is a job of its own. Every job is given
+// one column (CPU) per thread in a row of the matrix:
+//
+//             CPU 0  CPU 1  CPU 2  CPU 3
+//     row 0   A.0    A.1    A.2    B.0
+//     row 1   C.0    C.1    -      -
+//
+// Rows take turns, one time slice (--quantum) each, so all threads of a
+// job run in the same slice. A job goes into the first row with enough
+// free columns; once the matrix has rows rows and none has room, jobs wait
+// in arrival order. Columns a slice leaves unused go to jobs of other rows
+// that fit entirely into them (alternate selection).
+//
+// Rows are bitsets of busy columns and each job keeps the mask of its
+// columns, so placement and filling cost a few word operations per job.
+// I/O uses the default device timing.
+
+typedef struct GangConfig
+{
+    int cpus;
+    int quantum;    // slice length in ticks
+    int rows;       // matrix rows (multiprogramming level), 1..GANG_MAX_ROWS
+} GangConfig;
+
+// Returns -1 (after saying why) if a job has more threads than there are CPUs
+int gang_schedule(Process processes[], int num_processes, const GangConfig *config);
+
+// Slot usage and fragmentation of the last run
+void gang_report(void);
+
+#endif
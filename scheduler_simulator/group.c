@@ -0,0 +1,329 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "group.h"
+#include "trace.h"
+
+#define DEFAULT_SHARES 1024
+
+int groups_enabled = 0;
+
+static CpuGroup groups[MAX_GROUPS] = {
+    {.path = "/", .shares = DEFAULT_SHARES, .quota = -1}
+};
+static int num_groups = 1;
+
+//* Throttled groups, min-heap on period_end: a tick only looks at the top
+static CpuGroup *throttled[MAX_GROUPS];
+static int num_throttled = 0;
+
+// Parked processes of the group being released, handed out one per call
+static Process *releasing = NULL;
+
+// ---------------------------------------------------------------------------
+// Configuration
+// ---------------------------------------------------------------------------
+
+CpuGroup *group_find(const char *path)
+{
+    if (strcmp(path, "/") == 0)
+        return &groups[0];
+
+    for (int i = 1; i < num_groups; i++)
+    {
+        if (strcmp(groups[i].path, path) == 0)
+            return &groups[i];
+    }
+    return NULL;
+}
+
+// "max" or "<quota>/<period>"
+static int parse_limit(const char *s, int *quota, int *period)
+{
+    if (strcmp(s, "max") == 0)
+    {
+        *quota = -1;
+        return 0;
+    }
+
+    char *end;
+    long q = strtol(s, &end, 10);
+    if (end == s || *end != '/' || q <= 0)
+        return -1;
+
+    const char *p = end + 1;
+    long per = strtol(p, &end, 10);
+    if (end == p || *end != '\0' || per <= 0 || q > per)
+        return -1;
+
+    *quota = (int)q;
+    *period = (int)per;
+    return 0;
+}
+
+int group_configure(const char *spec)
+{
+    char *copy = strdup(spec);
+    char *save = NULL;
+
+    for (char *entry = strtok_r(copy, ",", &save); entry != NULL; entry = strtok_r(NULL, ",", &save))
+    {
+        char *path = entry;
+        char *limit = strchr(path, ':');
+        char *shares = NULL;
+
+        if (limit != NULL)
+        {
+            *limit++ = '\0';
+            shares = strchr(limit, ':');
+            if (shares != NULL)
+                *shares++ = '\0';
+        }
+
+        if (*path == '\0' || *path == '/' || path[strlen(path) - 1] == '/' ||
+            strlen(path) >= GROUP_PATH_LEN || group_find(path) != NULL)
+        {
+            fprintf(stderr, "Invalid or duplicate group path in --groups: '%s'\n", path);
+            free(copy);
+            return -1;
+        }
+        if (num_groups == MAX_GROUPS)
+        {
+            fprintf(stderr, "Too many groups (max %d)\n", MAX_GROUPS - 1);
+            free(copy);
+            return -1;
+        }
+
+        CpuGroup *g = &groups[num_groups];
+        memset(g, 0, sizeof(*g));
+        strcpy(g->path, path);
+        g->shares = DEFAULT_SHARES;
+        g->quota = -1;
+
+        //* Parent is everything before the last '/', or the root
+        char *slash = strrchr(path, '/');
+        if (slash != NULL)
+        {
+            *slash = '\0';
+            g->parent = group_find(path);
+            if (g->parent == NULL)
+            {
+                fprintf(stderr, "Group '%s': parent '%s' must be declared first\n", g->path, path);
+                free(copy);
+                return -1;
+            }
+        }
+        else
+        {
+            g->parent = &groups[0];
+        }
+
+        if (limit != NULL && *limit != '\0' && parse_limit(limit, &g->quota, &g->period) != 0)
+        {
+            fprintf(stderr, "Invalid limit '%s' for group '%s' (use <quota>/<period> or max)\n", limit, g->path);
+            free(copy);
+            return -1;
+        }
+        if (shares != NULL && (g->shares = atoi(shares)) <= 0)
+        {
+            fprintf(stderr, "Invalid shares '%s' for group '%s'\n", shares, g->path);
+            free(copy);
+            return -1;
+        }
+
+        g->parent->child_shares += g->shares;
+        num_groups++;
+    }
+
+    free(copy);
+    groups_enabled = 1;
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// Throttle heap
+// ---------------------------------------------------------------------------
+
+static void throttle_push(CpuGroup *g)
+{
+    int i = num_throttled++;
+    while (i > 0)
+    {
+        int parent = (i - 1) / 2;
+        if (throttled[parent]->period_end <= g->period_end)
+            break;
+        throttled[i] = throttled[parent];
+        i = parent;
+    }
+    throttled[i] = g;
+}
+
+static CpuGroup *throttle_pop(void)
+{
+    CpuGroup *top = throttled[0];
+    CpuGroup *last = throttled[--num_throttled];
+
+    int i = 0;
+    while (1)
+    {
+        int child = 2 * i + 1;
+        if (child >= num_throttled)
+            break;
+        if (child + 1 < num_throttled && throttled[child + 1]->period_end < throttled[child]->period_end)
+            child++;
+        if (throttled[child]->period_end >= last->period_end)
+            break;
+        throttled[i] = throttled[child];
+        i = child;
+    }
+    if (num_throttled > 0)
+        throttled[i] = last;
+    return top;
+}
+
+// ---------------------------------------------------------------------------
+// Accounting
+// ---------------------------------------------------------------------------
+
+int group_account(Process *p, sim_time_t current_time)
+{
+    int hit = 0;
+
+    for (CpuGroup *g = p->group != NULL ? p->group : &groups[0]; g != NULL; g = g->parent)
+    {
+        g->total_usage++;
+        if (g->quota < 0)
+            continue;
+
+        // First charge since the period rolled over: start a fresh one
+        if (current_time >= g->period_end)
+        {
+            g->usage = 0;
+            g->period_end = current_time - current_time % g->period + g->period;
+            g->nr_periods++;
+        }
+
+        g->usage++;
+
+        // Out of quota with time left in the period: throttled from the next tick
+        if (g->usage >= g->quota && g->period_end > current_time + 1 && !g->throttled)
+        {
+            g->throttled = 1;
+            g->throttled_at = current_time + 1;
+            g->nr_throttled++;
+            throttle_push(g);
+            hit = 1;
+        }
+    }
+
+    return hit;
+}
+
+int group_blocked(const CpuGroup *g)
+{
+    for (; g != NULL; g = g->parent)
+    {
+        if (g->throttled)
+            return 1;
+    }
+    return 0;
+}
+
+void group_park(Process *p, sim_time_t current_time)
+{
+    // Park on the nearest throttled group; if an ancestor is still throttled
+    // when that one is released, the process simply gets parked again
+    CpuGroup *g = p->group;
+    while (!g->throttled)
+        g = g->parent;
+
+    p->next_ready = NULL;
+    if (g->parked_tail != NULL)
+        g->parked_tail->next_ready = p;
+    else
+        g->parked_head = p;
+    g->parked_tail = p;
+
+    if (trace_text)
+        trace_line_str(TEXT_THROTTLED, p, current_time, g->period_end, g->path);
+}
+
+Process *group_release(sim_time_t current_time)
+{
+    while (releasing == NULL && num_throttled > 0 && throttled[0]->period_end <= current_time)
+    {
+        CpuGroup *g = throttle_pop();
+        g->throttled = 0;
+        g->throttled_ticks += current_time - g->throttled_at;
+
+        releasing = g->parked_head;
+        g->parked_head = g->parked_tail = NULL;
+    }
+
+    if (releasing == NULL)
+        return NULL;
+
+    Process *p = releasing;
+    releasing = p->next_ready;
+    p->next_ready = NULL;
+
+    if (trace_text)
+        trace_line(TEXT_UNTHROTTLED, p, current_time, 0, 0);
+    return p;
+}
+
+void group_reset(void)
+{
+    for (int i = 0; i < num_groups; i++)
+    {
+        CpuGroup *g = &groups[i];
+        g->period_end = g->usage = 0;
+        g->throttled = 0;
+        g->throttled_at = 0;
+        g->parked_head = g->parked_tail = NULL;
+        g->total_usage = g->nr_periods = g->nr_throttled = g->throttled_ticks = 0;
+    }
+    num_throttled = 0;
+    releasing = NULL;
+}
+
+// ---------------------------------------------------------------------------
+// Report
+// ---------------------------------------------------------------------------
+
+void group_report(void)
+{
+    if (!groups_enabled)
+        return;
+
+    printf("\n=== CPU Groups ===\n");
+    printf("  %-20s %6s %12s %7s %8s %9s %8s %10s %10s\n",
+           "group", "shares", "quota/period", "usage", "%parent", "entitled",
+           "periods", "throttled", "thr.ticks");
+
+    for (int i = 0; i < num_groups; i++)
+    {
+        CpuGroup *g = &groups[i];
+
+        char limit[24] = "max";
+        if (g->quota >= 0)
+            snprintf(limit, sizeof(limit), "%d/%d", g->quota, g->period);
+
+        printf("  %-20s %6d %12s %7ld ", g->path, g->shares, limit, g->total_usage);
+
+        if (g->parent == NULL)
+        {
+            printf("%8s %9s ", "-", "-");
+        }
+        else
+        {
+            // Actual slice of the parent's CPU time vs. the slice shares entitle it to
+            double actual = g->parent->total_usage ? 100.0 * g->total_usage / g->parent->total_usage : 0.0;
+            double entitled = 100.0 * g->shares / g->parent->child_shares;
+            printf("%7.1f%% %8.1f%% ", actual, entitled);
+        }
+
+        printf("%8ld %10ld %10ld\n", g->nr_periods, g->nr_throttled, g->throttled_ticks);
+    }
+}
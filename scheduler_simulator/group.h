@@ -0,0 +1,88 @@
+#ifndef GROUP_H
+#define GROUP_H
+
+#include "process.h"
+
+#define MAX_GROUPS 64
+#define GROUP_PATH_LEN 64
+
+//* Hierarchical CPU bandwidth control (cgroup-style)
+//
+// Groups form a tree under an implicit root "/". Each group may carry a
+// hard limit of quota ticks per period and a relative weight (shares).
+// Every executed tick is charged to the running process's group and all of
+// its ancestors; a group that uses up its quota is throttled until its
+// period ends, and none of the processes below it may run meanwhile.
+//
+// The base policy (FIFO, SJF, ...) still decides who runs. When it picks a
+// process under a throttled group, the process is parked on that group
+// instead of dispatched, and handed back to the ready queue by
+// group_release() once the group's period rolls over. Periods are refreshed
+// lazily when a group is charged, so per-tick accounting is O(depth).
+//
+// Shares do not reorder the base policy; they define each group's
+// entitlement among its siblings, which group_report() compares to the
+// CPU time the group actually got.
+
+typedef struct CpuGroup
+{
+    char path[GROUP_PATH_LEN];
+    struct CpuGroup *parent;
+    int shares;
+    int quota;              // ticks per period, -1 = unlimited
+    int period;
+
+    //* Current period, refreshed lazily
+    sim_time_t period_end;
+    int usage;              // ticks used in the current period
+    int throttled;          // out of quota until period_end
+    sim_time_t throttled_at;
+    Process *parked_head;   // processes waiting for the group to unthrottle
+    Process *parked_tail;
+
+    // stats
+    long total_usage;
+    long nr_periods;        // periods in which the group ran
+    long nr_throttled;
+    long throttled_ticks;
+    long child_shares;      // sum of the direct children's shares
+} CpuGroup;
+
+extern int groups_enabled;
+
+// Parse "web:50/100,web/api:20/100:512,batch:max:256" (path[:quota/period|max][:shares]).
+// Parents must be declared before their children. Returns 0 on success.
+int group_configure(const char *spec);
+CpuGroup *group_find(const char *path);
+
+int group_account(Process *p, sim_time_t current_time);
+int group_blocked(const CpuGroup *g);
+
+// Charge the tick p just executed to its group hierarchy. Returns 1 if that
+// throttled p's group or an ancestor, i.e. p must leave the CPU.
+static inline int group_charge(Process *p, sim_time_t current_time)
+{
+    return groups_enabled ? group_account(p, current_time) : 0;
+}
+
+// True if p may not run because its group or an ancestor is throttled
+static inline int group_throttled(const Process *p)
+{
+    return p->group != NULL && group_blocked(p->group);
+}
+
+// Take a READY process that group_throttled() off the scheduler's hands
+// until its group has quota again
+void group_park(Process *p, sim_time_t current_time);
+
+// Called at the start of each tick: returns the next parked process whose
+// group has just been unthrottled (it goes back into the ready queue),
+// or NULL when there are none left
+Process *group_release(sim_time_t current_time);
+
+// Clear usage, throttling and stats, keeping the hierarchy (between runs)
+void group_reset(void);
+
+void group_report(void);
+
+#endif
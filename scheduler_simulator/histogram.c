@@ -0,0 +1,75 @@
+#include <string.h>
+
+#include "histogram.h"
+
+void hist_clear(Histogram *h)
+{
+    memset(h, 0, sizeof(*h));
+}
+
+void hist_merge(Histogram *into, const Histogram *from)
+{
+    if (from->count == 0)
+        return;
+
+    if (into->count == 0 || from->min < into->min)
+        into->min = from->min;
+    if (from->max > into->max)
+        into->max = from->max;
+    into->count += from->count;
+    into->sum += from->sum;
+    for (int i = 0; i < HIST_BUCKETS; i++)
+        into->buckets[i] += from->buckets[i];
+}
+
+double hist_mean(const Histogram *h)
+{
+    return h->count > 0 ? (double)h->sum / h->count : 0.0;
+}
+
+// Smallest value and width of bucket i
+static void bucket_range(int i, long *low, long *width)
+{
+    if (i < 2 * HIST_HALF)
+    {
+        *low = i;
+        *width = 1;
+        return;
+    }
+
+    int shift = i / HIST_HALF - 1;
+    *low = (long)(i % HIST_HALF + HIST_HALF) << shift;
+    *width = 1L << shift;
+}
+
+long hist_quantile(const Histogram *h, double q)
+{
+    if (h->count == 0)
+        return 0;
+
+    // ceil(q * count), at least 1
+    long rank = (long)(q * h->count);
+    if (rank < q * h->count)
+        rank++;
+    if (rank < 1)
+        rank = 1;
+
+    long seen = 0;
+    for (int i = 0; i < HIST_BUCKETS; i++)
+    {
+        seen += h->buckets[i];
+        if (seen < rank)
+            continue;
+
+        long low, width;
+        bucket_range(i, &low, &width);
+        long value = low + (width - 1) / 2;
+        if (value < h->min)
+            value = h->min;
+        if (value > h->max)
+            value = h->max;
+        return value;
+    }
+
+    return h->max;
+}
@@ -0,0 +1,64 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+//* Log-bucketed histogram (HDR-histogram layout)
+//
+// Values below 2^HIST_SUB_BITS get a bucket each; above that, every power
+// of two [2^k, 2^(k+1)) is split into 2^(HIST_SUB_BITS-1) equal
+// sub-buckets, so any value is known to within 1 / 2^(HIST_SUB_BITS-1)
+// (1.6%). The bucket array has a fixed size, independent of the number
+// of values, recording is O(1) and two histograms merge by adding counts.
+// count, sum, min and max are exact.
+
+#define HIST_SUB_BITS 7
+#define HIST_HALF (1 << (HIST_SUB_BITS - 1))
+#define HIST_MAX_BITS 40            // values up to 2^40 - 1; larger ones are clamped
+#define HIST_BUCKETS ((HIST_MAX_BITS - HIST_SUB_BITS + 2) * HIST_HALF)
+
+typedef struct Histogram
+{
+    long count;
+    long sum;
+    long min;
+    long max;
+    long buckets[HIST_BUCKETS];
+} Histogram;
+
+// A zeroed Histogram is empty and ready to use
+void hist_clear(Histogram *h);
+
+static inline int hist_index(long value)
+{
+    if (value < 2 * HIST_HALF)
+        return (int)value;
+
+    // value >> shift lands in [HIST_HALF, 2 * HIST_HALF)
+    int shift = (63 - __builtin_clzl((unsigned long)value)) - (HIST_SUB_BITS - 1);
+    return shift * HIST_HALF + (int)(value >> shift);
+}
+
+static inline void hist_add(Histogram *h, long value)
+{
+    if (value < 0)
+        value = 0;
+    else if (value >= 1L << HIST_MAX_BITS)
+        value = (1L << HIST_MAX_BITS) - 1;
+
+    if (h->count == 0 || value < h->min)
+        h->min = value;
+    if (value > h->max)
+        h->max = value;
+    h->count++;
+    h->sum += value;
+    h->buckets[hist_index(value)]++;
+}
+
+void hist_merge(Histogram *into, const Histogram *from);
+
+double hist_mean(const Histogram *h);
+
+// Value at quantile q in [0, 1]: the midpoint of the bucket holding the
+// ceil(q * count)-th smallest value, clamped to [min, max]
+long hist_quantile(const Histogram *h, double q);
+
+#endif
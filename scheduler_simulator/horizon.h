@@ -0,0 +1,71 @@
+#ifndef HORIZON_H
+#define HORIZON_H
+
+#include "process.h"
+#include "arrivals.h"
+#include "io_device.h"
+#include "power.h"
+#include "group.h"
+#include "trace.h"
+
+//* Event skipping for the single-CPU tick loops
+//
+// Between two events (an arrival, an I/O completion or device unit
+// freeing up, the end of the running burst, a quantum or aging epoch
+// boundary) a tick only takes one tick off the running process, or does
+// nothing if the CPU is idle. When nothing needs every tick -- no text
+// trace, no DVFS governor sampling, no CPU group quotas -- the engines
+// run or idle up to the next event in one step, so a run costs the same
+// whatever --tick resolution its times are in.
+//
+// Context-switch stalls need no check: the engines only skip after a tick
+// in which the process made progress, i.e. after its stall.
+
+static inline int horizon_enabled(void)
+{
+    return !trace_text && !power_enabled && !groups_enabled;
+}
+
+// First tick after now at which the loop has something to do besides
+// running its process: the next arrival or I/O event, or limit if that is
+// earlier. SIM_TIME_MAX if nothing is pending.
+static inline sim_time_t horizon_next(const ArrivalCursor *arrivals, const Process processes[],
+                                      sim_time_t limit)
+{
+    sim_time_t next = arrivals_peek(arrivals, processes);
+    sim_time_t io = io_next_event();
+    if (io < next)
+        next = io;
+    return limit < next ? limit : next;
+}
+
+// Ticks the running process may run from now on, at least 1 and at most
+// its remaining time
+static inline sim_time_t horizon_run(const ArrivalCursor *arrivals, const Process processes[],
+                                     sim_time_t now, sim_time_t remaining, sim_time_t limit)
+{
+    if (!horizon_enabled())
+        return 1;
+    sim_time_t next = horizon_next(arrivals, processes, limit);
+    sim_time_t run = next == SIM_TIME_MAX || next - now >= remaining ? remaining : next - now;
+    if (run < 1)
+        run = 1;
+    io_skip_to(now + run - 1);
+    return run;
+}
+
+// Last tick of an idle stretch that starts at now: the tick before the
+// next event, or now itself if skipping is off or nothing is pending
+static inline sim_time_t horizon_idle(const ArrivalCursor *arrivals, const Process processes[],
+                                      sim_time_t now)
+{
+    if (!horizon_enabled())
+        return now;
+    sim_time_t next = horizon_next(arrivals, processes, SIM_TIME_MAX);
+    if (next == SIM_TIME_MAX || next - 1 <= now)
+        return now;
+    io_skip_to(next - 1);
+    return next - 1;
+}
+
+#endif
@@ -0,0 +1,485 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "io_device.h"
+
+typedef struct Completion
+{
+    sim_time_t end_time;
+    int device;
+} Completion;
+
+static IoDevice devices[MAX_DEVICES] = {
+    {.name = "io", .count = 0, .policy = IO_FIFO, .direction = 1}
+};
+static int num_devices = 1;
+
+//* Min-heap of in-service requests keyed by end time, so a tick only
+//* touches the devices that actually finish something
+static Completion *completions = NULL;
+static int num_completions = 0;
+static int completions_capacity = 0;
+
+//* Min-heap of blocked processes keyed by io_end_time, then by address
+//* (workload order), so engines pick up finished I/O without scanning
+//* the process table
+static Process **done = NULL;
+static int num_done = 0;
+static int done_capacity = 0;
+
+static long next_seq = 0;
+static sim_time_t last_tick = -1;
+
+static void *grow(void *items, int *capacity, size_t item_size)
+{
+    *capacity = *capacity ? *capacity * 2 : 16;
+    void *grown = realloc(items, *capacity * item_size);
+    if (grown == NULL)
+    {
+        fprintf(stderr, "io: out of memory\n");
+        exit(1);
+    }
+    return grown;
+}
+
+// ---------------------------------------------------------------------------
+// Request heap (elevator sweeps)
+// ---------------------------------------------------------------------------
+
+static int heap_before(IoHeap *h, IoRequest *a, IoRequest *b)
+{
+    if (a->position != b->position)
+        return h->descending ? a->position > b->position : a->position < b->position;
+    return a->seq < b->seq;
+}
+
+static void heap_push(IoHeap *h, IoRequest r)
+{
+    if (h->size == h->capacity)
+        h->items = grow(h->items, &h->capacity, sizeof(IoRequest));
+
+    int i = h->size++;
+    while (i > 0)
+    {
+        int parent = (i - 1) / 2;
+        if (!heap_before(h, &r, &h->items[parent]))
+            break;
+        h->items[i] = h->items[parent];
+        i = parent;
+    }
+    h->items[i] = r;
+}
+
+static IoRequest heap_pop(IoHeap *h)
+{
+    IoRequest top = h->items[0];
+    IoRequest last = h->items[--h->size];
+
+    int i = 0;
+    while (1)
+    {
+        int child = 2 * i + 1;
+        if (child >= h->size)
+            break;
+        if (child + 1 < h->size && heap_before(h, &h->items[child + 1], &h->items[child]))
+            child++;
+        if (!heap_before(h, &h->items[child], &last))
+            break;
+        h->items[i] = h->items[child];
+        i = child;
+    }
+    if (h->size > 0)
+        h->items[i] = last;
+    return top;
+}
+
+// ---------------------------------------------------------------------------
+// Completion heap
+// ---------------------------------------------------------------------------
+
+static void completion_push(sim_time_t end_time, int device)
+{
+    if (num_completions == completions_capacity)
+        completions = grow(completions, &completions_capacity, sizeof(Completion));
+
+    int i = num_completions++;
+    while (i > 0)
+    {
+        int parent = (i - 1) / 2;
+        if (completions[parent].end_time <= end_time)
+            break;
+        completions[i] = completions[parent];
+        i = parent;
+    }
+    completions[i] = (Completion){end_time, device};
+}
+
+static Completion completion_pop(void)
+{
+    Completion top = completions[0];
+    Completion last = completions[--num_completions];
+
+    int i = 0;
+    while (1)
+    {
+        int child = 2 * i + 1;
+        if (child >= num_completions)
+            break;
+        if (child + 1 < num_completions && completions[child + 1].end_time < completions[child].end_time)
+            child++;
+        if (completions[child].end_time >= last.end_time)
+            break;
+        completions[i] = completions[child];
+        i = child;
+    }
+    if (num_completions > 0)
+        completions[i] = last;
+    return top;
+}
+
+// ---------------------------------------------------------------------------
+// Done heap
+// ---------------------------------------------------------------------------
+
+static int done_before(const Process *a, const Process *b)
+{
+    if (a->io_end_time != b->io_end_time)
+        return a->io_end_time < b->io_end_time;
+    return a < b;
+}
+
+static void done_push(Process *p)
+{
+    if (num_done == done_capacity)
+        done = grow(done, &done_capacity, sizeof(Process *));
+
+    int i = num_done++;
+    while (i > 0)
+    {
+        int parent = (i - 1) / 2;
+        if (!done_before(p, done[parent]))
+            break;
+        done[i] = done[parent];
+        i = parent;
+    }
+    done[i] = p;
+}
+
+static Process *done_pop(void)
+{
+    Process *top = done[0];
+    Process *last = done[--num_done];
+
+    int i = 0;
+    while (1)
+    {
+        int child = 2 * i + 1;
+        if (child >= num_done)
+            break;
+        if (child + 1 < num_done && done_before(done[child + 1], done[child]))
+            child++;
+        if (!done_before(done[child], last))
+            break;
+        done[i] = done[child];
+        i = child;
+    }
+    if (num_done > 0)
+        done[i] = last;
+    return top;
+}
+
+// ---------------------------------------------------------------------------
+// Device queues
+// ---------------------------------------------------------------------------
+
+static int queue_length(IoDevice *d)
+{
+    return d->policy == IO_FIFO ? d->size : d->up.size + d->down.size;
+}
+
+static void queue_push(IoDevice *d, IoRequest r)
+{
+    if (d->policy == IO_FIFO)
+    {
+        if (d->size == d->capacity)
+        {
+            //* unroll the ring into the front of the grown buffer
+            int old_capacity = d->capacity;
+            IoRequest *grown = grow(NULL, &d->capacity, sizeof(IoRequest));
+            for (int i = 0; i < d->size; i++)
+                grown[i] = d->fifo[(d->front + i) % old_capacity];
+            free(d->fifo);
+            d->fifo = grown;
+            d->front = 0;
+        }
+        d->fifo[(d->front + d->size) % d->capacity] = r;
+        d->size++;
+    }
+    else
+    {
+        // Ahead of the arm in the sweep direction -> served on this sweep
+        int ahead = d->direction > 0 ? r.position >= d->arm : r.position <= d->arm;
+        if ((d->direction > 0) == ahead)
+            heap_push(&d->up, r);
+        else
+            heap_push(&d->down, r);
+    }
+
+    int length = queue_length(d);
+    if (length > d->max_queue)
+        d->max_queue = length;
+}
+
+static IoRequest queue_pop(IoDevice *d)
+{
+    if (d->policy == IO_FIFO)
+    {
+        IoRequest r = d->fifo[d->front];
+        d->front = (d->front + 1) % d->capacity;
+        d->size--;
+        return r;
+    }
+
+    // LOOK: keep sweeping while there is work ahead, otherwise reverse
+    IoHeap *ahead = d->direction > 0 ? &d->up : &d->down;
+    if (ahead->size == 0)
+    {
+        d->direction = -d->direction;
+        ahead = d->direction > 0 ? &d->up : &d->down;
+    }
+    IoRequest r = heap_pop(ahead);
+    d->arm = r.position;
+    return r;
+}
+
+static void start_request(IoDevice *d, int device, IoRequest r, sim_time_t start_time)
+{
+    d->busy++;
+    d->wait_ticks += start_time - (r.submit_time + 1);
+    d->busy_ticks += r.duration;
+    r.p->io_end_time = start_time + r.duration;
+    completion_push(r.p->io_end_time, device);
+    done_push(r.p);
+}
+
+// ---------------------------------------------------------------------------
+// Public API
+// ---------------------------------------------------------------------------
+
+int io_find_device(const char *name)
+{
+    for (int i = 0; i < num_devices; i++)
+    {
+        if (strcmp(devices[i].name, name) == 0)
+            return i;
+    }
+    return -1;
+}
+
+int io_num_devices(void)
+{
+    return num_devices;
+}
+
+const char *io_device_name(int device)
+{
+    return devices[device].name;
+}
+
+int io_configure(const char *spec)
+{
+    char *copy = strdup(spec);
+    char *save = NULL;
+
+    for (char *entry = strtok_r(copy, ",", &save); entry != NULL; entry = strtok_r(NULL, ",", &save))
+    {
+        char *name = entry;
+        char *count = strchr(name, ':');
+        char *policy = NULL;
+
+        if (count != NULL)
+        {
+            *count++ = '\0';
+            policy = strchr(count, ':');
+            if (policy != NULL)
+                *policy++ = '\0';
+        }
+
+        if (*name == '\0' || strlen(name) >= DEVICE_NAME_LEN)
+        {
+            fprintf(stderr, "Invalid device name in --devices: '%s'\n", name);
+            free(copy);
+            return -1;
+        }
+
+        int index = io_find_device(name);
+        if (index < 0)
+        {
+            if (num_devices == MAX_DEVICES)
+            {
+                fprintf(stderr, "Too many devices (max %d)\n", MAX_DEVICES);
+                free(copy);
+                return -1;
+            }
+            index = num_devices++;
+        }
+
+        IoDevice *d = &devices[index];
+        memset(d, 0, sizeof(*d));
+        strcpy(d->name, name);
+        d->count = count != NULL ? atoi(count) : 1;
+        d->direction = 1;
+        d->down.descending = 1;
+
+        if (d->count < 0)
+        {
+            fprintf(stderr, "Invalid unit count for device '%s'\n", name);
+            free(copy);
+            return -1;
+        }
+
+        if (policy == NULL || strcmp(policy, "fifo") == 0)
+            d->policy = IO_FIFO;
+        else if (strcmp(policy, "elevator") == 0)
+            d->policy = IO_ELEVATOR;
+        else
+        {
+            fprintf(stderr, "Unknown queue policy '%s' for device '%s'\n", policy, name);
+            free(copy);
+            return -1;
+        }
+    }
+
+    free(copy);
+    return 0;
+}
+
+void io_submit(Process *p, sim_time_t current_time)
+{
+    int burst = p->current_burst;
+    int device = p->io_devices != NULL ? p->io_devices[burst] : DEFAULT_DEVICE;
+    IoDevice *d = &devices[device];
+
+    IoRequest r = {
+        .p = p,
+        .duration = p->io_times[burst],
+        .position = p->io_positions != NULL ? p->io_positions[burst] : 0,
+        .submit_time = current_time,
+        .seq = next_seq++
+    };
+
+    d->requests++;
+
+    if (d->count == 0)
+    {
+        // Unlimited units: the request never waits
+        d->busy_ticks += r.duration;
+        p->io_end_time = io_default_end(current_time, r.duration);
+        done_push(p);
+        return;
+    }
+
+    if (d->busy < d->count && queue_length(d) == 0)
+    {
+        start_request(d, device, r, current_time + 1);
+        return;
+    }
+
+    p->io_end_time = -1; // queued, set once a unit picks it up
+    queue_push(d, r);
+}
+
+void io_tick(sim_time_t current_time)
+{
+    last_tick = current_time;
+
+    while (num_completions > 0 && completions[0].end_time <= current_time)
+    {
+        Completion c = completion_pop();
+        IoDevice *d = &devices[c.device];
+        d->busy--;
+
+        if (queue_length(d) > 0)
+            start_request(d, c.device, queue_pop(d), current_time);
+    }
+}
+
+Process *io_next_done(sim_time_t current_time)
+{
+    if (num_done == 0 || done[0]->io_end_time > current_time)
+        return NULL;
+    return done_pop();
+}
+
+void io_skip_to(sim_time_t current_time)
+{
+    last_tick = current_time;
+}
+
+sim_time_t io_next_event(void)
+{
+    sim_time_t next = SIM_TIME_MAX;
+    if (num_completions > 0)
+        next = completions[0].end_time;
+    if (num_done > 0 && done[0]->io_end_time < next)
+        next = done[0]->io_end_time;
+    return next;
+}
+
+int io_is_queued(Process *p)
+{
+    return p->state == BLOCKED && p->io_end_time < 0;
+}
+
+void io_reset(void)
+{
+    for (int i = 0; i < num_devices; i++)
+    {
+        IoDevice *d = &devices[i];
+        d->busy = 0;
+        d->front = d->size = 0;
+        d->up.size = d->down.size = 0;
+        d->arm = 0;
+        d->direction = 1;
+        d->requests = d->wait_ticks = d->busy_ticks = 0;
+        d->max_queue = 0;
+    }
+    num_completions = 0;
+    num_done = 0;
+    next_seq = 0;
+    last_tick = -1;
+}
+
+void io_report(void)
+{
+    sim_time_t end_time = last_tick + 1;
+
+    if (num_devices == 1)
+        return; // only the unlimited default device, nothing to contend on
+
+    printf("\n=== I/O Devices ===\n");
+    printf("  %-10s %6s %10s %9s %10s %10s %9s\n",
+           "device", "units", "policy", "requests", "avg wait", "max queue", "util");
+    for (int i = 0; i < num_devices; i++)
+    {
+        IoDevice *d = &devices[i];
+        double avg_wait = d->requests ? (double)d->wait_ticks / d->requests : 0.0;
+        char units[12] = "inf";
+        double util = 0.0;
+        if (d->count > 0)
+            snprintf(units, sizeof(units), "%d", d->count);
+        if (d->count > 0 && end_time > 0)
+            util = 100.0 * d->busy_ticks / ((double)d->count * end_time);
+
+        printf("  %-10s %6s %10s %9ld %10.2f %10d ",
+               d->name,
+               units,
+               d->policy == IO_FIFO ? "fifo" : "elevator",
+               d->requests, avg_wait, d->max_queue);
+        if (d->count)
+            printf("%8.1f%%\n", util);
+        else
+            printf("%9s\n", "-");
+    }
+}
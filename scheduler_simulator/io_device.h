@@ -0,0 +1,105 @@
+#ifndef IO_DEVICE_H
+#define IO_DEVICE_H
+
+#include "process.h"
+
+#define MAX_DEVICES 16
+#define DEVICE_NAME_LEN 16
+
+//* Device 0 is the implicit "io" device: unlimited units, so untagged
+//* bursts keep the old io_end_time = current_time + io_duration + 1 rule.
+#define DEFAULT_DEVICE 0
+
+// The default device rule: an I/O burst submitted at the end of tick
+// current_time completes (the process is ready) at the start of the
+// returned tick. Every engine with its own I/O path uses this one.
+static inline sim_time_t io_default_end(sim_time_t current_time, sim_time_t duration)
+{
+    return current_time + duration + 1;
+}
+
+typedef enum {
+    IO_FIFO, IO_ELEVATOR
+} io_policy_t;
+
+typedef struct IoRequest
+{
+    Process *p;
+    sim_time_t duration;
+    int position;      // seek position (elevator key)
+    sim_time_t submit_time;
+    long seq;          // arrival order, breaks ties between equal positions
+} IoRequest;
+
+// Binary heap of requests, ordered by position (or reversed for the down sweep)
+typedef struct IoHeap
+{
+    IoRequest *items;
+    int size;
+    int capacity;
+    int descending;
+} IoHeap;
+
+typedef struct IoDevice
+{
+    char name[DEVICE_NAME_LEN];
+    int count;              // number of units, 0 = unlimited
+    int busy;               // units currently serving a request
+    io_policy_t policy;
+
+    //* FIFO: circular buffer of waiting requests
+    IoRequest *fifo;
+    int front;
+    int size;
+    int capacity;
+
+    //* Elevator (LOOK): requests ahead of the arm in the current direction
+    //* live in one heap, the ones behind it in the other
+    IoHeap up;
+    IoHeap down;
+    int arm;                // position of the last request started
+    int direction;          // +1 sweeping up, -1 sweeping down
+
+    // stats
+    long requests;
+    long wait_ticks;        // ticks spent queued before service
+    long busy_ticks;        // unit-ticks spent serving requests
+    int max_queue;
+} IoDevice;
+
+// Parse "disk:2:elevator,net:1" into the device table. Returns 0 on success.
+int io_configure(const char *spec);
+int io_find_device(const char *name);
+int io_num_devices(void);
+const char *io_device_name(int device);
+
+// Called at the end of the tick in which p's CPU burst finished
+void io_submit(Process *p, sim_time_t current_time);
+
+// Called at the start of each tick, before I/O completions are checked:
+// frees units whose request ends now and starts the next queued request
+void io_tick(sim_time_t current_time);
+
+// After io_tick(): the next process whose I/O burst ends at current_time,
+// in workload order, or NULL once there are none left this tick. Covers
+// every device, the default one included.
+Process *io_next_done(sim_time_t current_time);
+
+// The next tick at which io_tick() or io_next_done() has anything to do,
+// SIM_TIME_MAX if no request is in service
+sim_time_t io_next_event(void);
+
+// Ticks up to current_time passed without an I/O event (an engine skipped
+// them): only moves the device clock that utilization is measured against
+void io_skip_to(sim_time_t current_time);
+
+// True if p is waiting in a device queue (not yet being served)
+int io_is_queued(Process *p);
+
+// Back to idle devices and zeroed stats, keeping the configuration
+// (between runs that share a workload)
+void io_reset(void);
+
+void io_report(void);
+
+#endif
@@ -2,89 +2,439 @@
 #include <string.h>
 #include <stdlib.h>
 
-#include "fifo.h"
-#include "sjf.h"
-#include "stcf.h"
-#include "rr.h" // future addition
+#include "experiment.h"
+#include "montecarlo.h"
+#include "gang.h"
+#include "io_device.h"
+#include "group.h"
+#include "workload.h"
+#include "cost.h"
+#include "predict.h"
+#include "metrics.h"
+#include "power.h"
+#include "rr.h"
+#include "trace.h"
+#include "profile.h"
+#include "arrivals.h"
+#include "progress.h"
+#include "packed.h"
+#include "compare.h"
 
 #define NUM_PROCESSES 3
 
 int main(int argc, char *argv[])
 {
 
-    //* default algorithm
-    char *algorithm = "FIFO";
-    //* default quantum = 1
-    int quantum = 1;
+    //* per-run options: algorithm, quantum, workload, cost model, CPUs, ...
+    RunConfig run;
+    run_config_defaults(&run);
+    //* devices: "name[:count][:policy],..."
+    const char *device_spec = NULL;
+    //* binary event trace to record, or two traces to compare
+    const char *trace_path = NULL;
+    const char *diff_paths[2] = {NULL, NULL};
+    //* run-length timeline export
+    const char *timeline_csv = NULL;
+    const char *timeline_bin = NULL;
+    //* asynchronous output: writer thread fed through a ring of event records
+    const char *event_log = NULL;
+    const char *pipe_mode = NULL;
+    int pipe_size = 1 << 16;
+    //* CPU bandwidth groups: "path[:quota/period][:shares],..."
+    const char *group_spec = NULL;
+    //* batch experiments: one run per manifest line, results in one CSV
+    const char *manifest_path = NULL;
+    const char *results_path = NULL;
+    //* latency percentiles (wait, response, turnaround, slowdown)
+    int latency = 0;
+    //* load workloads from an arrival-sorted copy, sorted in runs of this size
+    size_t sort_memory = SORT_DEFAULT_MEMORY;
+    //* write the loaded workload in the packed binary format and exit
+    const char *pack_path = NULL;
+    //* ... or as text, one line per process
+    const char *unpack_path = NULL;
+    //* Monte Carlo: replications with random bursts, confidence intervals
+    McConfig mc;
+    mc_config_defaults(&mc);
+    //* policy comparison: the same workload (or paired replicas) under each
+    CompareConfig compare;
+    compare_config_defaults(&compare);
+    //* live progress on stderr and in a status file
+    ProgressConfig progress_config;
+    progress_config_defaults(&progress_config);
+
+    //* --tick first, wherever it is: durations in other options convert at it
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (strcmp(argv[i], "--tick") == 0 && sim_set_tick(argv[i + 1]) != 0)
+            return 1;
+    }
 
     // Parse arguments
     for (int i = 1; i < argc; i++)
     {
-        if (strcmp(argv[i], "--algorithm") == 0)
+        int parsed = parse_run_option(&run, argc, argv, &i);
+        if (parsed < 0)
+            return 1;
+        if (parsed > 0)
+            continue;
+        if ((parsed = mc_parse_option(&mc, argc, argv, &i)) != 0)
         {
-            algorithm = argv[++i];
+            if (parsed < 0)
+                return 1;
+            continue;
         }
-    }
-    for (int i = 1; i < argc; i++)
-    {
-        if (strcmp(argv[i], "--quantum") == 0)
+        if ((parsed = progress_parse_option(&progress_config, argc, argv, &i)) != 0)
+        {
+            if (parsed < 0)
+                return 1;
+            continue;
+        }
+        if ((parsed = compare_parse_option(&compare, argc, argv, &i)) != 0)
+        {
+            if (parsed < 0)
+                return 1;
+            continue;
+        }
+
+        const char **value = NULL;
+        if (strcmp(argv[i], "--quiet") == 0)
+        {
+            trace_text = 0;
+            continue;
+        }
+        else if (strcmp(argv[i], "--latency") == 0)
+        {
+            latency = 1;
+            continue;
+        }
+        else if (strcmp(argv[i], "--diff") == 0)
+        {
+            if (i + 2 >= argc)
+            {
+                printf("--diff needs two trace files.\n");
+                return 1;
+            }
+            diff_paths[0] = argv[++i];
+            diff_paths[1] = argv[++i];
+            continue;
+        }
+        else if (strcmp(argv[i], "--devices") == 0)
+            value = &device_spec;
+        else if (strcmp(argv[i], "--groups") == 0)
+            value = &group_spec;
+        else if (strcmp(argv[i], "--trace") == 0)
+            value = &trace_path;
+        else if (strcmp(argv[i], "--timeline") == 0)
+            value = &timeline_csv;
+        else if (strcmp(argv[i], "--timeline-bin") == 0)
+            value = &timeline_bin;
+        else if (strcmp(argv[i], "--event-log") == 0)
+            value = &event_log;
+        else if (strcmp(argv[i], "--async-trace") == 0)
+            value = &pipe_mode;
+        else if (strcmp(argv[i], "--manifest") == 0)
+            value = &manifest_path;
+        else if (strcmp(argv[i], "--results") == 0)
+            value = &results_path;
+        else if (strcmp(argv[i], "--pack-workload") == 0)
+            value = &pack_path;
+        else if (strcmp(argv[i], "--unpack-workload") == 0)
+            value = &unpack_path;
+        else if (strcmp(argv[i], "--tick") == 0)
+        {
+            // Already set above; only its value is skipped here
+            if (option_value(argc, argv, &i) == NULL)
+                return 1;
+            continue;
+        }
+        else if (strcmp(argv[i], "--sort-workload") == 0)
+        {
+            arrivals_configure_sort(1, sort_memory);
+            continue;
+        }
+        else if (strcmp(argv[i], "--sort-memory") == 0)
+        {
+            const char *memory = option_value(argc, argv, &i);
+            if (memory == NULL)
+                return 1;
+            if (arrivals_parse_memory(memory, &sort_memory) != 0)
+            {
+                printf("--sort-memory takes a size, e.g. 64M or 2G.\n");
+                return 1;
+            }
+            arrivals_configure_sort(arrivals_sort_enabled(), sort_memory);
+            continue;
+        }
+        else if (strcmp(argv[i], "--pipe-size") == 0)
         {
-            quantum = atoi(argv[++i]);
+            const char *size = option_value(argc, argv, &i);
+            if (size == NULL)
+                return 1;
+            pipe_size = atoi(size);
+            if (pipe_size < 2)
+            {
+                printf("--pipe-size takes a ring size of at least 2 records.\n");
+                return 1;
+            }
+            continue;
         }
+        else
+        {
+            printf("Unknown option %s\n", argv[i]);
+            return 1;
+        }
+
+        if ((*value = option_value(argc, argv, &i)) == NULL)
+            return 1;
+    }
+
+    if (pipe_mode != NULL && strcmp(pipe_mode, "block") != 0 && strcmp(pipe_mode, "drop") != 0)
+    {
+        printf("--async-trace takes block or drop.\n");
+        return 1;
+    }
+
+    //* --diff is a standalone tool: compare two recorded traces and exit
+    if (diff_paths[0] != NULL)
+    {
+        int result = trace_diff(diff_paths[0], diff_paths[1]);
+        return result < 0 ? 2 : result;
     }
 
     Process processes[NUM_PROCESSES] = {
         {
             .pid = "P1",
             .arrival_time = 0,
-            .cpu_bursts = (int[]){3, 2, 1},
-            .io_times = (int[]){2, 2},
+            .cpu_bursts = (sim_time_t[]){3, 2, 1},
+            .io_times = (sim_time_t[]){2, 2},
             .num_bursts = 3,
+            .service = 6,
             .current_burst = 0,
             .remaining_time = 4, // Will be set properly in initialization
             .state = READY,
             .io_end_time = -1,
+            .last_cpu = -1,
+            .home_node = -1,
             .completed_flag = 0,
             .in_queue = 0
         },
         {
             .pid = "P2", 
             .arrival_time = 2,
-            .cpu_bursts = (int[]){3, 1},        // CPU: 3 → I/O →   CPU: 1
-            .io_times = (int[]){1},             // I/O duration: 1
+            .cpu_bursts = (sim_time_t[]){3, 1},        // CPU: 3 → I/O →   CPU: 1
+            .io_times = (sim_time_t[]){1},             // I/O duration: 1
             .num_bursts = 2,
+            .service = 4,
             .current_burst = 0,
             .remaining_time = 3,
             .state = READY,
             .io_end_time = -1,
+            .last_cpu = -1,
+            .home_node = -1,
             .completed_flag = 0,
             .in_queue = 0
         },
         {
            .pid = "P3",
             .arrival_time = 5,
-            .cpu_bursts = (int[]){2},           // Just CPU: 2 (no I/O)
+            .cpu_bursts = (sim_time_t[]){2},           // Just CPU: 2 (no I/O)
             .io_times = NULL,
             .num_bursts = 1,
+            .service = 2,
             .current_burst = 0,
             .remaining_time = 2,
             .state = READY,
             .io_end_time = -1,
+            .last_cpu = -1,
+            .home_node = -1,
             .completed_flag = 0,
             .in_queue = 0
         }
     };
 
-    if (strcmp(algorithm, "FIFO") == 0)
-        fifo_schedule(processes, NUM_PROCESSES);
-    else if (strcmp(algorithm, "SJF") == 0)
-        sjf_schedule(processes, NUM_PROCESSES);
-    else if (strcmp(algorithm, "STCF") == 0)
-        stcf_schedule(processes, NUM_PROCESSES);
-    else if (strcmp(algorithm, "RR") == 0)
-        rr_schedule(processes, NUM_PROCESSES, quantum);
-    else
+    //* Devices and groups first: the workload refers to them by name
+    if (device_spec != NULL && io_configure(device_spec) != 0)
+        return 1;
+    if (group_spec != NULL && group_configure(group_spec) != 0)
+        return 1;
+
+    //* --manifest: many runs over shared workloads, one results file
+    if (manifest_path != NULL)
+    {
+        if (trace_path != NULL || timeline_csv != NULL || timeline_bin != NULL ||
+            event_log != NULL || pipe_mode != NULL)
+        {
+            printf("--manifest does not support event output (--trace, --timeline, --event-log).\n");
+            return 1;
+        }
+        if (progress_enabled(&progress_config))
+        {
+            printf("--manifest does not support --progress.\n");
+            return 1;
+        }
+        return run_manifest(manifest_path, results_path, &run, processes, NUM_PROCESSES) == 0 ? 0 : 1;
+    }
+
+    run_configure(&run);
+
+    Process *workload = processes;
+    int num_processes = NUM_PROCESSES;
+
+    if (run.workload_path != NULL && load_workload(run.workload_path, &workload, &num_processes) != 0)
+        return 1;
+
+    //* --pack-workload and --unpack-workload are converters: store the
+    //* workload as loaded and exit
+    if (pack_path != NULL)
+    {
+        if (run.workload_path == NULL)
+        {
+            printf("--pack-workload needs --workload.\n");
+            return 1;
+        }
+        int result = packed_convert(run.workload_path, pack_path, workload, num_processes);
+        free_workload(workload, num_processes);
+        return result == 0 ? 0 : 1;
+    }
+    if (unpack_path != NULL)
+    {
+        if (run.workload_path == NULL)
+        {
+            printf("--unpack-workload needs --workload.\n");
+            return 1;
+        }
+        int result = save_workload(unpack_path, workload, num_processes);
+        if (result == 0)
+            printf("Wrote %d processes: %s -> %s\n", num_processes, run.workload_path, unpack_path);
+        free_workload(workload, num_processes);
+        return result == 0 ? 0 : 1;
+    }
+
+    const char *problem = run_check(&run);
+    if (problem != NULL)
+    {
+        printf("%s\n", problem);
+        return 1;
+    }
+
+    //* --compare: every policy on the same workload, one table of changes
+    if (compare.count > 0)
+    {
+        if (trace_path != NULL || timeline_csv != NULL || timeline_bin != NULL ||
+            event_log != NULL || pipe_mode != NULL)
+        {
+            printf("--compare does not support event output (--trace, --timeline, --event-log).\n");
+            return 1;
+        }
+        if (progress_enabled(&progress_config))
+        {
+            printf("--compare does not support --progress.\n");
+            return 1;
+        }
+
+        int result = compare_run(&compare, &mc, &run, workload, num_processes);
+        if (workload != processes)
+            free_workload(workload, num_processes);
+        return result == 0 ? 0 : 1;
+    }
+
+    //* --replications: many runs with random bursts, only the summary
+    if (mc.replications > 0)
+    {
+        if (trace_path != NULL || timeline_csv != NULL || timeline_bin != NULL ||
+            event_log != NULL || pipe_mode != NULL)
+        {
+            printf("--replications does not support event output (--trace, --timeline, --event-log).\n");
+            return 1;
+        }
+        if (progress_enabled(&progress_config))
+        {
+            printf("--replications does not support --progress.\n");
+            return 1;
+        }
+
+        int result = mc_run(&mc, &run, workload, num_processes);
+        if (workload != processes)
+            free_workload(workload, num_processes);
+        return result == 0 ? 0 : 1;
+    }
+
+    //* --cpus: the partitioned SMP engine (FIFO, RR) or the gang scheduler
+    //* replaces the single-CPU schedulers
+    if (run.smp.cpus > 0)
+    {
+        if (trace_path != NULL || timeline_csv != NULL || timeline_bin != NULL ||
+            event_log != NULL || pipe_mode != NULL)
+        {
+            printf("--cpus does not support event output (--trace, --timeline, --event-log).\n");
+            return 1;
+        }
+
+        if (latency)
+            metrics_open(workload, num_processes);
+        if (progress_enabled(&progress_config) && progress_start(&progress_config, num_processes) != 0)
+            return 1;
+        int result = run_schedule(&run, workload, num_processes);
+        progress_stop();
+        if (result == 0)
+        {
+            smp_report();
+            gang_report();
+            cost_report();
+            metrics_report();
+            power_report();
+        }
+        metrics_close();
+
+        if (workload != processes)
+            free_workload(workload, num_processes);
+        return result == 0 ? 0 : 1;
+    }
+
+    if (trace_path != NULL && trace_open(trace_path, workload, num_processes) != 0)
+        return 1;
+    if ((timeline_csv != NULL || timeline_bin != NULL) &&
+        timeline_open(timeline_csv, timeline_bin, workload, num_processes) != 0)
+        return 1;
+
+    //* Writer thread last: it takes over the trace and timeline writers
+    if ((event_log != NULL || pipe_mode != NULL) &&
+        tracepipe_open(pipe_size, pipe_mode != NULL && strcmp(pipe_mode, "drop") == 0 ? PIPE_DROP : PIPE_BLOCK,
+                       event_log, workload) != 0)
+        return 1;
+
+    if (latency)
+        metrics_open(workload, num_processes);
+
+    if (progress_enabled(&progress_config) && progress_start(&progress_config, num_processes) != 0)
+        return 1;
+
+    prof_start();
+
+    if (run_schedule(&run, workload, num_processes) < 0)
         printf("Unknown scheduling algorithm.\n");
 
+    progress_stop();
+
+    prof_report();
+
+    tracepipe_close();
+    trace_close();
+    timeline_close();
+
+    io_report();
+    group_report();
+    cost_report();
+    predict_report();
+    tracepipe_report();
+    metrics_report();
+    rr_report();
+    power_report();
+    metrics_close();
+
+    if (workload != processes)
+        free_workload(workload, num_processes);
+
     return 0;
 }
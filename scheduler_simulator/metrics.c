@@ -0,0 +1,130 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "metrics.h"
+#include "trace.h"
+
+Metrics *metrics = NULL;
+
+void metrics_open(Process processes[], int num_processes)
+{
+    Metrics *m = calloc(1, sizeof(Metrics));
+    m->processes = processes;
+    m->num_processes = num_processes;
+
+    for (int i = 0; i < num_processes; i++)
+    {
+        processes[i].first_run = -1;
+        processes[i].ready_since = processes[i].arrival_time;
+        processes[i].wait = 0;
+    }
+
+    metrics = m;
+}
+
+void metrics_close(void)
+{
+    Metrics *m = metrics;
+    if (m == NULL)
+        return;
+
+    free(m);
+    metrics = NULL;
+}
+
+void metrics_record(Metrics *m, int type, int pid_index, sim_time_t time)
+{
+    Process *p = &m->processes[pid_index];
+    switch (type)
+    {
+    case TRACE_DISPATCH:
+        p->wait += time - p->ready_since;
+        if (p->first_run < 0)
+            p->first_run = time;
+        break;
+    case TRACE_PREEMPT:
+    case TRACE_UNBLOCK:
+        p->ready_since = time;
+        break;
+    case TRACE_FINISH:
+        latency_record(&m->latency, m, pid_index, time);
+        break;
+    }
+}
+
+void latency_record(LatencyStats *l, const Metrics *m, int pid_index, sim_time_t time)
+{
+    const Process *p = &m->processes[pid_index];
+    long turnaround = time - p->arrival_time;
+    long service = p->service > 0 ? p->service : 1;
+
+    hist_add(&l->wait, p->wait);
+    hist_add(&l->response, p->first_run - p->arrival_time);
+    hist_add(&l->turnaround, turnaround);
+    hist_add(&l->slowdown, turnaround * SLOWDOWN_SCALE / service);
+    if (time > l->makespan)
+        l->makespan = time;
+}
+
+void latency_merge(LatencyStats *into, const LatencyStats *from)
+{
+    hist_merge(&into->wait, &from->wait);
+    hist_merge(&into->response, &from->response);
+    hist_merge(&into->turnaround, &from->turnaround);
+    hist_merge(&into->slowdown, &from->slowdown);
+    if (from->makespan > into->makespan)
+        into->makespan = from->makespan;
+}
+
+void metrics_summarize(RunSummary *s)
+{
+    Metrics *m = metrics;
+    memset(s, 0, sizeof(*s));
+    if (m == NULL)
+        return;
+
+    const LatencyStats *l = &m->latency;
+    s->processes = m->num_processes;
+    s->finished = (int)l->turnaround.count;
+    s->makespan = l->makespan;
+    s->avg_turnaround = hist_mean(&l->turnaround);
+    s->avg_wait = hist_mean(&l->wait);
+    s->avg_response = hist_mean(&l->response);
+    s->p50_turnaround = hist_quantile(&l->turnaround, 0.50);
+    s->p99_turnaround = hist_quantile(&l->turnaround, 0.99);
+    s->p99_wait = hist_quantile(&l->wait, 0.99);
+    s->p99_response = hist_quantile(&l->response, 0.99);
+    s->p99_slowdown = (double)hist_quantile(&l->slowdown, 0.99) / SLOWDOWN_SCALE;
+
+    for (int i = 0; i < m->num_processes; i++)
+        s->cpu_ticks += m->processes[i].service;
+}
+
+static void report_row(const char *name, const Histogram *h, double scale)
+{
+    printf("  %-11s %12.2f %10.2f %10.2f %10.2f %10.2f %10.2f\n", name,
+           hist_mean(h) / scale,
+           hist_quantile(h, 0.50) / scale,
+           hist_quantile(h, 0.90) / scale,
+           hist_quantile(h, 0.99) / scale,
+           hist_quantile(h, 0.999) / scale,
+           h->max / scale);
+}
+
+void metrics_report(void)
+{
+    Metrics *m = metrics;
+    if (m == NULL)
+        return;
+
+    const LatencyStats *l = &m->latency;
+
+    printf("\n=== Latency (%ld of %d processes finished) ===\n", l->turnaround.count, m->num_processes);
+    printf("  %-11s %12s %10s %10s %10s %10s %10s\n", "", "mean", "p50", "p90", "p99", "p99.9", "max");
+    report_row("wait", &l->wait, 1.0);
+    report_row("response", &l->response, 1.0);
+    report_row("turnaround", &l->turnaround, 1.0);
+    report_row("slowdown", &l->slowdown, SLOWDOWN_SCALE);
+    printf("  (ticks; slowdown = turnaround / CPU time; percentiles within %.1f%%)\n", 100.0 / HIST_HALF);
+}
@@ -0,0 +1,80 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include "process.h"
+#include "histogram.h"
+
+//* Per-process run metrics, fed by the same transitions as the trace
+//
+//   response   = first dispatch - arrival
+//   wait       = time spent in a ready queue
+//   turnaround = finish - arrival
+//   slowdown   = turnaround / CPU time needed
+//
+// The running values live in the Process itself (wait, first_run,
+// ready_since), so the metrics add no memory per process. While a process
+// is alive only it is written, so CPUs simulated on different threads
+// (--cpus) can record without synchronization. When it finishes, its
+// values go into latency histograms whose size does not depend on the
+// number of processes; slowdown divides by the service time summed when
+// the workload was loaded. --cpus threads each fill their own
+// LatencyStats and merge them at the end.
+
+#define SLOWDOWN_SCALE 100      // slowdown is recorded in hundredths
+
+typedef struct LatencyStats
+{
+    Histogram wait;
+    Histogram response;
+    Histogram turnaround;
+    Histogram slowdown;         // x SLOWDOWN_SCALE
+    sim_time_t makespan;        // latest finish time
+} LatencyStats;
+
+typedef struct Metrics
+{
+    Process *processes;
+    int num_processes;
+    LatencyStats latency;
+} Metrics;
+
+typedef struct RunSummary
+{
+    int processes;
+    int finished;
+    sim_time_t makespan;
+    double avg_turnaround;
+    double avg_wait;
+    double avg_response;
+    long cpu_ticks;         // CPU burst ticks in the workload
+    long p50_turnaround;
+    long p99_turnaround;
+    long p99_wait;
+    long p99_response;
+    double p99_slowdown;
+} RunSummary;
+
+extern Metrics *metrics;
+
+void metrics_open(Process processes[], int num_processes);
+void metrics_close(void);
+
+void metrics_record(Metrics *m, int type, int pid_index, sim_time_t time);
+
+// Hot-path hook, called with trace_event_t types
+static inline void metrics_event(int type, int pid_index, sim_time_t time)
+{
+    if (metrics != NULL)
+        metrics_record(metrics, type, pid_index, time);
+}
+
+// O(1): add a process that finished at time to l
+void latency_record(LatencyStats *l, const Metrics *m, int pid_index, sim_time_t time);
+void latency_merge(LatencyStats *into, const LatencyStats *from);
+
+void metrics_summarize(RunSummary *summary);
+
+// Percentile table of the latency histograms (--latency)
+void metrics_report(void);
+
+#endif
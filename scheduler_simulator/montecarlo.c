@@ -0,0 +1,441 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#include "montecarlo.h"
+#include "workload.h"
+#include "simulator.h"
+
+#define MC_METRICS 10
+#define MC_DEFAULT_SPREAD 25
+#define MC_TWO_PI 6.283185307179586
+
+static const char *metric_names[MC_METRICS] = {
+    "makespan", "utilization", "avg turnaround", "avg wait", "avg response",
+    "p50 turnaround", "p99 turnaround", "p99 wait", "p99 response", "p99 slowdown",
+};
+
+static const char *dist_names[] = {"default", "fixed", "exp", "uniform", "normal"};
+
+static void *checked(void *ptr)
+{
+    if (ptr == NULL)
+    {
+        fprintf(stderr, "replications: out of memory\n");
+        exit(1);
+    }
+    return ptr;
+}
+
+void mc_config_defaults(McConfig *mc)
+{
+    *mc = (McConfig){
+        .replications = 0,
+        .workers = 0,
+        .seed = 1,
+        .dist = DIST_EXP,
+        .spread = 0,
+    };
+}
+
+const char *mc_dist_name(int dist)
+{
+    return dist_names[dist];
+}
+
+int mc_parse_dist(const char *spec, int *dist, int *spread)
+{
+    const char *colon = strchr(spec, ':');
+    size_t length = colon != NULL ? (size_t)(colon - spec) : strlen(spec);
+
+    for (int d = DIST_FIXED; d <= DIST_NORMAL; d++)
+    {
+        if (strlen(dist_names[d]) != length || strncmp(spec, dist_names[d], length) != 0)
+            continue;
+
+        *dist = d;
+        *spread = d == DIST_UNIFORM || d == DIST_NORMAL ? MC_DEFAULT_SPREAD : 0;
+        if (colon == NULL)
+            return 0;
+        if (d != DIST_UNIFORM && d != DIST_NORMAL)
+            return -1;
+
+        char *end;
+        long percent = strtol(colon + 1, &end, 10);
+        if (end == colon + 1 || *end != '\0' || percent < 1 || percent > 100)
+            return -1;
+        *spread = (int)percent;
+        return 0;
+    }
+    return -1;
+}
+
+int mc_parse_option(McConfig *mc, int argc, char *argv[], int *i)
+{
+    const char *opt = argv[*i];
+    if (strcmp(opt, "--replications") != 0 && strcmp(opt, "--workers") != 0 &&
+        strcmp(opt, "--seed") != 0 && strcmp(opt, "--burst-dist") != 0)
+        return 0;
+
+    const char *value = option_value(argc, argv, i);
+    if (value == NULL)
+        return -1;
+
+    if (strcmp(opt, "--replications") == 0)
+    {
+        mc->replications = atoi(value);
+        if (mc->replications < 2)
+        {
+            printf("--replications takes at least 2 runs.\n");
+            return -1;
+        }
+    }
+    else if (strcmp(opt, "--workers") == 0)
+    {
+        mc->workers = atoi(value);
+        if (mc->workers < 1)
+        {
+            printf("--workers takes a positive process count.\n");
+            return -1;
+        }
+    }
+    else if (strcmp(opt, "--seed") == 0)
+    {
+        mc->seed = strtoull(value, NULL, 0);
+    }
+    else if (mc_parse_dist(value, &mc->dist, &mc->spread) != 0)
+    {
+        printf("--burst-dist takes fixed, exp, uniform[:P] or normal[:P] (P = 1..100%%).\n");
+        return -1;
+    }
+    return 1;
+}
+
+// ---------------------------------------------------------------------------
+// Counter-based random numbers
+// ---------------------------------------------------------------------------
+
+// SplitMix64 finalizer: a bijection on 64 bits that mixes every input bit
+static uint64_t mix(uint64_t z)
+{
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+double mc_uniform01(uint64_t seed, int replication, int process, int draw)
+{
+    uint64_t stream = mix(seed ^ mix(((uint64_t)(uint32_t)replication << 32) | (uint32_t)process));
+    uint64_t bits = mix(stream + (uint64_t)(uint32_t)draw * 0x9e3779b97f4a7c15ULL);
+    return ((double)(bits >> 11) + 0.5) * 0x1.0p-53;
+}
+
+// A burst of mean length `mean`, from two uniforms
+static sim_time_t draw_burst(int dist, int spread, sim_time_t mean, double u1, double u2)
+{
+    double x = mean;
+    double s = spread / 100.0;
+
+    switch (dist)
+    {
+    case DIST_EXP:
+        x = -mean * log(u1);
+        break;
+    case DIST_UNIFORM:
+        x = mean * (1.0 + s * (2.0 * u1 - 1.0));
+        break;
+    case DIST_NORMAL:
+        x = mean * (1.0 + s * sqrt(-2.0 * log(u1)) * cos(MC_TWO_PI * u2));
+        break;
+    }
+
+    sim_time_t ticks = (sim_time_t)(x + 0.5);
+    return ticks < 1 ? 1 : ticks;
+}
+
+// ---------------------------------------------------------------------------
+// Replications
+// ---------------------------------------------------------------------------
+
+//* Burst lengths as loaded: each process's CPU bursts, then its I/O bursts
+typedef struct McWorkload
+{
+    Process *processes;
+    int num_processes;
+    sim_time_t *means;
+    int *offsets;           // per process, into means
+} McWorkload;
+
+static void resample(const McWorkload *w, const McConfig *mc, int replication)
+{
+    for (int i = 0; i < w->num_processes; i++)
+    {
+        Process *p = &w->processes[i];
+        const sim_time_t *mean = &w->means[w->offsets[i]];
+        int dist = p->dist != DIST_DEFAULT ? p->dist : mc->dist;
+        int spread = p->dist != DIST_DEFAULT ? p->dist_spread : mc->spread;
+
+        //* Draw 2k, 2k+1 for CPU burst k; 2(n+k), 2(n+k)+1 for I/O burst k
+        for (int b = 0; b < p->num_bursts; b++)
+            p->cpu_bursts[b] = draw_burst(dist, spread, mean[b],
+                                          mc_uniform01(mc->seed, replication, i, 2 * b),
+                                          mc_uniform01(mc->seed, replication, i, 2 * b + 1));
+        for (int b = 0; b < p->num_bursts - 1; b++)
+        {
+            int k = p->num_bursts + b;
+            p->io_times[b] = draw_burst(dist, spread, mean[p->num_bursts + b],
+                                        mc_uniform01(mc->seed, replication, i, 2 * k),
+                                        mc_uniform01(mc->seed, replication, i, 2 * k + 1));
+        }
+        workload_set_service(p);
+    }
+}
+
+static void restore(const McWorkload *w)
+{
+    for (int i = 0; i < w->num_processes; i++)
+    {
+        Process *p = &w->processes[i];
+        const sim_time_t *mean = &w->means[w->offsets[i]];
+        memcpy(p->cpu_bursts, mean, p->num_bursts * sizeof(sim_time_t));
+        if (p->num_bursts > 1)
+            memcpy(p->io_times, mean + p->num_bursts, (p->num_bursts - 1) * sizeof(sim_time_t));
+        workload_set_service(p);
+    }
+}
+
+// Replications worker, worker + workers, ... (striding evens out slow
+// runs), each drawn once and simulated under every run
+static void run_share(const McWorkload *w, const McConfig *mc, const RunConfig runs[], int num_runs,
+                      McSample *samples, int worker, int workers)
+{
+    Simulator *sim = sim_create_from(w->processes, w->num_processes);
+
+    for (int r = worker; r < mc->replications; r += workers)
+    {
+        resample(w, mc, r);
+
+        for (int k = 0; k < num_runs; k++)
+        {
+            McSample *s = &samples[r * num_runs + k];
+            s->ok = sim_run(sim, &runs[k], &s->results) == 0;
+            if (!s->ok)
+                printf("replication %d: %s\n", r, sim_error(sim));
+        }
+    }
+
+    sim_destroy(sim);
+}
+
+static void sample_values(const SimResults *res, double v[MC_METRICS])
+{
+    const RunSummary *s = &res->summary;
+    v[0] = s->makespan;
+    v[1] = res->utilization;
+    v[2] = s->avg_turnaround;
+    v[3] = s->avg_wait;
+    v[4] = s->avg_response;
+    v[5] = s->p50_turnaround;
+    v[6] = s->p99_turnaround;
+    v[7] = s->p99_wait;
+    v[8] = s->p99_response;
+    v[9] = s->p99_slowdown;
+}
+
+// Two-sided 95% critical value of Student's t with df degrees of freedom
+static double t_critical(int df)
+{
+    static const double table[30] = {
+        12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042,
+    };
+    if (df <= 30)
+        return table[df - 1];
+    if (df <= 60)
+        return 2.000;
+    if (df <= 120)
+        return 1.980;
+    return 1.960;
+}
+
+static void report(const McConfig *mc, const RunConfig *run, const McSample *samples, int workers)
+{
+    int n = 0;
+    for (int r = 0; r < mc->replications; r++)
+        n += samples[r].ok;
+
+    printf("\n=== Monte Carlo: %d replications of %s, %d worker%s, seed %llu ===\n",
+           mc->replications, run->algorithm, workers, workers == 1 ? "" : "s",
+           (unsigned long long)mc->seed);
+    printf("  bursts:          %s", dist_names[mc->dist]);
+    if (mc->dist == DIST_UNIFORM || mc->dist == DIST_NORMAL)
+        printf(":%d", mc->spread);
+    printf(" (processes without dist=)\n");
+    if (n < mc->replications)
+        printf("  failed:          %d replications\n", mc->replications - n);
+    if (n < 2)
+        return;
+
+    double (*values)[MC_METRICS] = checked(malloc(mc->replications * sizeof(*values)));
+    for (int r = 0; r < mc->replications; r++)
+    {
+        if (samples[r].ok)
+            sample_values(&samples[r].results, values[r]);
+    }
+
+    printf("  %-15s %11s  %26s %11s %11s %11s\n", "", "mean", "95% CI", "stddev", "min", "max");
+    for (int k = 0; k < MC_METRICS; k++)
+    {
+        double sum = 0.0, min = INFINITY, max = -INFINITY;
+        for (int r = 0; r < mc->replications; r++)
+        {
+            if (!samples[r].ok)
+                continue;
+            double v = values[r][k];
+            sum += v;
+            if (v < min)
+                min = v;
+            if (v > max)
+                max = v;
+        }
+        double mean = sum / n;
+
+        double squares = 0.0;
+        for (int r = 0; r < mc->replications; r++)
+        {
+            if (samples[r].ok)
+                squares += (values[r][k] - mean) * (values[r][k] - mean);
+        }
+        double stddev = sqrt(squares / (n - 1));
+        double half = t_critical(n - 1) * stddev / sqrt(n);
+
+        printf("  %-15s %11.3f  [%11.3f, %11.3f] %11.3f %11.3f %11.3f\n",
+               metric_names[k], mean, mean - half, mean + half, stddev, min, max);
+    }
+    free(values);
+}
+
+int mc_default_workers(const McConfig *mc)
+{
+    int workers = mc->workers > 0 ? mc->workers : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    return workers < 1 ? 1 : workers;
+}
+
+int mc_simulate(const McConfig *mc, const RunConfig runs[], int num_runs,
+                Process processes[], int num_processes, McSample out[])
+{
+    int workers = mc_default_workers(mc);
+    if (workers > mc->replications)
+        workers = mc->replications;
+
+    //* Keep the loaded burst lengths as the distributions' means
+    McWorkload w = {processes, num_processes, NULL, checked(malloc((num_processes + 1) * sizeof(int)))};
+    int total = 0;
+    for (int i = 0; i < num_processes; i++)
+    {
+        w.offsets[i] = total;
+        total += 2 * processes[i].num_bursts - 1;
+    }
+    w.means = checked(malloc((total > 0 ? total : 1) * sizeof(sim_time_t)));
+    for (int i = 0; i < num_processes; i++)
+    {
+        Process *p = &processes[i];
+        memcpy(&w.means[w.offsets[i]], p->cpu_bursts, p->num_bursts * sizeof(sim_time_t));
+        if (p->num_bursts > 1)
+            memcpy(&w.means[w.offsets[i] + p->num_bursts], p->io_times, (p->num_bursts - 1) * sizeof(sim_time_t));
+    }
+
+    size_t size = (size_t)mc->replications * num_runs * sizeof(McSample);
+    McSample *samples = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (samples == MAP_FAILED)
+    {
+        perror("mmap");
+        free(w.means);
+        free(w.offsets);
+        return -1;
+    }
+    memset(samples, 0, size);
+
+    if (workers == 1)
+    {
+        run_share(&w, mc, runs, num_runs, samples, 0, 1);
+    }
+    else
+    {
+        //* Nothing buffered may be written twice by the children
+        fflush(stdout);
+
+        pid_t *pids = checked(malloc(workers * sizeof(pid_t)));
+        int started = 0;
+        for (; started < workers; started++)
+        {
+            pid_t pid = fork();
+            if (pid < 0)
+            {
+                perror("fork");
+                break;
+            }
+            if (pid == 0)
+            {
+                run_share(&w, mc, runs, num_runs, samples, started, workers);
+                fflush(stdout);
+                _exit(0);
+            }
+            pids[started] = pid;
+        }
+
+        //* Reap our own workers only (the caller may have children of its
+        //* own); the share of one that did not finish cleanly runs again here
+        for (int k = 0; k < started; k++)
+        {
+            int status = 0;
+            pid_t reaped;
+            while ((reaped = waitpid(pids[k], &status, 0)) < 0 && errno == EINTR)
+                ;
+            if (reaped < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+            {
+                fprintf(stderr, "replications: worker %d failed, running its share again\n", k);
+                run_share(&w, mc, runs, num_runs, samples, k, workers);
+            }
+        }
+        free(pids);
+
+        //* Replications of workers that could not be started run here
+        for (int k = started; k < workers; k++)
+            run_share(&w, mc, runs, num_runs, samples, k, workers);
+    }
+
+    restore(&w);
+    memcpy(out, samples, size);
+
+    munmap(samples, size);
+    free(w.means);
+    free(w.offsets);
+    return workers;
+}
+
+int mc_run(const McConfig *mc, const RunConfig *run, Process processes[], int num_processes)
+{
+    McSample *samples = checked(malloc(mc->replications * sizeof(McSample)));
+    int workers = mc_simulate(mc, run, 1, processes, num_processes, samples);
+    if (workers < 0)
+    {
+        free(samples);
+        return -1;
+    }
+
+    report(mc, run, samples, workers);
+
+    int failed = 0;
+    for (int r = 0; r < mc->replications; r++)
+        failed |= !samples[r].ok;
+
+    free(samples);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,90 @@
+#ifndef MONTECARLO_H
+#define MONTECARLO_H
+
+#include <stdint.h>
+
+#include "process.h"
+#include "experiment.h"
+#include "simulator.h"
+
+//* Monte Carlo replications (--replications N)
+//
+// Every replication redraws each CPU and I/O burst from a distribution
+// whose mean is the burst's length in the workload, runs the whole
+// simulation and records its summary (makespan, mean and p99 latencies).
+// The report gives the mean of each over the replications with a 95%
+// confidence interval (Student's t).
+//
+// Distributions, per process with a dist= workload attribute, otherwise
+// --burst-dist (default exp):
+//
+//   fixed       the workload value (no randomness)
+//   exp         exponential
+//   uniform:P   uniform within +-P% of the mean
+//   normal:P    normal with a standard deviation of P% of the mean
+//
+// Draws are rounded to whole ticks, at least 1.
+//
+// Random numbers come from a counter-based generator: draw k of process
+// i in replication r is a hash of (seed, r, i, k), with no state carried
+// from one draw to the next. A replication's bursts therefore do not
+// depend on which worker runs it or in what order, so results are the
+// same for any --workers.
+//
+// The schedulers keep their state in globals (see simulator.h), so the
+// workers are processes forked after the workload is loaded. They share
+// its pages copy-on-write, and each writes its replications' results into
+// a shared mapping. Only those workers are reaped, by pid, and the
+// replications of one that dies run again in the caller. Replications are
+// independent, so throughput grows with the worker count up to the number
+// of cores.
+
+typedef enum {
+    DIST_DEFAULT, DIST_FIXED, DIST_EXP, DIST_UNIFORM, DIST_NORMAL
+} dist_t;
+
+typedef struct McConfig
+{
+    int replications;       // 0 = off
+    int workers;            // 0 = one per online CPU
+    uint64_t seed;
+    int dist;               // --burst-dist, for processes without dist=
+    int spread;             // percent
+} McConfig;
+
+//* One simulation of a replication
+typedef struct McSample
+{
+    int ok;
+    SimResults results;
+} McSample;
+
+void mc_config_defaults(McConfig *mc);
+
+// Parse the Monte Carlo option at argv[*i], like parse_run_option()
+int mc_parse_option(McConfig *mc, int argc, char *argv[], int *i);
+
+// "uniform:20" -> DIST_UNIFORM, 20. Returns -1 if spec is not a distribution.
+int mc_parse_dist(const char *spec, int *dist, int *spread);
+const char *mc_dist_name(int dist);
+
+// Run mc->replications simulations of run over processes and print the
+// confidence intervals. Returns 0 if every replication ran.
+int mc_run(const McConfig *mc, const RunConfig *run, Process processes[], int num_processes);
+
+// Draw mc->replications sets of bursts and simulate each under all of
+// runs[0 .. num_runs), on the workers: out[r * num_runs + k] is
+// replication r of runs[k], so the runs of one replication are paired on
+// the same bursts. The processes keep their loaded bursts afterwards.
+// Returns the number of workers used, -1 on failure.
+int mc_simulate(const McConfig *mc, const RunConfig runs[], int num_runs,
+                Process processes[], int num_processes, McSample out[]);
+
+// --workers, or one per online CPU
+int mc_default_workers(const McConfig *mc);
+
+// Uniform in (0, 1): draw `draw` of process `process` in `replication`,
+// a pure function of its arguments (see above)
+double mc_uniform01(uint64_t seed, int replication, int process, int draw);
+
+#endif
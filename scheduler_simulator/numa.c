@@ -0,0 +1,99 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "numa.h"
+
+int numa_enabled = 0;
+NumaTopology numa_topology = {1, 1, 1};
+unsigned char numa_cpu_node[COST_MAX_CPUS];
+unsigned char numa_distance[NUMA_MAX_NODES][NUMA_MAX_NODES];
+int numa_cost[NUMA_MAX_NODES][NUMA_MAX_NODES];
+int numa_smt_penalty = 0;
+
+static int remote_percent = 0;
+
+int numa_parse(const char *spec, NumaTopology *topology)
+{
+    char extra;
+    if (sscanf(spec, "%dx%dx%d%c", &topology->sockets, &topology->cores, &topology->threads, &extra) != 3 ||
+        topology->sockets < 1 || topology->cores < 1 || topology->threads < 1)
+    {
+        printf("--numa takes SOCKETSxCORESxTHREADS, e.g. 2x8x2.\n");
+        return -1;
+    }
+    if (topology->sockets > NUMA_MAX_NODES)
+    {
+        printf("--numa supports up to %d sockets.\n", NUMA_MAX_NODES);
+        return -1;
+    }
+    if ((long)topology->sockets * topology->cores * topology->threads > COST_MAX_CPUS)
+    {
+        printf("--numa supports up to %d CPUs.\n", COST_MAX_CPUS);
+        return -1;
+    }
+    return 0;
+}
+
+int numa_configure(const char *spec, int remote_penalty, int smt_penalty)
+{
+    numa_enabled = 0;
+    numa_topology = (NumaTopology){1, 1, 1};
+    if (spec == NULL)
+        return 0;
+
+    NumaTopology topology;
+    if (numa_parse(spec, &topology) != 0)
+        return -1;
+
+    numa_topology = topology;
+    numa_smt_penalty = smt_penalty;
+    remote_percent = remote_penalty;
+
+    int per_node = topology.cores * topology.threads;
+    for (int cpu = 0; cpu < numa_cpus(); cpu++)
+        numa_cpu_node[cpu] = (unsigned char)(cpu / per_node);
+
+    //* Sockets on a ring: hops the shorter way round
+    for (int a = 0; a < topology.sockets; a++)
+    {
+        for (int b = 0; b < topology.sockets; b++)
+        {
+            int hops = abs(a - b);
+            if (topology.sockets - hops < hops)
+                hops = topology.sockets - hops;
+            numa_distance[a][b] = (unsigned char)(NUMA_LOCAL + NUMA_HOP * hops);
+            numa_cost[a][b] = 100 + remote_penalty * (numa_distance[a][b] - NUMA_LOCAL) / NUMA_HOP;
+        }
+    }
+
+    numa_enabled = 1;
+    return 0;
+}
+
+int numa_spread(int node, int k)
+{
+    int sockets = numa_topology.sockets;
+    int cores = numa_topology.cores;
+    int threads = numa_topology.threads;
+
+    if (node >= 0)
+    {
+        k %= cores * threads;
+        return (node * cores + k % cores) * threads + k / cores;
+    }
+
+    k %= sockets * cores * threads;
+    int thread = k / (sockets * cores);
+    int slot = k % (sockets * cores);
+    return ((slot % sockets) * cores + slot / sockets) * threads + thread;
+}
+
+const char *numa_describe(void)
+{
+    static char buffer[128];
+    snprintf(buffer, sizeof(buffer), "%d socket%s x %d cores x %d thread%s, remote +%d%%, SMT +%d%%",
+             numa_topology.sockets, numa_topology.sockets == 1 ? "" : "s", numa_topology.cores,
+             numa_topology.threads, numa_topology.threads == 1 ? "" : "s", remote_percent, numa_smt_penalty);
+    return buffer;
+}
@@ -0,0 +1,81 @@
+#ifndef NUMA_H
+#define NUMA_H
+
+#include "cost.h"
+
+#define NUMA_MAX_NODES 16
+#define NUMA_LOCAL 10           // SLIT distance of a node to itself
+#define NUMA_HOP 11             // added per hop between sockets (2 sockets: 21)
+#define NUMA_IMBALANCE 2        // extra load difference before balancing across nodes
+
+//* NUMA topology (--numa SOCKETSxCORESxTHREADS, which sets --cpus)
+//
+// CPUs are numbered socket by socket, core by core, with the SMT
+// siblings of a core next to each other:
+//
+//     --numa 2x2x2     socket 0: core 0 = CPUs 0,1  core 1 = CPUs 2,3
+//                      socket 1: core 2 = CPUs 4,5  core 3 = CPUs 6,7
+//
+// Every socket is one memory node. A process's memory lives on its home
+// node: node=N in the workload (wrapping around past the last socket),
+// otherwise the node it first runs on (first touch). Sockets sit on a
+// ring, so the distance between two nodes is NUMA_LOCAL + NUMA_HOP per
+// hop, as in an ACPI SLIT.
+//
+// A tick on a CPU away from the home node costs remote_penalty percent
+// more at one hop (scaled by distance beyond that), and a tick while an
+// SMT sibling was busy at the last balancing snapshot costs smt_penalty
+// percent more: a tick of burst needs (100 + penalty) / 100 ticks on the
+// CPU. Penalties come from a node x node table built once by
+// numa_configure(), so the per-tick check is two loads and an add.
+
+typedef struct NumaTopology
+{
+    int sockets;
+    int cores;              // per socket
+    int threads;            // SMT siblings per core
+} NumaTopology;
+
+extern int numa_enabled;
+extern NumaTopology numa_topology;
+extern unsigned char numa_cpu_node[COST_MAX_CPUS];
+extern unsigned char numa_distance[NUMA_MAX_NODES][NUMA_MAX_NODES];
+extern int numa_cost[NUMA_MAX_NODES][NUMA_MAX_NODES];   // 100 + remote percent
+extern int numa_smt_penalty;
+
+// "2x8x2"; prints why and returns -1 if it is not a valid topology
+int numa_parse(const char *spec, NumaTopology *topology);
+
+// Build the tables for spec (NULL = off). Returns 0 on success.
+int numa_configure(const char *spec, int remote_penalty, int smt_penalty);
+
+static inline int numa_node(int cpu)
+{
+    return numa_cpu_node[cpu];
+}
+
+static inline int numa_cpus(void)
+{
+    return numa_topology.sockets * numa_topology.cores * numa_topology.threads;
+}
+
+static inline int numa_first_sibling(int cpu)
+{
+    return cpu - cpu % numa_topology.threads;
+}
+
+// k-th CPU for spreading processes over node (-1 = the whole machine):
+// one per core before any SMT sibling, alternating sockets
+int numa_spread(int node, int k);
+
+// "2 sockets x 8 cores x 2 threads, remote +30%, SMT +20%"
+const char *numa_describe(void);
+
+// CPU time, in hundredths of a tick, that one tick of burst takes for a
+// process with memory on home running on cpu (100 = full speed)
+static inline int numa_tick_cost(int cpu, int home, int sibling_busy)
+{
+    return numa_cost[numa_cpu_node[cpu]][home] + (sibling_busy ? numa_smt_penalty : 0);
+}
+
+#endif
@@ -0,0 +1,755 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "packed.h"
+#include "workload.h"
+#include "io_device.h"
+#include "group.h"
+#include "priority.h"
+#include "numa.h"
+#include "montecarlo.h"
+
+#define NAME_MAX_LEN 255            // device names and group paths in the tables
+#define LOAD_SLACK 8                // zero bytes after a payload: unpack() reads whole words
+
+//* Extras a process carries past its bursts (the flags column)
+enum {
+    PACK_TAGGED = 1,    // I/O bursts with a device or seek position
+    PACK_PRIO = 2,
+    PACK_GROUP = 4,
+    PACK_JOB = 8,
+    PACK_NODE = 16,
+    PACK_DIST = 32,
+    PACK_ALL_FLAGS = 63
+};
+
+static uint64_t zigzag(int64_t v)
+{
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static int64_t unzigzag(uint64_t v)
+{
+    return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+// ---------------------------------------------------------------------------
+// Writing
+// ---------------------------------------------------------------------------
+
+typedef struct Buffer
+{
+    unsigned char *data;
+    size_t used;
+    size_t capacity;
+} Buffer;
+
+static void reserve(Buffer *b, size_t more)
+{
+    if (b->used + more <= b->capacity)
+        return;
+    while (b->used + more > b->capacity)
+        b->capacity = b->capacity ? b->capacity * 2 : 4096;
+    b->data = realloc(b->data, b->capacity);
+}
+
+static void put_varint(Buffer *b, uint64_t v)
+{
+    reserve(b, 10);
+    while (v >= 0x80)
+    {
+        b->data[b->used++] = (unsigned char)(v | 0x80);
+        v >>= 7;
+    }
+    b->data[b->used++] = (unsigned char)v;
+}
+
+static void put_bytes(Buffer *b, const void *data, size_t len)
+{
+    reserve(b, len);
+    memcpy(b->data + b->used, data, len);
+    b->used += len;
+}
+
+// <varint minimum> <width byte> <n values - minimum, width bits each, LSB first>
+static void put_column(Buffer *b, const uint64_t *values, int n)
+{
+    uint64_t lo = n > 0 ? values[0] : 0, hi = lo;
+    for (int i = 1; i < n; i++)
+    {
+        if (values[i] < lo)
+            lo = values[i];
+        if (values[i] > hi)
+            hi = values[i];
+    }
+    int width = hi == lo ? 0 : 64 - __builtin_clzll(hi - lo);
+
+    put_varint(b, lo);
+    reserve(b, 1);
+    b->data[b->used++] = (unsigned char)width;
+
+    size_t bytes = ((size_t)n * width + 7) / 8;
+    reserve(b, bytes);
+    unsigned char *out = b->data + b->used;
+    memset(out, 0, bytes);
+    for (int i = 0; i < n; i++)
+    {
+        uint64_t v = values[i] - lo;
+        size_t bit = (size_t)i * width;
+        for (int done = 0; done < width; )
+        {
+            int shift = (int)((bit + done) % 8);
+            int take = 8 - shift < width - done ? 8 - shift : width - done;
+            out[(bit + done) / 8] |= (unsigned char)(((v >> done) & ((1u << take) - 1)) << shift);
+            done += take;
+        }
+    }
+    b->used += bytes;
+}
+
+static int flags_of(const Process *p)
+{
+    int flags = 0;
+    for (int b = 0; b < p->num_bursts - 1 && p->io_devices != NULL; b++)
+    {
+        if (p->io_devices[b] != DEFAULT_DEVICE || p->io_positions[b] != 0)
+            flags |= PACK_TAGGED;
+    }
+    if (p->priority != 0)
+        flags |= PACK_PRIO;
+    if (p->group != NULL)
+        flags |= PACK_GROUP;
+    if (p->job != 0)
+        flags |= PACK_JOB;
+    if (p->home_node >= 0)
+        flags |= PACK_NODE;
+    if (p->dist != DIST_DEFAULT)
+        flags |= PACK_DIST;
+    return flags;
+}
+
+//* Device and group tables: only the ones the workload uses, in order of first use
+typedef struct Tables
+{
+    int device_slot[MAX_DEVICES];   // device index -> table position, -1 if unused
+    int devices[MAX_DEVICES];
+    int num_devices;
+    const CpuGroup *groups[MAX_GROUPS];
+    int num_groups;
+} Tables;
+
+static int group_slot(const Tables *t, const CpuGroup *g)
+{
+    for (int i = 0; i < t->num_groups; i++)
+    {
+        if (t->groups[i] == g)
+            return i;
+    }
+    return -1;
+}
+
+static void collect_tables(Tables *t, const Process processes[], int num_processes)
+{
+    memset(t, 0, sizeof(*t));
+    for (int d = 0; d < MAX_DEVICES; d++)
+        t->device_slot[d] = -1;
+
+    for (int i = 0; i < num_processes; i++)
+    {
+        const Process *p = &processes[i];
+        int flags = flags_of(p);
+        for (int b = 0; b < p->num_bursts - 1 && (flags & PACK_TAGGED); b++)
+        {
+            int d = p->io_devices[b];
+            if (t->device_slot[d] < 0)
+            {
+                t->device_slot[d] = t->num_devices;
+                t->devices[t->num_devices++] = d;
+            }
+        }
+        if (p->group != NULL && group_slot(t, p->group) < 0)
+            t->groups[t->num_groups++] = p->group;
+    }
+}
+
+static void pack_block(Buffer *b, const Tables *t, const Process *block, int n,
+                       const char **prev_pid, sim_time_t *prev_arrival)
+{
+    //* pids, front-coded against the previous one
+    for (int i = 0; i < n; i++)
+    {
+        const char *pid = block[i].pid;
+        size_t shared = 0;
+        while ((*prev_pid)[shared] != '\0' && (*prev_pid)[shared] == pid[shared])
+            shared++;
+        size_t rest = strlen(pid + shared);
+        put_varint(b, shared);
+        put_varint(b, rest);
+        put_bytes(b, pid + shared, rest);
+        *prev_pid = pid;
+    }
+
+    int total_cpu = 0, total_io = 0;
+    for (int i = 0; i < n; i++)
+    {
+        total_cpu += block[i].num_bursts;
+        total_io += block[i].num_bursts - 1;
+    }
+    int most = total_cpu > n ? total_cpu : n;
+    uint64_t *values = malloc(most * sizeof(uint64_t));
+
+    for (int i = 0; i < n; i++)
+    {
+        values[i] = zigzag(block[i].arrival_time - *prev_arrival);
+        *prev_arrival = block[i].arrival_time;
+    }
+    put_column(b, values, n);
+
+    for (int i = 0; i < n; i++)
+        values[i] = (uint64_t)block[i].num_bursts;
+    put_column(b, values, n);
+
+    int k = 0;
+    for (int i = 0; i < n; i++)
+    {
+        for (int j = 0; j < block[i].num_bursts; j++)
+            values[k++] = (uint64_t)block[i].cpu_bursts[j];
+    }
+    put_column(b, values, total_cpu);
+
+    k = 0;
+    for (int i = 0; i < n; i++)
+    {
+        for (int j = 0; j < block[i].num_bursts - 1; j++)
+            values[k++] = (uint64_t)block[i].io_times[j];
+    }
+    put_column(b, values, total_io);
+
+    for (int i = 0; i < n; i++)
+        values[i] = (uint64_t)flags_of(&block[i]);
+    put_column(b, values, n);
+
+    //* Extras, in process order
+    for (int i = 0; i < n; i++)
+    {
+        const Process *p = &block[i];
+        int flags = (int)values[i];
+        for (int j = 0; j < p->num_bursts - 1 && (flags & PACK_TAGGED); j++)
+        {
+            put_varint(b, t->device_slot[p->io_devices[j]]);
+            put_varint(b, p->io_positions[j]);
+        }
+        if (flags & PACK_PRIO)
+            put_varint(b, p->priority);
+        if (flags & PACK_GROUP)
+            put_varint(b, group_slot(t, p->group) + 1);
+        if (flags & PACK_JOB)
+            put_varint(b, p->job);
+        if (flags & PACK_NODE)
+            put_varint(b, p->home_node);
+        if (flags & PACK_DIST)
+        {
+            put_varint(b, p->dist);
+            put_varint(b, p->dist_spread);
+        }
+    }
+
+    free(values);
+}
+
+int packed_write(const char *path, const Process processes[], int num_processes)
+{
+    FILE *f = fopen(path, "wb");
+    if (f == NULL)
+    {
+        perror(path);
+        return -1;
+    }
+
+    Tables tables;
+    collect_tables(&tables, processes, num_processes);
+
+    Buffer out = {0};
+    put_bytes(&out, PACK_MAGIC, 4);
+    put_bytes(&out, &(unsigned char){PACK_VERSION}, 1);
+    put_varint(&out, (uint64_t)sim_tick_ns);
+    put_varint(&out, num_processes);
+    put_varint(&out, tables.num_devices);
+    for (int i = 0; i < tables.num_devices; i++)
+    {
+        const char *name = io_device_name(tables.devices[i]);
+        put_varint(&out, strlen(name));
+        put_bytes(&out, name, strlen(name));
+    }
+    put_varint(&out, tables.num_groups);
+    for (int i = 0; i < tables.num_groups; i++)
+    {
+        put_varint(&out, strlen(tables.groups[i]->path));
+        put_bytes(&out, tables.groups[i]->path, strlen(tables.groups[i]->path));
+    }
+
+    Buffer payload = {0};
+    const char *prev_pid = "";
+    sim_time_t prev_arrival = 0;
+    int failed = 0;
+    for (int first = 0; first < num_processes && !failed; first += PACK_BLOCK)
+    {
+        int n = num_processes - first < PACK_BLOCK ? num_processes - first : PACK_BLOCK;
+        payload.used = 0;
+        pack_block(&payload, &tables, processes + first, n, &prev_pid, &prev_arrival);
+
+        put_varint(&out, payload.used);
+        put_bytes(&out, payload.data, payload.used);
+        failed = fwrite(out.data, 1, out.used, f) != out.used;
+        out.used = 0;
+    }
+
+    free(payload.data);
+    free(out.data);
+    if (fclose(f) != 0 || failed)
+    {
+        perror(path);
+        return -1;
+    }
+    return 0;
+}
+
+int packed_convert(const char *source, const char *path, const Process processes[], int num_processes)
+{
+    if (packed_write(path, processes, num_processes) != 0)
+        return -1;
+
+    struct stat in, out;
+    if (stat(source, &in) != 0 || stat(path, &out) != 0)
+    {
+        perror(path);
+        return -1;
+    }
+    printf("Packed %d processes: %s %lld bytes -> %s %lld bytes (%.1fx smaller)\n",
+           num_processes, source, (long long)in.st_size, path, (long long)out.st_size,
+           out.st_size > 0 ? (double)in.st_size / out.st_size : 0.0);
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// Reading
+// ---------------------------------------------------------------------------
+
+typedef struct Cursor
+{
+    const unsigned char *p;
+    const unsigned char *end;
+} Cursor;
+
+static int get_varint(Cursor *c, uint64_t *out)
+{
+    uint64_t v = 0;
+    for (int shift = 0; shift < 64 && c->p < c->end; shift += 7)
+    {
+        unsigned char byte = *c->p++;
+        v |= (uint64_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+        {
+            *out = v;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+// Same, straight from the file (header and block lengths)
+static int read_varint(FILE *f, uint64_t *out)
+{
+    uint64_t v = 0;
+    int c;
+    for (int shift = 0; shift < 64 && (c = fgetc(f)) != EOF; shift += 7)
+    {
+        v |= (uint64_t)(c & 0x7f) << shift;
+        if (!(c & 0x80))
+        {
+            *out = v;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static inline uint64_t load64(const unsigned char *p)
+{
+    uint64_t v;
+    memcpy(&v, p, 8);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+    return v;
+}
+
+//* n values of `width` bits after base. Every value is one unaligned word
+// load, a shift and a mask: no branch on the data, so the loop unrolls and
+// vectorizes. Reads up to 8 bytes past the packed bits (LOAD_SLACK).
+static void unpack(const unsigned char *in, int width, uint64_t base, int n, uint64_t *out)
+{
+    if (width <= 56)
+    {
+        uint64_t mask = (UINT64_C(1) << width) - 1;
+        for (int i = 0; i < n; i++)
+        {
+            size_t bit = (size_t)i * width;
+            out[i] = base + ((load64(in + bit / 8) >> (bit % 8)) & mask);
+        }
+        return;
+    }
+
+    //* Wider values can spill into a ninth byte
+    uint64_t mask = width == 64 ? ~UINT64_C(0) : (UINT64_C(1) << width) - 1;
+    for (int i = 0; i < n; i++)
+    {
+        size_t bit = (size_t)i * width;
+        int shift = (int)(bit % 8);
+        uint64_t v = load64(in + bit / 8) >> shift;
+        if (shift > 0)
+            v |= (uint64_t)in[bit / 8 + 8] << (64 - shift);
+        out[i] = base + (v & mask);
+    }
+}
+
+static int get_column(Cursor *c, int n, uint64_t *out)
+{
+    uint64_t base;
+    if (get_varint(c, &base) != 0 || c->p == c->end)
+        return -1;
+    int width = *c->p++;
+    if (width > 64)
+        return -1;
+    size_t bytes = ((size_t)n * width + 7) / 8;
+    if (bytes > (size_t)(c->end - c->p))
+        return -1;
+    unpack(c->p, width, base, n, out);
+    c->p += bytes;
+    return 0;
+}
+
+typedef struct Loader
+{
+    const char *path;
+    FILE *file;
+    int devices[MAX_DEVICES];   // table position -> device index
+    int num_devices;
+    CpuGroup *groups[MAX_GROUPS];
+    int num_groups;
+
+    //* Decoding scratch
+    unsigned char *payload;
+    size_t payload_capacity;
+    uint64_t *columns;          // arrival, bursts and flags, PACK_BLOCK each
+    uint64_t *bursts;           // cpu, then io
+    size_t bursts_capacity;
+
+    const char *prev_pid;
+    sim_time_t prev_arrival;
+} Loader;
+
+// A name from the header into buf (NAME_MAX_LEN + 1 bytes)
+static int read_name(FILE *f, char *buf)
+{
+    uint64_t len;
+    if (read_varint(f, &len) != 0 || len > NAME_MAX_LEN || fread(buf, 1, len, f) != len)
+        return -1;
+    buf[len] = '\0';
+    return 0;
+}
+
+static int read_header(Loader *l, uint64_t *count)
+{
+    char magic[4];
+    uint64_t tick, num;
+    char name[NAME_MAX_LEN + 1];
+
+    if (fread(magic, 1, 4, l->file) != 4 || memcmp(magic, PACK_MAGIC, 4) != 0 ||
+        fgetc(l->file) != PACK_VERSION || read_varint(l->file, &tick) != 0 ||
+        read_varint(l->file, count) != 0 || *count > __INT_MAX__)
+    {
+        fprintf(stderr, "%s: not a packed workload\n", l->path);
+        return -1;
+    }
+    if ((int64_t)tick != sim_tick_ns)
+    {
+        fprintf(stderr, "%s: packed at a %" PRIu64 "ns tick, this run uses %" PRId64 "ns (--tick)\n",
+                l->path, tick, sim_tick_ns);
+        return -1;
+    }
+
+    if (read_varint(l->file, &num) != 0 || num > MAX_DEVICES)
+        goto corrupt;
+    l->num_devices = (int)num;
+    for (int i = 0; i < l->num_devices; i++)
+    {
+        if (read_name(l->file, name) != 0)
+            goto corrupt;
+        if ((l->devices[i] = io_find_device(name)) < 0)
+        {
+            fprintf(stderr, "unknown device '%s' (declare it with --devices)\n", name);
+            return -1;
+        }
+    }
+
+    if (read_varint(l->file, &num) != 0 || num > MAX_GROUPS)
+        goto corrupt;
+    l->num_groups = (int)num;
+    for (int i = 0; i < l->num_groups; i++)
+    {
+        if (read_name(l->file, name) != 0)
+            goto corrupt;
+        if ((l->groups[i] = group_find(name)) == NULL)
+        {
+            fprintf(stderr, "unknown group '%s' (declare it with --groups)\n", name);
+            return -1;
+        }
+    }
+    return 0;
+
+corrupt:
+    fprintf(stderr, "%s: corrupt header\n", l->path);
+    return -1;
+}
+
+// One process's extras; 0 on success
+static int decode_extras(Loader *l, Cursor *c, Process *p, int flags)
+{
+    uint64_t v, spread;
+
+    for (int b = 0; b < p->num_bursts - 1 && (flags & PACK_TAGGED); b++)
+    {
+        if (get_varint(c, &v) != 0 || v >= (uint64_t)l->num_devices)
+            return -1;
+        p->io_devices[b] = l->devices[v];
+        if (get_varint(c, &v) != 0 || v > __INT_MAX__)
+            return -1;
+        p->io_positions[b] = (int)v;
+    }
+    if (flags & PACK_PRIO)
+    {
+        if (get_varint(c, &v) != 0 || v >= PRIORITY_LEVELS)
+            return -1;
+        p->priority = (int)v;
+    }
+    if (flags & PACK_GROUP)
+    {
+        if (get_varint(c, &v) != 0 || v == 0 || v > (uint64_t)l->num_groups)
+            return -1;
+        p->group = l->groups[v - 1];
+    }
+    if (flags & PACK_JOB)
+    {
+        if (get_varint(c, &v) != 0 || v == 0 || v > __INT_MAX__)
+            return -1;
+        p->job = (int)v;
+    }
+    if (flags & PACK_NODE)
+    {
+        if (get_varint(c, &v) != 0 || v >= NUMA_MAX_NODES)
+            return -1;
+        p->home_node = (int)v;
+    }
+    if (flags & PACK_DIST)
+    {
+        if (get_varint(c, &v) != 0 || v < DIST_FIXED || v > DIST_NORMAL ||
+            get_varint(c, &spread) != 0 || spread > 100)
+            return -1;
+        p->dist = (int)v;
+        p->dist_spread = (int)spread;
+    }
+    return 0;
+}
+
+// n processes from the payload in l->payload into block[], which is zeroed.
+// On failure block[0 .. n) may hold partly built processes.
+static int decode_block(Loader *l, size_t len, Process *block, int n)
+{
+    Cursor c = {l->payload, l->payload + len};
+    uint64_t v, rest;
+
+    for (int i = 0; i < n; i++)
+    {
+        size_t prev_len = strlen(l->prev_pid);
+        if (get_varint(&c, &v) != 0 || v > prev_len ||
+            get_varint(&c, &rest) != 0 || rest > (uint64_t)(c.end - c.p))
+            return -1;
+        char *pid = malloc(v + rest + 1);
+        memcpy(pid, l->prev_pid, v);
+        memcpy(pid + v, c.p, rest);
+        pid[v + rest] = '\0';
+        c.p += rest;
+        block[i].pid = pid;
+        l->prev_pid = pid;
+    }
+
+    uint64_t *arrival = l->columns;
+    uint64_t *bursts = l->columns + PACK_BLOCK;
+    uint64_t *flags = l->columns + 2 * PACK_BLOCK;
+    if (get_column(&c, n, arrival) != 0 || get_column(&c, n, bursts) != 0)
+        return -1;
+
+    size_t total_cpu = 0;
+    for (int i = 0; i < n; i++)
+    {
+        if (bursts[i] < 1 || bursts[i] > PACK_MAX_BURSTS)
+            return -1;
+        total_cpu += bursts[i];
+    }
+    size_t total_io = total_cpu - n;
+    if (total_cpu + total_io > l->bursts_capacity)
+    {
+        l->bursts_capacity = total_cpu + total_io;
+        l->bursts = realloc(l->bursts, l->bursts_capacity * sizeof(uint64_t));
+    }
+    uint64_t *cpu = l->bursts;
+    uint64_t *io = l->bursts + total_cpu;
+    if (get_column(&c, (int)total_cpu, cpu) != 0 || get_column(&c, (int)total_io, io) != 0 ||
+        get_column(&c, n, flags) != 0)
+        return -1;
+
+    for (int i = 0; i < n; i++)
+    {
+        Process *p = &block[i];
+        p->home_node = -1;
+        p->arrival_time = l->prev_arrival + unzigzag(arrival[i]);
+        l->prev_arrival = p->arrival_time;
+        if (p->arrival_time < 0 || flags[i] > PACK_ALL_FLAGS)
+            return -1;
+
+        p->num_bursts = (int)bursts[i];
+        p->cpu_bursts = malloc(p->num_bursts * sizeof(sim_time_t));
+        if (p->num_bursts > 1)
+        {
+            p->io_times = malloc((p->num_bursts - 1) * sizeof(sim_time_t));
+            p->io_devices = calloc(p->num_bursts - 1, sizeof(int));
+            p->io_positions = calloc(p->num_bursts - 1, sizeof(int));
+        }
+
+        for (int b = 0; b < p->num_bursts; b++)
+        {
+            if (*cpu < 1 || *cpu > INT64_MAX)
+                return -1;
+            p->cpu_bursts[b] = (sim_time_t)*cpu++;
+            if (b < p->num_bursts - 1)
+            {
+                if (*io > INT64_MAX)
+                    return -1;
+                p->io_times[b] = (sim_time_t)*io++;
+            }
+        }
+
+        if (decode_extras(l, &c, p, (int)flags[i]) != 0)
+            return -1;
+
+        workload_set_service(p);
+        p->current_burst = 0;
+        p->remaining_time = p->cpu_bursts[0];
+        p->state = READY;
+        p->io_end_time = -1;
+        p->last_cpu = -1;
+    }
+
+    return c.p == c.end ? 0 : -1;
+}
+
+int packed_detect(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    if (f == NULL)
+        return 0;
+    char magic[4];
+    int packed = fread(magic, 1, 4, f) == 4 && memcmp(magic, PACK_MAGIC, 4) == 0;
+    fclose(f);
+    return packed;
+}
+
+int packed_load(const char *path, Process **processes, int *num_processes)
+{
+    Loader l = {.path = path, .prev_pid = ""};
+    if ((l.file = fopen(path, "rb")) == NULL)
+    {
+        perror(path);
+        return -1;
+    }
+
+    uint64_t count;
+    if (read_header(&l, &count) != 0)
+    {
+        fclose(l.file);
+        return -1;
+    }
+
+    //* One block at a time: the list grows as blocks decode, so a corrupt
+    //* count cannot make it allocate more than the file holds
+    Process *list = NULL;
+    int loaded = 0, decoded = 0, capacity = 0;
+    l.columns = malloc(3 * PACK_BLOCK * sizeof(uint64_t));
+    int status = 0;
+
+    while ((uint64_t)loaded < count)
+    {
+        int n = count - loaded < PACK_BLOCK ? (int)(count - loaded) : PACK_BLOCK;
+        uint64_t len;
+        if (read_varint(l.file, &len) != 0 || len > ((uint64_t)1 << 40))
+        {
+            status = -1;
+            break;
+        }
+        if (len + LOAD_SLACK > l.payload_capacity)
+        {
+            l.payload_capacity = len + LOAD_SLACK;
+            l.payload = realloc(l.payload, l.payload_capacity);
+        }
+        memset(l.payload + len, 0, LOAD_SLACK);
+        if (fread(l.payload, 1, len, l.file) != len)
+        {
+            status = -1;
+            break;
+        }
+
+        if (loaded + n > capacity)
+        {
+            capacity = capacity ? capacity * 2 : PACK_BLOCK;
+            if (capacity < loaded + n)
+                capacity = loaded + n;
+            list = realloc(list, capacity * sizeof(Process));
+        }
+        memset(list + loaded, 0, n * sizeof(Process));
+        status = decode_block(&l, len, list + loaded, n);
+        loaded += n;
+        if (status != 0)
+            break;
+        decoded = loaded;
+    }
+
+    if (status == 0 && fgetc(l.file) != EOF)
+        status = -1;
+    if (status != 0)
+    {
+        fprintf(stderr, "%s: corrupt or truncated block after %d processes\n", path, decoded);
+        free_workload(list, loaded);
+        list = NULL;
+    }
+    else if (loaded == 0)
+    {
+        fprintf(stderr, "%s: workload has no processes\n", path);
+        free(list);
+        status = -1;
+    }
+
+    free(l.columns);
+    free(l.bursts);
+    free(l.payload);
+    fclose(l.file);
+
+    if (status != 0)
+        return -1;
+    *processes = list;
+    *num_processes = loaded;
+    return 0;
+}
@@ -0,0 +1,59 @@
+#ifndef PACKED_H
+#define PACKED_H
+
+#include "process.h"
+
+//* Packed binary workloads (--pack-workload)
+//
+// A compact stand-in for the text workload format, for large stored
+// traces. load_workload() recognizes it by its magic and reads it
+// instead of parsing text; everything else treats it as the same
+// workload.
+//
+// File layout:
+//   "SCHW" <version byte> <varint tick ns> <varint num_processes>
+//   <varint num_devices> { <varint len> <device name> }...
+//   <varint num_groups> { <varint len> <group path> }...
+//   then blocks of PACK_BLOCK processes (the last may be shorter):
+//   <varint payload bytes> <payload>
+//
+// A payload stores its processes column by column:
+//
+//   pids      <varint prefix shared with the previous pid> <varint len> <rest>
+//   arrival   zig-zag delta from the previous process's arrival
+//   bursts    CPU bursts per process
+//   cpu       every CPU burst of the block, in order
+//   io        every I/O time of the block, in order
+//   flags     which of the extras below a process has
+//
+// each of the last five frame-of-reference packed: <varint minimum>
+// <width byte> then every value minus the minimum in `width` bits, LSB
+// first. Burst lengths repeat and cluster, so most columns need a few bits
+// per value, and the whole width-0 column of a constant costs two bytes.
+// Then, in process order, varints for what the flags say: device index
+// (into the table above) and seek position per I/O burst; prio; group
+// (1-based, 0 = root); job; node; dist and its spread.
+//
+// Loading reads one block at a time and unpacks each column with a fixed
+// shift-and-mask per value from an unaligned 64-bit load, no branches per
+// value, which compilers unroll and vectorize. Times are ticks at the
+// --tick the file was packed with; loading it at another tick is an
+// error.
+
+#define PACK_MAGIC "SCHW"
+#define PACK_VERSION 1
+#define PACK_BLOCK 256              // processes per block
+#define PACK_MAX_BURSTS (1 << 16)   // CPU bursts per process, sanity limit on load
+
+// Nonzero if path starts with the packed magic
+int packed_detect(const char *path);
+
+// Returns 0 on success; on error says why and returns -1
+int packed_load(const char *path, Process **processes, int *num_processes);
+int packed_write(const char *path, const Process processes[], int num_processes);
+
+// --pack-workload: packed_write() the processes loaded from source and
+// print both file sizes
+int packed_convert(const char *source, const char *path, const Process processes[], int num_processes);
+
+#endif
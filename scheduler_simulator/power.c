@@ -0,0 +1,331 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "power.h"
+#include "cost.h"
+
+typedef struct IdleState
+{
+    const char *name;
+    const char *label;      // for the IDLE trace line
+    double power;           // W
+    int64_t exit_latency;   // ns
+    int64_t target_residency; // ns of idle before it pays off
+} IdleState;
+
+static const IdleState idle_states[POWER_IDLE_STATES] = {
+    {"C1", "(C1) ", 0.30, 0, 0},
+    {"C3", "(C3) ", 0.10, 1 * SIM_NS_PER_MS, 5 * SIM_NS_PER_MS},
+    {"C6", "(C6) ", 0.02, 3 * SIM_NS_PER_MS, 20 * SIM_NS_PER_MS},
+};
+
+//* The above and POWER_SAMPLE_NS in ticks of this run, set by power_configure()
+static sim_time_t exit_ticks[POWER_IDLE_STATES];
+static sim_time_t residency_ticks[POWER_IDLE_STATES];
+static sim_time_t sample_ticks = 1;
+
+static const char *governor_names[] = {"performance", "powersave", "ondemand", "schedutil", "race"};
+
+int power_enabled = 0;
+static governor_t governor = GOV_SCHEDUTIL;
+static double frequencies[POWER_MAX_LEVELS] = {1.2, 1.8, 2.4, 3.0};
+static double ratio[POWER_MAX_LEVELS];      // f / f_max
+static double busy_power[POWER_MAX_LEVELS]; // W
+static int num_levels = 4;
+
+static PowerCpu cpus[COST_MAX_CPUS];
+
+//* Last run, filled by power_finish()
+static int run_cpus = 0;
+static sim_time_t run_end = 0;
+
+static int initial_level(void)
+{
+    return governor == GOV_POWERSAVE ? 0 : num_levels - 1;
+}
+
+void power_reset(void)
+{
+    memset(cpus, 0, sizeof(cpus));
+    for (int i = 0; i < COST_MAX_CPUS; i++)
+    {
+        cpus[i].level = initial_level();
+        cpus[i].idle = 1;
+        cpus[i].last_busy = -1;
+    }
+    run_cpus = 0;
+    run_end = 0;
+}
+
+int power_configure(const char *spec)
+{
+    static const double default_frequencies[] = {1.2, 1.8, 2.4, 3.0};
+
+    power_enabled = 0;
+    if (spec == NULL)
+        return 0;
+
+    char buffer[256];
+    snprintf(buffer, sizeof(buffer), "%s", spec);
+
+    char *levels = strchr(buffer, ':');
+    if (levels != NULL)
+        *levels++ = '\0';
+
+    int g = 0;
+    while (g < GOV_RACE + 1 && strcmp(buffer, governor_names[g]) != 0)
+        g++;
+    if (g == GOV_RACE + 1)
+    {
+        printf("--dvfs: unknown governor '%s' (performance, powersave, ondemand, schedutil, race)\n", buffer);
+        return -1;
+    }
+    governor = (governor_t)g;
+
+    num_levels = 4;
+    memcpy(frequencies, default_frequencies, sizeof(default_frequencies));
+
+    if (levels != NULL)
+    {
+        num_levels = 0;
+        for (char *f = strtok(levels, ","); f != NULL; f = strtok(NULL, ","))
+        {
+            double ghz = atof(f);
+            if (num_levels == POWER_MAX_LEVELS || ghz <= 0 ||
+                (num_levels > 0 && ghz <= frequencies[num_levels - 1]))
+            {
+                printf("--dvfs takes up to %d ascending frequencies in GHz\n", POWER_MAX_LEVELS);
+                return -1;
+            }
+            frequencies[num_levels++] = ghz;
+        }
+        if (num_levels == 0)
+        {
+            printf("--dvfs takes up to %d ascending frequencies in GHz\n", POWER_MAX_LEVELS);
+            return -1;
+        }
+    }
+
+    for (int l = 0; l < num_levels; l++)
+    {
+        ratio[l] = frequencies[l] / frequencies[num_levels - 1];
+        busy_power[l] = POWER_STATIC + POWER_DYNAMIC * ratio[l] * ratio[l] * ratio[l];
+    }
+
+    for (int s = 0; s < POWER_IDLE_STATES; s++)
+    {
+        exit_ticks[s] = sim_ns_to_ticks(idle_states[s].exit_latency);
+        residency_ticks[s] = sim_ns_to_ticks(idle_states[s].target_residency);
+    }
+    sample_ticks = sim_ns_to_ticks(POWER_SAMPLE_NS);
+
+    power_enabled = 1;
+    power_reset();
+    return 0;
+}
+
+// Lowest level at or above the wanted fraction of the top frequency
+static int level_for(double wanted)
+{
+    int l = 0;
+    while (l < num_levels - 1 && ratio[l] < wanted)
+        l++;
+    return l;
+}
+
+static void govern(PowerCpu *c, sim_time_t current_time)
+{
+    sim_time_t elapsed = current_time - c->window_start;
+    if (elapsed < sample_ticks)
+        return;
+
+    double load = (double)c->window_busy / elapsed;
+    double util = c->window_work / elapsed;
+
+    switch (governor)
+    {
+    case GOV_PERFORMANCE:
+    case GOV_RACE:
+        c->level = num_levels - 1;
+        break;
+    case GOV_POWERSAVE:
+        c->level = 0;
+        break;
+    case GOV_ONDEMAND:
+        c->level = load > 0.8 ? num_levels - 1 : level_for(ratio[0] + (1.0 - ratio[0]) * load);
+        break;
+    case GOV_SCHEDUTIL:
+        c->level = level_for(1.25 * util);
+        break;
+    }
+
+    c->window_start = current_time;
+    c->window_busy = 0;
+    c->window_work = 0.0;
+}
+
+static void enter_idle(PowerCpu *c, sim_time_t current_time)
+{
+    c->idle = 1;
+    c->idle_since = current_time;
+    c->wake_left = 0;
+
+    // Deepest state whose target residency the predicted idle time covers
+    int s = POWER_IDLE_STATES - 1;
+    if (governor != GOV_RACE)
+    {
+        while (s > 0 && residency_ticks[s] > c->predicted_idle)
+            s--;
+    }
+    c->idle_state = s;
+}
+
+static void leave_idle(PowerCpu *c, sim_time_t current_time)
+{
+    sim_time_t idle_ticks = current_time - c->idle_since;
+
+    c->energy += idle_ticks * idle_states[c->idle_state].power;
+    c->idle_ticks[c->idle_state] += idle_ticks;
+    c->predicted_idle = (c->predicted_idle + idle_ticks) / 2;
+    c->idle = 0;
+
+    if (c->last_busy >= 0)
+    {
+        c->wakeups++;
+        c->wake_left = exit_ticks[c->idle_state];
+    }
+}
+
+int power_account(int cpu, int busy, sim_time_t current_time)
+{
+    PowerCpu *c = &cpus[cpu];
+
+    if (!busy)
+    {
+        if (!c->idle)
+            enter_idle(c, current_time);
+        return POWER_RUN;
+    }
+
+    if (c->idle)
+        leave_idle(c, current_time);
+    govern(c, current_time);
+
+    c->last_busy = current_time;
+    c->busy_ticks++;
+    c->level_ticks[c->level]++;
+    c->window_busy++;
+    c->energy += busy_power[c->level];
+
+    if (c->wake_left > 0)
+    {
+        c->wake_left--;
+        c->wake_ticks++;
+        return POWER_WAKING;
+    }
+
+    c->window_work += ratio[c->level];
+    c->credit += ratio[c->level];
+    if (c->credit < 1.0 - 1e-9)
+        return POWER_SLOW;
+    c->credit -= 1.0;
+    return POWER_RUN;
+}
+
+const char *power_idle_name(int cpu)
+{
+    return power_enabled && cpus[cpu].idle ? idle_states[cpus[cpu].idle_state].label : "";
+}
+
+double power_frequency(int cpu)
+{
+    return frequencies[cpus[cpu].level];
+}
+
+void power_finish(int num_cpus)
+{
+    if (!power_enabled)
+        return;
+
+    sim_time_t end = 0;
+    for (int i = 0; i < num_cpus; i++)
+    {
+        if (cpus[i].last_busy + 1 > end)
+            end = cpus[i].last_busy + 1;
+    }
+
+    for (int i = 0; i < num_cpus; i++)
+    {
+        PowerCpu *c = &cpus[i];
+        if (!c->idle)
+            enter_idle(c, c->last_busy + 1);
+        if (end > c->idle_since)
+        {
+            c->energy += (end - c->idle_since) * idle_states[c->idle_state].power;
+            c->idle_ticks[c->idle_state] += end - c->idle_since;
+            c->idle_since = end;
+        }
+    }
+
+    run_cpus = num_cpus;
+    run_end = end;
+}
+
+double power_energy(void)
+{
+    if (!power_enabled)
+        return 0.0;
+
+    double energy = 0.0;
+    for (int i = 0; i < run_cpus; i++)
+        energy += cpus[i].energy;
+    return energy * sim_tick_ms() / 1000.0;
+}
+
+double power_average(void)
+{
+    return run_end > 0 ? power_energy() * 1000.0 / (run_end * sim_tick_ms()) : 0.0;
+}
+
+void power_report(void)
+{
+    if (!power_enabled || run_cpus == 0)
+        return;
+
+    long busy = 0, wakeups = 0, wake_ticks = 0;
+    long level_ticks[POWER_MAX_LEVELS] = {0};
+    long idle_ticks[POWER_IDLE_STATES] = {0};
+
+    for (int i = 0; i < run_cpus; i++)
+    {
+        PowerCpu *c = &cpus[i];
+        busy += c->busy_ticks;
+        wakeups += c->wakeups;
+        wake_ticks += c->wake_ticks;
+        for (int l = 0; l < num_levels; l++)
+            level_ticks[l] += c->level_ticks[l];
+        for (int s = 0; s < POWER_IDLE_STATES; s++)
+            idle_ticks[s] += c->idle_ticks[s];
+    }
+
+    long idle = 0;
+    for (int s = 0; s < POWER_IDLE_STATES; s++)
+        idle += idle_ticks[s];
+
+    double energy = power_energy();
+
+    printf("\n=== Energy (%s governor, %d CPU%s, 1 tick = %g ms) ===\n",
+           governor_names[governor], run_cpus, run_cpus == 1 ? "" : "s", sim_tick_ms());
+    printf("  energy:          %.3f J\n", energy);
+    printf("  average power:   %.3f W over %" PRIdTIME " ticks\n", power_average(), run_end);
+    printf("  energy x delay:  %.3f J*s\n", energy * run_end * sim_tick_ms() / 1000.0);
+    printf("  busy:            %ld CPU ticks, %ld waking from idle (%ld wakeups)\n", busy, wake_ticks, wakeups);
+    printf("  frequency:      ");
+    for (int l = 0; l < num_levels; l++)
+        printf(" %.1fGHz %.1f%%", frequencies[l], busy ? 100.0 * level_ticks[l] / busy : 0.0);
+    printf("\n  idle states:    ");
+    for (int s = 0; s < POWER_IDLE_STATES; s++)
+        printf(" %s %.1f%%", idle_states[s].name, idle ? 100.0 * idle_ticks[s] / idle : 0.0);
+    printf("\n");
+}
@@ -0,0 +1,111 @@
+#ifndef POWER_H
+#define POWER_H
+
+#include "process.h"
+
+#define POWER_MAX_LEVELS 8
+#define POWER_SAMPLE_NS (10 * (int64_t)SIM_NS_PER_MS) // governor sampling period
+#define POWER_IDLE_STATES 3     // C1, C3, C6
+
+//* Frequency scaling (DVFS) and idle states
+//
+// Each CPU runs at one of a few frequency levels. CPU bursts are measured
+// at the top frequency: at half of it, a running process needs two ticks
+// per tick of burst, and the ticks that make no progress count as busy.
+// Every POWER_SAMPLE_NS (10 ms) a governor picks the next level from the
+// CPU's recent utilization:
+//
+//   performance  always the top level
+//   powersave    always the lowest level
+//   ondemand     top level above 80% busy, otherwise in proportion to load
+//   schedutil    1.25 x frequency-invariant utilization (work done / time)
+//   race         top level, and straight into the deepest idle state
+//
+// An idle CPU enters an idle state chosen from its predicted idle time (the
+// average of its recent idle periods): the deepest one whose target
+// residency fits. Leaving a state takes its exit latency, during which
+// the CPU is busy but the process makes no progress. Latencies, residencies
+// and the sampling period are real times, converted to ticks of --tick when
+// the run is configured, so a finer tick does not change the model.
+//
+// Power, in watts: a busy CPU draws POWER_STATIC plus POWER_DYNAMIC scaled
+// by (f / f_max)^3 (voltage tracks frequency); an idle one draws its idle
+// state's power. Energy is power x ticks x the tick length (--tick). Idle
+// time is accounted lazily, when the CPU wakes up, so engines that skip
+// idle stretches stay exact. Off unless --dvfs is given.
+
+#define POWER_STATIC 0.5        // W, any frequency
+#define POWER_DYNAMIC 4.0       // W at the top frequency
+
+typedef enum {
+    POWER_RUN, POWER_WAKING, POWER_SLOW
+} power_tick_t;
+
+typedef enum {
+    GOV_PERFORMANCE, GOV_POWERSAVE, GOV_ONDEMAND, GOV_SCHEDUTIL, GOV_RACE
+} governor_t;
+
+typedef struct PowerCpu
+{
+    //* Frequency
+    int level;
+    double credit;          // partial tick of progress; kept across idle and
+                            // process switches, so every busy tick adds to it
+
+    //* Idle
+    int idle;
+    sim_time_t idle_since;
+    int idle_state;
+    sim_time_t wake_left;   // exit-latency ticks still to go
+    sim_time_t predicted_idle;
+
+    //* Governor window
+    sim_time_t window_start;
+    int window_busy;
+    double window_work;     // progress made, in top-frequency ticks
+    sim_time_t last_busy;   // -1 = never busy
+
+    // stats
+    double energy;          // W x ticks
+    long busy_ticks;
+    long level_ticks[POWER_MAX_LEVELS];
+    long idle_ticks[POWER_IDLE_STATES];
+    long wakeups;
+    long wake_ticks;
+} __attribute__((aligned(64))) PowerCpu;
+
+extern int power_enabled;
+
+// "schedutil" or "ondemand:1.2,1.8,2.4,3.0" (frequencies in GHz, ascending;
+// default 1.2,1.8,2.4,3.0), NULL for off. Returns 0 on success.
+int power_configure(const char *spec);
+
+int power_account(int cpu, int busy, sim_time_t current_time);
+
+// Called once per simulated tick for every CPU that has a process on it
+// (busy = 1), and at least on the first tick of an idle stretch (busy = 0).
+// Returns POWER_RUN if the running process makes progress this tick,
+// POWER_WAKING / POWER_SLOW if the CPU is busy without progress.
+static inline int power_tick(int cpu, int busy, sim_time_t current_time)
+{
+    return power_enabled ? power_account(cpu, busy, current_time) : POWER_RUN;
+}
+
+// "(C6) " for an idle CPU's state, "" when DVFS is off
+const char *power_idle_name(int cpu);
+double power_frequency(int cpu);
+
+// Close the idle periods of cpus CPUs at the end of the run
+void power_finish(int cpus);
+
+// Back to idle CPUs at the governor's starting frequency and zeroed stats
+// (between runs)
+void power_reset(void);
+
+// Energy and average power of the last run, 0 if DVFS is off
+double power_energy(void);
+double power_average(void);
+
+void power_report(void);
+
+#endif
@@ -0,0 +1,77 @@
+#include <stdio.h>
+
+#include "predict.h"
+
+static int enabled = 0;
+static double alpha = 0.5;
+static double initial = 5.0;
+
+// absolute prediction error over all completed bursts
+static long observations = 0;
+static double error_sum = 0.0;
+static double actual_sum = 0.0;
+
+void predict_configure(double a, double initial_estimate)
+{
+    enabled = 1;
+    alpha = a;
+    initial = initial_estimate;
+}
+
+void predict_reset(void)
+{
+    enabled = 0;
+    observations = 0;
+    error_sum = 0.0;
+    actual_sum = 0.0;
+}
+
+int predict_enabled(void)
+{
+    return enabled;
+}
+
+static double estimate(const Process *p)
+{
+    // 0 means no burst observed yet (real estimates are always > 0)
+    return p->burst_estimate > 0 ? p->burst_estimate : initial;
+}
+
+double burst_key(const Process *p)
+{
+    if (!enabled)
+        return p->remaining_time;
+
+    sim_time_t ran = p->cpu_bursts[p->current_burst] - p->remaining_time;
+    double left = estimate(p) - ran;
+    return left > 0 ? left : 0.0; // overran its prediction: expected to end any moment
+}
+
+void predict_observe(Process *p)
+{
+    if (!enabled)
+        return;
+
+    double actual = p->cpu_bursts[p->current_burst];
+    double predicted = estimate(p);
+    double error = predicted - actual;
+
+    observations++;
+    error_sum += error < 0 ? -error : error;
+    actual_sum += actual;
+
+    p->burst_estimate = (float)(alpha * actual + (1.0 - alpha) * predicted);
+    p->burst_error = (float)error;
+}
+
+void predict_report(void)
+{
+    if (!enabled || observations == 0)
+        return;
+
+    double mae = error_sum / observations;
+    printf("\n=== Burst Prediction (alpha %.2f, initial %.1f) ===\n", alpha, initial);
+    printf("  bursts observed:      %ld\n", observations);
+    printf("  mean absolute error:  %.2f ticks\n", mae);
+    printf("  relative error:       %.1f%%\n", 100.0 * error_sum / actual_sum);
+}
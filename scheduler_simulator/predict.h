@@ -0,0 +1,29 @@
+#ifndef PREDICT_H
+#define PREDICT_H
+
+#include "process.h"
+
+//* Burst-length prediction by exponential averaging
+//
+//   tau(n+1) = alpha * t(n) + (1 - alpha) * tau(n)
+//
+// where t(n) is the length of the CPU burst that just completed. SJF and
+// STCF order their ready queues by the predicted remaining time
+// (tau - time already run in this burst) instead of the true remaining
+// time, which a real OS cannot know. Off by default.
+
+void predict_configure(double alpha, double initial_estimate);
+// Prediction off and error stats cleared (between runs)
+void predict_reset(void);
+int predict_enabled(void);
+
+// Ordering key for SJF/STCF: predicted remaining time if prediction is
+// on, the true remaining time otherwise
+double burst_key(const Process *p);
+
+// Called when p's current CPU burst completes; O(1)
+void predict_observe(Process *p);
+
+void predict_report(void);
+
+#endif
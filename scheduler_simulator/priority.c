@@ -0,0 +1,475 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "priority.h"
+#include "io_device.h"
+#include "cost.h"
+#include "power.h"
+#include "trace.h"
+#include "group.h"
+#include "profile.h"
+#include "arrivals.h"
+#include "horizon.h"
+
+#define BUCKET_MASK (PRIORITY_BUCKETS - 1)
+#define BITMAP_WORDS (PRIORITY_BUCKETS / 64)
+
+static int aging = 0; // ticks per priority level, 0 = no aging
+
+void priority_set_aging(int ticks_per_level)
+{
+    aging = ticks_per_level > 0 ? ticks_per_level : 0;
+}
+
+void init_prio_queue(PrioReadyQ *q)
+{
+    memset(q, 0, sizeof(*q));
+    q->base = -(PRIORITY_BUCKETS - PRIORITY_LEVELS);
+}
+
+// First occupied bucket at or after `from`, wrapping around the ring; -1 if none
+static int find_bucket(const PrioReadyQ *q, int from)
+{
+    int w = from / 64;
+    unsigned long long bits = q->occupied[w] & (~0ULL << (from % 64));
+
+    for (int n = 0; n <= BITMAP_WORDS; n++)
+    {
+        if (bits)
+            return w * 64 + __builtin_ctzll(bits);
+        w = (w + 1) % BITMAP_WORDS;
+        bits = q->occupied[w];
+    }
+    return -1;
+}
+
+static int ring_empty(const PrioReadyQ *q)
+{
+    for (int w = 0; w < BITMAP_WORDS; w++)
+    {
+        if (q->occupied[w])
+            return 0;
+    }
+    return 1;
+}
+
+// Move to a new aging epoch. Buckets that fall behind the ring are
+// appended, in key order, to the aged FIFO.
+void prio_advance(PrioReadyQ *q, sim_time_t epoch)
+{
+    sim_time_t new_base = epoch - (PRIORITY_BUCKETS - PRIORITY_LEVELS);
+    q->epoch = epoch;
+
+    while (q->base < new_base)
+    {
+        if (ring_empty(q))
+        {
+            q->base = new_base; // nothing to carry over, jump straight there
+            break;
+        }
+
+        int b = q->base & BUCKET_MASK;
+        if (q->head[b] != NULL)
+        {
+            if (q->aged_tail != NULL)
+                q->aged_tail->next_ready = q->head[b];
+            else
+                q->aged_head = q->head[b];
+            q->aged_tail = q->tail[b];
+            q->head[b] = q->tail[b] = NULL;
+            q->occupied[b / 64] &= ~(1ULL << (b % 64));
+        }
+        q->base++;
+    }
+}
+
+void prio_enqueue(PrioReadyQ *q, Process *p)
+{
+    PROF_COUNT(COUNT_ENQUEUE);
+
+    // base + epoch always lands inside the ring: epoch > base and
+    // priority < PRIORITY_LEVELS
+    p->prio_key = p->priority + q->epoch;
+    p->next_ready = NULL;
+
+    int b = p->prio_key & BUCKET_MASK;
+    if (q->tail[b] != NULL)
+        q->tail[b]->next_ready = p;
+    else
+        q->head[b] = p;
+    q->tail[b] = p;
+    q->occupied[b / 64] |= 1ULL << (b % 64);
+
+    p->in_queue = 1;
+    q->size++;
+}
+
+static Process *prio_peek(const PrioReadyQ *q)
+{
+    if (q->aged_head != NULL)
+        return q->aged_head;
+
+    int b = find_bucket(q, q->base & BUCKET_MASK);
+    return b < 0 ? NULL : q->head[b];
+}
+
+Process *prio_dequeue(PrioReadyQ *q)
+{
+    if (q->size == 0)
+        return NULL;
+
+    PROF_COUNT(COUNT_DEQUEUE);
+
+    Process *p;
+    if (q->aged_head != NULL)
+    {
+        p = q->aged_head;
+        q->aged_head = p->next_ready;
+        if (q->aged_head == NULL)
+            q->aged_tail = NULL;
+    }
+    else
+    {
+        int b = find_bucket(q, q->base & BUCKET_MASK);
+        p = q->head[b];
+        q->head[b] = p->next_ready;
+        if (q->head[b] == NULL)
+        {
+            q->tail[b] = NULL;
+            q->occupied[b / 64] &= ~(1ULL << (b % 64));
+        }
+    }
+
+    p->next_ready = NULL;
+    p->in_queue = 0;
+    q->size--;
+    return p;
+}
+
+int prio_is_empty(PrioReadyQ *q)
+{
+    return q->size == 0;
+}
+
+// Priority the process would be scheduled at right now
+int effective_priority(const PrioReadyQ *q, const Process *p)
+{
+    int e = (int)(p->prio_key - q->epoch);
+    return e > 0 ? e : 0;
+}
+
+void check_arrivals_prio(Process processes[], ArrivalCursor *arrivals, sim_time_t current_time, PrioReadyQ *q)
+{
+    for (int i; (i = arrivals_next(arrivals, processes, current_time)) >= 0; )
+    {
+        if (processes[i].completed_flag == 0)
+        {
+            prio_enqueue(q, &processes[i]);
+        }
+    }
+}
+
+static void print_ready_list(const PrioReadyQ *q, Process *p, sim_time_t current_time)
+{
+    for (; p != NULL; p = p->next_ready)
+        trace_line(TEXT_ITEM_PRIO, p, current_time, effective_priority(q, p), 0);
+}
+
+void print_prio(Process processes[], int num_processes, sim_time_t current_time, Process *running_process, PrioReadyQ *rq, int completed)
+{
+    trace_line(TEXT_TICK, NULL, current_time, 0, 0);
+
+    // Print new arrivals
+    for (int i = 0; i < num_processes; i++)
+    {
+        if (processes[i].arrival_time == current_time)
+        {
+            trace_line(TEXT_ARRIVED_PRIO, &processes[i], current_time, processes[i].priority, 0);
+        }
+    }
+
+    // Print CPU assignment
+    if (running_process == NULL && !prio_is_empty(rq))
+    {
+        Process *next = prio_peek(rq);
+        trace_line(TEXT_ASSIGNED, next, current_time, 0, 0);
+        trace_line(TEXT_PRIORITY, next, current_time, effective_priority(rq, next), 0);
+        trace_line(TEXT_ASSIGNED_REST, next, current_time, next->current_burst, next->remaining_time);
+    }
+
+    // Print execution
+    if (running_process != NULL)
+    {
+        trace_line(TEXT_EXECUTING, running_process, current_time, running_process->remaining_time, 0);
+
+        // Check if this will complete the burst
+        if (running_process->remaining_time == 1)
+        {
+            if (running_process->current_burst == running_process->num_bursts - 1)
+            {
+                trace_line(TEXT_WILL_FINISH, running_process, current_time, 0, 0);
+            }
+            else
+            {
+                sim_time_t io_duration = running_process->io_times[running_process->current_burst];
+                trace_line(TEXT_WILL_IO, running_process, current_time, io_duration, 0);
+            }
+        }
+    }
+    else
+    {
+        trace_line(TEXT_IDLE_NOTE, NULL, current_time, 0, 0);
+    }
+
+    // Print current system state
+    trace_line(TEXT_STATE, NULL, current_time, 0, 0);
+    if (running_process != NULL)
+    {
+        trace_line(TEXT_RUNNING, running_process, current_time, 0, 0);
+        trace_line(TEXT_PRIORITY, running_process, current_time, running_process->priority, 0);
+        trace_line(TEXT_RUNNING_REST, running_process, current_time, running_process->current_burst,
+                   running_process->remaining_time - 1);
+    }
+    else
+    {
+        trace_line(TEXT_RUNNING_NONE, NULL, current_time, 0, 0);
+    }
+
+    //* Ready queue in scheduling order: aged FIFO first, then the ring from base
+    trace_line(TEXT_READY_OPEN, NULL, current_time, 0, 0);
+    print_ready_list(rq, rq->aged_head, current_time);
+    for (int k = 0; k < PRIORITY_BUCKETS; k++)
+    {
+        print_ready_list(rq, rq->head[(rq->base + k) & BUCKET_MASK], current_time);
+    }
+    trace_line(TEXT_CLOSE, NULL, current_time, 0, 0);
+
+    trace_line(TEXT_BLOCKED_OPEN, NULL, current_time, 0, 0);
+    for (int i = 0; i < num_processes; i++)
+    {
+        if (processes[i].state == BLOCKED)
+        {
+            if (io_is_queued(&processes[i]))
+                trace_line(TEXT_ITEM_QUEUED, &processes[i], current_time, 0, 0);
+            else
+                trace_line(TEXT_ITEM_ENDS, &processes[i], current_time, processes[i].io_end_time, 0);
+        }
+    }
+    trace_line(TEXT_CLOSE, NULL, current_time, 0, 0);
+
+    trace_line(TEXT_COMPLETED, NULL, current_time, completed, num_processes);
+}
+
+void priority_schedule(Process processes[], int num_processes, int preemptive)
+{
+    PrioReadyQ rq;
+    init_prio_queue(&rq);
+    ArrivalCursor arrivals;
+    arrivals_begin(&arrivals, processes, num_processes);
+
+    Process *running_process = NULL;
+
+    sim_time_t current_time = 0;
+    int completed = 0;
+
+    // @note
+    //* Advance the aging epoch (lazy: nothing in the queue is touched)
+    //* Check I/O completions (blocked → ready)
+    //* Check new arrivals
+    //* Preemptive variant: preempt if a waiting process now outranks the running one
+    //* Assign CPU if needed
+    //* Execute current running process
+
+    while (completed < num_processes)
+    {
+        PROF_COUNT(COUNT_TICKS);
+        PROF_BEGIN(PHASE_IO);
+
+        //* 0) Advance I/O devices and the aging epoch
+        io_tick(current_time);
+        prio_advance(&rq, aging > 0 ? current_time / aging : 0);
+
+        // Groups whose period rolled over hand their parked processes back
+        Process *released;
+        while ((released = group_release(current_time)) != NULL)
+            prio_enqueue(&rq, released);
+
+        //* 1) Check I/O completions (blocked -> ready)
+        Process *done;
+        while ((done = io_next_done(current_time)) != NULL)
+        { // i/o burst completed
+            int i = done - processes;
+            PROF_COUNT(COUNT_PROCESS_SCAN);
+
+            processes[i].state = READY;
+            trace_event(TRACE_UNBLOCK, i, current_time);
+            processes[i].current_burst++; // Move to next CPU burst
+
+            if (processes[i].current_burst < processes[i].num_bursts)
+            { // More CPU bursts remaining
+
+                processes[i].remaining_time = processes[i].cpu_bursts[processes[i].current_burst];
+
+                if (!processes[i].in_queue)
+                {
+                    prio_enqueue(&rq, &processes[i]);
+                }
+            }
+            else
+            {
+                // No more CPU bursts - process is finished
+                processes[i].state = FINISHED;
+                processes[i].completed_flag = 1;
+                completed++;
+                trace_event(TRACE_FINISH, i, current_time);
+            }
+        }
+
+        PROF_END(PHASE_IO);
+        PROF_BEGIN(PHASE_ARRIVALS);
+
+        //* 2) Check new arrivals
+        check_arrivals_prio(processes, &arrivals, current_time, &rq);
+
+        PROF_END(PHASE_ARRIVALS);
+        PROF_BEGIN(PHASE_SELECT);
+
+        // Park throttled processes at the head so they don't trigger a preemption
+        while (!prio_is_empty(&rq) && group_throttled(prio_peek(&rq)))
+            group_park(prio_dequeue(&rq), current_time);
+
+        //* 3) Preemptive variant: does the best waiting process outrank the running one?
+        if (preemptive && running_process != NULL && !prio_is_empty(&rq))
+        {
+            if (effective_priority(&rq, prio_peek(&rq)) < running_process->priority)
+            {
+                // Preempt: back into the queue at its base priority (aging restarts)
+                running_process->state = READY;
+                prio_enqueue(&rq, running_process);
+                trace_event(TRACE_PREEMPT, running_process - processes, current_time);
+                PROF_COUNT(COUNT_PREEMPT);
+                running_process = NULL;
+            }
+        }
+
+        //* 4) Assign CPU if needed
+        while (running_process == NULL && !prio_is_empty(&rq))
+        {
+            running_process = prio_dequeue(&rq);
+            if (group_throttled(running_process))
+            {
+                // Group is out of quota: the process waits there, try the next one
+                group_park(running_process, current_time);
+                running_process = NULL;
+                continue;
+            }
+            running_process->state = RUNNING;
+            cost_dispatch(running_process, 0, current_time);
+            trace_event(TRACE_DISPATCH, running_process - processes, current_time);
+            PROF_COUNT(COUNT_DISPATCH);
+        }
+
+        PROF_END(PHASE_SELECT);
+        PROF_BEGIN(PHASE_EXECUTE);
+
+        //* 5) Execution
+        int slowed = power_tick(0, running_process != NULL, current_time);
+
+        if (running_process != NULL && slowed != POWER_RUN)
+        {
+            // Waking from an idle state / below top frequency: busy, no progress
+            if (trace_text)
+            {
+                if (slowed == POWER_WAKING)
+                    trace_line(TEXT_WAKING, running_process, current_time, 0, 0);
+                else
+                    trace_line_ghz(TEXT_SLOW, running_process, current_time, power_frequency(0));
+            }
+        }
+        else if (running_process != NULL && cost_stalled(0))
+        {
+            // Context switch / cache refill: CPU busy, process makes no progress
+            if (trace_text)
+            {
+                trace_line(TEXT_SWITCHING, running_process, current_time, 0, 0);
+            }
+        }
+        else if (running_process != NULL)
+        {
+            if (trace_text)
+            {
+                PROF_BEGIN(PHASE_PRINT);
+                print_prio(processes, num_processes, current_time, running_process, &rq, completed);
+                PROF_END(PHASE_PRINT);
+            }
+            //* Up to the next event at once when nothing needs every tick (horizon.h).
+            //* Preemptive: waiting processes may outrank it from the next aging
+            //* epoch on, or already next tick (step 3 compares its base priority)
+            sim_time_t limit = SIM_TIME_MAX;
+            if (preemptive && aging > 0)
+                limit = (current_time / aging + 1) * aging;
+            if (preemptive && !prio_is_empty(&rq) &&
+                effective_priority(&rq, prio_peek(&rq)) < running_process->priority)
+                limit = current_time + 1;
+            sim_time_t run = horizon_run(&arrivals, processes, current_time,
+                                         running_process->remaining_time, limit);
+            PROF_ADD(COUNT_TICKS, run - 1);
+            current_time += run - 1;
+            running_process->last_ran = current_time;
+            running_process->remaining_time -= run;
+            int throttled = group_charge(running_process, current_time);
+
+            // Check if current CPU burst is complete
+            if (running_process->remaining_time == 0)
+            {
+                if (running_process->current_burst == running_process->num_bursts - 1)
+                {
+                    // Process completed all bursts
+                    running_process->state = FINISHED;
+                    running_process->completed_flag = 1;
+                    completed++;
+                    trace_event(TRACE_FINISH, running_process - processes, current_time + 1);
+                    running_process = NULL;
+                }
+                else
+                {
+                    // Move to I/O
+                    running_process->state = BLOCKED;
+                    io_submit(running_process, current_time);
+                    trace_event(TRACE_BLOCK, running_process - processes, current_time + 1);
+                    running_process = NULL;
+                }
+            }
+            else if (throttled)
+            {
+                // Group ran out of quota: off the CPU until its next period
+                running_process->state = READY;
+                group_park(running_process, current_time + 1);
+                trace_event(TRACE_PREEMPT, running_process - processes, current_time + 1);
+                PROF_COUNT(COUNT_PREEMPT);
+                running_process = NULL;
+            }
+        }
+        else
+        {
+            PROF_COUNT(COUNT_IDLE_TICKS);
+            if (trace_text)
+            {
+                trace_line_str(TEXT_IDLE, NULL, current_time, 0, power_idle_name(0));
+            }
+
+            // Idle until the next event (horizon.h)
+            sim_time_t last = horizon_idle(&arrivals, processes, current_time);
+            PROF_ADD(COUNT_TICKS, last - current_time);
+            PROF_ADD(COUNT_IDLE_TICKS, last - current_time);
+            current_time = last;
+        }
+
+        PROF_END(PHASE_EXECUTE);
+
+        current_time++;
+        progress_tick(current_time, completed);
+    }
+
+    arrivals_end(&arrivals);
+}
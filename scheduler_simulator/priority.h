@@ -0,0 +1,40 @@
+#ifndef PRIORITY_H
+#define PRIORITY_H
+
+#include "process.h"
+
+#define PRIORITY_LEVELS 64      // priorities 0 (highest) .. 63
+#define PRIORITY_BUCKETS 128    // power of two, > PRIORITY_LEVELS
+
+//* Ready queue for priority scheduling with aging
+//
+// A process waiting in the ready queue gains one priority level per aging
+// epoch (aging ticks). Instead of touching every waiting process when an
+// epoch passes, each one is filed under a fixed key when enqueued:
+//
+//   key = base priority + epoch at enqueue
+//
+// so its effective priority at any later epoch E is max(0, key - E), and the
+// order of keys never changes. Keys live in a ring of buckets (FIFO lists)
+// with an occupancy bitmap; keys that fall behind the ring have effective
+// priority 0 and move, in key order, to the "aged" FIFO. Enqueue, dequeue
+// and peek are O(1); advancing an epoch moves at most one bucket per epoch.
+typedef struct PrioReadyQ
+{
+    Process *head[PRIORITY_BUCKETS];
+    Process *tail[PRIORITY_BUCKETS];
+    unsigned long long occupied[PRIORITY_BUCKETS / 64];
+
+    Process *aged_head;     // keys below base, effective priority 0
+    Process *aged_tail;
+
+    sim_time_t base;        // smallest key the ring holds
+    sim_time_t epoch;
+    int size;
+} PrioReadyQ;
+
+void priority_set_aging(int ticks_per_level);
+
+void priority_schedule(Process processes[], int num_processes, int preemptive);
+
+#endif
@@ -1,6 +1,8 @@
 #ifndef PROCESS_H
 #define PROCESS_H
 
+#include "simtime.h"
+
 typedef enum {
     READY, RUNNING, BLOCKED, FINISHED
 } process_state_t;
@@ -8,16 +10,53 @@ typedef enum {
 typedef struct Process
 {
     char *pid;
-    int arrival_time;
+    sim_time_t arrival_time;
     
     //* I/O support
-    int *cpu_bursts;        // array of CPU burst lengths [3, 4, 2]
-    int *io_times;          // array of I/O times [2, 1] 
+    sim_time_t *cpu_bursts; // array of CPU burst lengths [3, 4, 2]
+    sim_time_t *io_times;   // array of I/O times [2, 1] 
     int num_bursts;         // total number of CPU bursts
     int current_burst;      // which CPU burst we're currently on (0, 1, 2...)
-    int remaining_time;     // time left in current CPU burst
+    sim_time_t remaining_time; // time left in current CPU burst
     process_state_t state;  // current process state
-    int io_end_time;        // when current I/O will complete
+    sim_time_t io_end_time; // when current I/O will complete
+    int *io_devices;        // device index per I/O burst (NULL = default device)
+    int *io_positions;      // seek position per I/O burst, used by elevator queues
+
+    //* Cache affinity
+    int last_cpu;           // CPU it last ran on (-1 = never ran)
+    sim_time_t last_ran;    // last tick it executed
+
+    //* Burst prediction (exponential averaging)
+    float burst_estimate;   // predicted length of the next CPU burst (0 = no history)
+    float burst_error;      // predicted - actual for the last completed burst
+
+    //* Priority scheduling
+    int priority;           // base priority from the workload, 0 = highest
+    sim_time_t prio_key;    // base priority + aging epoch at enqueue
+    struct Process *next_ready; // link in the bucketed priority ready queue / a group's parked list
+
+    //* Keyed ready queue (SJF / STCF)
+    struct Process *rq_prev, *rq_next; // push order, see readyq.h
+
+    //* CPU bandwidth control
+    struct CpuGroup *group; // NULL = root group
+
+    //* Gang scheduling
+    int job;                // parallel job this thread belongs to (0 = a job of its own)
+
+    //* NUMA
+    int home_node;          // memory node (-1 = the node it first runs on)
+
+    //* Monte Carlo
+    int dist;               // burst distribution, dist_t (0 = --burst-dist)
+    int dist_spread;        // its spread in percent of the mean
+
+    //* Latency metrics (see metrics.h)
+    sim_time_t service;     // sum of the CPU bursts, set when they are loaded or drawn
+    sim_time_t first_run;   // first dispatch, -1 until then
+    sim_time_t ready_since; // when it last became ready
+    sim_time_t wait;        // time spent ready so far
     
     // Existing flags
     int completed_flag;
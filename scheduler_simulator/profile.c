@@ -0,0 +1,83 @@
+#include <stdio.h>
+#include <time.h>
+
+#include "profile.h"
+
+#ifdef SCHED_PROFILE
+
+unsigned long long prof_counters[NUM_COUNTERS];
+unsigned long long prof_phase_time[NUM_PHASES];
+unsigned long long prof_phase_calls[NUM_PHASES];
+
+static const char *phase_names[NUM_PHASES] = {
+    "I/O check", "arrival check", "selection", "execution", "printing"
+};
+
+static const char *counter_names[NUM_COUNTERS] = {
+    "ticks", "idle ticks", "enqueues", "dequeues", "ready-queue scan steps",
+    "process-table scan steps", "dispatches", "preemptions"
+};
+
+static struct timespec wall_start;
+static unsigned long long clock_start;
+
+static double wall_ns_since(struct timespec *from)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - from->tv_sec) * 1e9 + (now.tv_nsec - from->tv_nsec);
+}
+
+void prof_start(void)
+{
+    clock_gettime(CLOCK_MONOTONIC, &wall_start);
+    clock_start = prof_now();
+}
+
+void prof_report(void)
+{
+    double wall_ns = wall_ns_since(&wall_start);
+    unsigned long long clocks = prof_now() - clock_start;
+    double ns_per_clock = clocks ? wall_ns / clocks : 1.0;
+
+    //* Execution includes the printing it triggers; report it exclusive
+    double phase_ns[NUM_PHASES];
+    double total_ns = 0.0;
+    for (int p = 0; p < NUM_PHASES; p++)
+        phase_ns[p] = prof_phase_time[p] * ns_per_clock;
+    phase_ns[PHASE_EXECUTE] -= phase_ns[PHASE_PRINT];
+    for (int p = 0; p < NUM_PHASES; p++)
+        total_ns += phase_ns[p];
+
+    printf("\n=== Profile ===\n");
+    printf("  %-16s %12s %14s %10s %7s\n", "phase", "calls", "total (us)", "ns/call", "share");
+    for (int p = 0; p < NUM_PHASES; p++)
+    {
+        unsigned long long calls = prof_phase_calls[p];
+        printf("  %-16s %12llu %14.1f %10.1f %6.1f%%\n",
+               phase_names[p], calls, phase_ns[p] / 1000.0,
+               calls ? phase_ns[p] / calls : 0.0,
+               total_ns > 0 ? 100.0 * phase_ns[p] / total_ns : 0.0);
+    }
+    printf("  %-16s %12s %14.1f (wall %.1f us)\n", "total", "", total_ns / 1000.0, wall_ns / 1000.0);
+
+    printf("\n  %-26s %14s %12s\n", "counter", "count", "per tick");
+    unsigned long long ticks = prof_counters[COUNT_TICKS];
+    for (int c = 0; c < NUM_COUNTERS; c++)
+    {
+        printf("  %-26s %14llu %12.2f\n", counter_names[c], prof_counters[c],
+               ticks ? (double)prof_counters[c] / ticks : 0.0);
+    }
+}
+
+#else
+
+void prof_start(void)
+{
+}
+
+void prof_report(void)
+{
+}
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+//* Hot-path instrumentation
+//
+// Build with -DSCHED_PROFILE to count queue operations, scan lengths,
+// preemptions and idle ticks, and to time each phase of the tick loop.
+// Without it every PROF_* macro expands to nothing, so the scheduler loops
+// compile exactly as before. Timings use rdtsc on x86-64 (calibrated
+// against clock_gettime at report time), clock_gettime elsewhere.
+
+typedef enum {
+    PHASE_IO,           // io_tick + scan for I/O completions
+    PHASE_ARRIVALS,     // scan for new arrivals
+    PHASE_SELECT,       // preemption check + dispatch
+    PHASE_EXECUTE,      // run one tick (includes PHASE_PRINT)
+    PHASE_PRINT,        // per-tick text trace
+    NUM_PHASES
+} prof_phase_t;
+
+typedef enum {
+    COUNT_TICKS,
+    COUNT_IDLE_TICKS,
+    COUNT_ENQUEUE,
+    COUNT_DEQUEUE,
+    COUNT_QUEUE_SCAN,   // ready-queue entries examined by linear searches
+    COUNT_PROCESS_SCAN, // process-table entries touched by per-tick loops
+    COUNT_DISPATCH,
+    COUNT_PREEMPT,
+    NUM_COUNTERS
+} prof_counter_t;
+
+#ifdef SCHED_PROFILE
+
+extern unsigned long long prof_counters[NUM_COUNTERS];
+extern unsigned long long prof_phase_time[NUM_PHASES];
+extern unsigned long long prof_phase_calls[NUM_PHASES];
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+static inline unsigned long long prof_now(void)
+{
+    return __rdtsc();
+}
+#else
+#include <time.h>
+static inline unsigned long long prof_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+#endif
+
+#define PROF_COUNT(c) (prof_counters[c]++)
+#define PROF_ADD(c, n) (prof_counters[c] += (unsigned long long)(n))
+#define PROF_BEGIN(p) unsigned long long prof_start_##p = prof_now()
+#define PROF_END(p)                                            \
+    do                                                         \
+    {                                                          \
+        prof_phase_time[p] += prof_now() - prof_start_##p;     \
+        prof_phase_calls[p]++;                                 \
+    } while (0)
+
+#else
+
+#define PROF_COUNT(c) ((void)0)
+#define PROF_ADD(c, n) ((void)0)
+#define PROF_BEGIN(p) ((void)0)
+#define PROF_END(p) ((void)0)
+
+#endif
+
+// Starts the calibration clock; call right before the scheduler runs
+void prof_start(void);
+// Prints the profile table (nothing unless built with SCHED_PROFILE)
+void prof_report(void);
+
+#endif
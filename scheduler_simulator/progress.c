@@ -0,0 +1,286 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "progress.h"
+#include "experiment.h"
+
+#define PROGRESS_DEFAULT_INTERVAL 1.0   // --progress-file alone
+
+ProgressCounters *progress = NULL;
+
+static ProgressCounters counters;
+
+//* Sampler state, under lock: the timer thread and --progress-ticks may both sample
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t wake;
+static pthread_t timer;
+static int timer_running = 0;
+static int stopping;
+
+static ProgressConfig config;
+static long total;
+static double start_wall;
+static double last_wall;
+static sim_time_t last_now;
+static long last_events;
+static int status_failed;
+
+void progress_config_defaults(ProgressConfig *c)
+{
+    c->interval = 0;
+    c->every_ticks = 0;
+    c->status_path = NULL;
+}
+
+int progress_parse_option(ProgressConfig *c, int argc, char *argv[], int *i)
+{
+    const char *opt = argv[*i];
+    if (strcmp(opt, "--progress") != 0 && strcmp(opt, "--progress-ticks") != 0 &&
+        strcmp(opt, "--progress-file") != 0)
+        return 0;
+
+    const char *value = option_value(argc, argv, i);
+    if (value == NULL)
+        return -1;
+
+    if (strcmp(opt, "--progress") == 0)
+    {
+        char *end;
+        c->interval = strtod(value, &end);
+        if (*end != '\0' || !(c->interval > 0))
+        {
+            printf("--progress takes a positive number of seconds.\n");
+            return -1;
+        }
+    }
+    else if (strcmp(opt, "--progress-ticks") == 0)
+    {
+        char *end;
+        c->every_ticks = strtoll(value, &end, 10);
+        if (*end != '\0' || c->every_ticks < 1)
+        {
+            printf("--progress-ticks takes a positive tick count.\n");
+            return -1;
+        }
+    }
+    else
+    {
+        c->status_path = value;
+    }
+    return 1;
+}
+
+int progress_enabled(const ProgressConfig *c)
+{
+    return c->interval > 0 || c->every_ticks > 0 || c->status_path != NULL;
+}
+
+// ---------------------------------------------------------------------------
+// Sampling
+// ---------------------------------------------------------------------------
+
+static double wall_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// 2.31M, 45.2k, 870
+static const char *scaled(double v, char *buf, size_t size)
+{
+    if (v >= 1e9)
+        snprintf(buf, size, "%.2fG", v / 1e9);
+    else if (v >= 1e6)
+        snprintf(buf, size, "%.2fM", v / 1e6);
+    else if (v >= 1e3)
+        snprintf(buf, size, "%.1fk", v / 1e3);
+    else
+        snprintf(buf, size, "%.0f", v);
+    return buf;
+}
+
+// h:mm:ss, or m:ss under an hour; "--" if unknown
+static const char *clock_time(double seconds, char *buf, size_t size)
+{
+    if (seconds < 0)
+        return "--";
+    long s = (long)(seconds + 0.5);
+    if (s >= 3600)
+        snprintf(buf, size, "%ld:%02ld:%02ld", s / 3600, s / 60 % 60, s % 60);
+    else
+        snprintf(buf, size, "%ld:%02ld", s / 60, s % 60);
+    return buf;
+}
+
+static void write_status(const char *state, sim_time_t now, long completed, long events,
+                         double elapsed, double tick_rate, double event_rate, double eta)
+{
+    size_t len = strlen(config.status_path);
+    char *tmp = malloc(len + 5);
+    memcpy(tmp, config.status_path, len);
+    memcpy(tmp + len, ".tmp", 5);
+
+    FILE *f = fopen(tmp, "w");
+    if (f != NULL)
+    {
+        fprintf(f, "{\"state\": \"%s\", \"sim_time\": %" PRIdTIME ", \"completed\": %ld, \"total\": %ld, "
+                   "\"events\": %ld, \"elapsed_s\": %.3f, \"ticks_per_s\": %.1f, \"events_per_s\": %.1f, ",
+                state, now, completed, total, events, elapsed, tick_rate, event_rate);
+        if (eta < 0)
+            fprintf(f, "\"eta_s\": null}\n");
+        else
+            fprintf(f, "\"eta_s\": %.1f}\n", eta);
+    }
+
+    if (f == NULL || fclose(f) != 0 || rename(tmp, config.status_path) != 0)
+    {
+        // Once: a status file that cannot be written should not flood stderr
+        if (!status_failed)
+            perror(config.status_path);
+        status_failed = 1;
+    }
+    free(tmp);
+}
+
+// Caller holds lock
+static void sample(int done)
+{
+    sim_time_t now = atomic_load_explicit(&counters.now, memory_order_relaxed);
+    long completed = atomic_load_explicit(&counters.completed, memory_order_relaxed);
+    long events = atomic_load_explicit(&counters.events, memory_order_relaxed);
+    double wall = wall_seconds();
+    double elapsed = wall - start_wall;
+
+    //* Running: rates since the last sample. Done: over the whole run.
+    if (done)
+    {
+        last_wall = start_wall;
+        last_now = 0;
+        last_events = 0;
+    }
+    double span = wall - last_wall;
+    double tick_rate = span > 0 ? (now - last_now) / span : 0;
+    double event_rate = span > 0 ? (events - last_events) / span : 0;
+    double eta = done ? 0 : completed > 0 ? elapsed * (total - completed) / completed : -1;
+    last_wall = wall;
+    last_now = now;
+    last_events = events;
+
+    char ticks[16], evs[16], el[24], left[24];
+    fprintf(stderr, "[progress] %st=%" PRIdTIME "  %ld/%ld done (%.1f%%)  %s ticks/s  %s events/s  elapsed %s",
+            done ? "finished " : "", now, completed, total,
+            total > 0 ? 100.0 * completed / total : 100.0,
+            scaled(tick_rate, ticks, sizeof(ticks)), scaled(event_rate, evs, sizeof(evs)),
+            clock_time(elapsed, el, sizeof(el)));
+    if (!done)
+        fprintf(stderr, "  ETA %s", clock_time(eta, left, sizeof(left)));
+    fprintf(stderr, "\n");
+
+    if (config.status_path != NULL)
+        write_status(done ? "done" : "running", now, completed, events, elapsed, tick_rate, event_rate, eta);
+}
+
+void progress_sample_ticks(sim_time_t now)
+{
+    progress->next_sample = now - now % progress->every + progress->every;
+    pthread_mutex_lock(&lock);
+    sample(0);
+    pthread_mutex_unlock(&lock);
+}
+
+// ---------------------------------------------------------------------------
+// Timer thread
+// ---------------------------------------------------------------------------
+
+static void *timer_main(void *arg)
+{
+    (void)arg;
+    struct timespec when;
+    clock_gettime(CLOCK_MONOTONIC, &when);
+    long step_ns = (long)(config.interval * 1e9);
+
+    pthread_mutex_lock(&lock);
+    while (!stopping)
+    {
+        when.tv_sec += step_ns / 1000000000L;
+        when.tv_nsec += step_ns % 1000000000L;
+        if (when.tv_nsec >= 1000000000L)
+        {
+            when.tv_sec++;
+            when.tv_nsec -= 1000000000L;
+        }
+
+        int rc = 0;
+        while (!stopping && rc != ETIMEDOUT)
+            rc = pthread_cond_timedwait(&wake, &lock, &when);
+        if (!stopping)
+            sample(0);
+    }
+    pthread_mutex_unlock(&lock);
+    return NULL;
+}
+
+int progress_start(const ProgressConfig *c, int num_processes)
+{
+    config = *c;
+    if (config.interval <= 0 && config.every_ticks <= 0)
+        config.interval = PROGRESS_DEFAULT_INTERVAL;
+
+    memset(&counters, 0, sizeof(counters));
+    counters.every = config.every_ticks;
+    counters.next_sample = config.every_ticks;
+    total = num_processes;
+    start_wall = last_wall = wall_seconds();
+    last_now = 0;
+    last_events = 0;
+    status_failed = 0;
+    stopping = 0;
+    progress = &counters;
+
+    if (config.interval > 0)
+    {
+        //* Deadlines on the monotonic clock: wall-clock steps don't bunch samples up
+        pthread_condattr_t attr;
+        pthread_condattr_init(&attr);
+        pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+        pthread_cond_init(&wake, &attr);
+        pthread_condattr_destroy(&attr);
+
+        if (pthread_create(&timer, NULL, timer_main, NULL) != 0)
+        {
+            printf("Could not start the progress thread.\n");
+            pthread_cond_destroy(&wake);
+            progress = NULL;
+            return -1;
+        }
+        timer_running = 1;
+    }
+    return 0;
+}
+
+void progress_stop(void)
+{
+    if (progress == NULL)
+        return;
+
+    if (timer_running)
+    {
+        pthread_mutex_lock(&lock);
+        stopping = 1;
+        pthread_cond_signal(&wake);
+        pthread_mutex_unlock(&lock);
+        pthread_join(timer, NULL);
+        pthread_cond_destroy(&wake);
+        timer_running = 0;
+    }
+
+    pthread_mutex_lock(&lock);
+    sample(1);
+    pthread_mutex_unlock(&lock);
+    progress = NULL;
+}
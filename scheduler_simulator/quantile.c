@@ -0,0 +1,107 @@
+#include "quantile.h"
+
+void p2_init(P2Quantile *s, double p)
+{
+    s->p = p;
+    s->count = 0;
+    for (int i = 0; i < 5; i++)
+    {
+        s->q[i] = 0.0;
+        s->n[i] = i;
+    }
+    s->want[0] = 0.0;
+    s->want[1] = 2.0 * p;
+    s->want[2] = 4.0 * p;
+    s->want[3] = 2.0 + 2.0 * p;
+    s->want[4] = 4.0;
+    s->step[0] = 0.0;
+    s->step[1] = p / 2.0;
+    s->step[2] = p;
+    s->step[3] = (1.0 + p) / 2.0;
+    s->step[4] = 1.0;
+}
+
+// Piecewise-parabolic prediction of marker i moved by d (+1/-1)
+static double parabolic(const P2Quantile *s, int i, double d)
+{
+    const double *q = s->q;
+    const double *n = s->n;
+    return q[i] + d / (n[i + 1] - n[i - 1]) *
+                      ((n[i] - n[i - 1] + d) * (q[i + 1] - q[i]) / (n[i + 1] - n[i]) +
+                       (n[i + 1] - n[i] - d) * (q[i] - q[i - 1]) / (n[i] - n[i - 1]));
+}
+
+static double linear(const P2Quantile *s, int i, int d)
+{
+    return s->q[i] + d * (s->q[i + d] - s->q[i]) / (s->n[i + d] - s->n[i]);
+}
+
+void p2_add(P2Quantile *s, double x)
+{
+    //* Warm-up: collect the first five observations in sorted order
+    if (s->count < 5)
+    {
+        int i = (int)s->count++;
+        while (i > 0 && s->q[i - 1] > x)
+        {
+            s->q[i] = s->q[i - 1];
+            i--;
+        }
+        s->q[i] = x;
+        return;
+    }
+    s->count++;
+
+    //* Find the cell x falls into, stretching the extremes if needed
+    int k;
+    if (x < s->q[0])
+    {
+        s->q[0] = x;
+        k = 0;
+    }
+    else if (x >= s->q[4])
+    {
+        s->q[4] = x;
+        k = 3;
+    }
+    else
+    {
+        k = 0;
+        while (x >= s->q[k + 1])
+            k++;
+    }
+
+    for (int i = k + 1; i < 5; i++)
+        s->n[i] += 1.0;
+    for (int i = 0; i < 5; i++)
+        s->want[i] += s->step[i];
+
+    //* Nudge the three middle markers toward their desired positions
+    for (int i = 1; i <= 3; i++)
+    {
+        double d = s->want[i] - s->n[i];
+        if ((d >= 1.0 && s->n[i + 1] - s->n[i] > 1.0) || (d <= -1.0 && s->n[i - 1] - s->n[i] < -1.0))
+        {
+            int sign = d > 0 ? 1 : -1;
+            double candidate = parabolic(s, i, sign);
+            if (s->q[i - 1] < candidate && candidate < s->q[i + 1])
+                s->q[i] = candidate;
+            else
+                s->q[i] = linear(s, i, sign);
+            s->n[i] += sign;
+        }
+    }
+}
+
+double p2_value(const P2Quantile *s)
+{
+    if (s->count == 0)
+        return 0.0;
+    if (s->count < 5)
+    {
+        // exact: nearest rank over the sorted warm-up samples
+        int rank = (int)(s->p * (s->count - 1) + 0.5);
+        return s->q[rank];
+    }
+    return s->q[2];
+}
@@ -0,0 +1,23 @@
+#ifndef QUANTILE_H
+#define QUANTILE_H
+
+//* P-square streaming quantile estimator (Jain & Chlamtac, 1985)
+//
+// Tracks one quantile with five markers: O(1) memory and O(1) work per
+// observation, no samples stored. Exact for the first five observations.
+
+typedef struct P2Quantile
+{
+    double p;           // target quantile in (0, 1)
+    long count;
+    double q[5];        // marker heights
+    double n[5];        // marker positions
+    double want[5];     // desired marker positions
+    double step[5];     // desired position increments
+} P2Quantile;
+
+void p2_init(P2Quantile *s, double p);
+void p2_add(P2Quantile *s, double x);
+double p2_value(const P2Quantile *s);
+
+#endif
@@ -0,0 +1,643 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <float.h>
+
+#include "readyq.h"
+#include "predict.h"
+#include "profile.h"
+
+static const char *kind_names[RQ_NUM_KINDS] = {
+    "auto", "array", "heap", "pairing", "skiplist", "bucket"
+};
+
+static int configured = RQ_AUTO;
+
+static void *checked(void *ptr)
+{
+    if (ptr == NULL)
+    {
+        fprintf(stderr, "rq: out of memory\n");
+        exit(1);
+    }
+    return ptr;
+}
+
+static inline int before(const RqEntry *a, const RqEntry *b)
+{
+    return a->key < b->key || (a->key == b->key && a->seq < b->seq);
+}
+
+// ---------------------------------------------------------------------------
+// Array (push order, linear scan)
+// ---------------------------------------------------------------------------
+
+static int array_min(const ReadyQueue *q)
+{
+    PROF_ADD(COUNT_QUEUE_SCAN, q->size);
+
+    // Strict <: among equal keys the first one, i.e. the earliest pushed
+    int best = 0;
+    for (int i = 1; i < q->size; i++)
+    {
+        if (q->entries[i].key < q->entries[best].key)
+            best = i;
+    }
+    return best;
+}
+
+static Process *array_pop(ReadyQueue *q)
+{
+    int i = array_min(q);
+    Process *p = q->entries[i].p;
+
+    // Shift the rest left, keeping push order
+    memmove(&q->entries[i], &q->entries[i + 1], (q->size - i - 1) * sizeof(RqEntry));
+    q->size--;
+    return p;
+}
+
+// ---------------------------------------------------------------------------
+// Binary heap
+// ---------------------------------------------------------------------------
+
+static void heap_push(ReadyQueue *q, RqEntry e)
+{
+    int i = q->size++;
+    while (i > 0)
+    {
+        int parent = (i - 1) / 2;
+        if (!before(&e, &q->entries[parent]))
+            break;
+        q->entries[i] = q->entries[parent];
+        i = parent;
+    }
+    q->entries[i] = e;
+}
+
+static Process *heap_pop(ReadyQueue *q)
+{
+    Process *top = q->entries[0].p;
+    RqEntry last = q->entries[--q->size];
+
+    int i = 0;
+    while (1)
+    {
+        int child = 2 * i + 1;
+        if (child >= q->size)
+            break;
+        if (child + 1 < q->size && before(&q->entries[child + 1], &q->entries[child]))
+            child++;
+        if (!before(&q->entries[child], &last))
+            break;
+        q->entries[i] = q->entries[child];
+        i = child;
+    }
+    if (q->size > 0)
+        q->entries[i] = last;
+    return top;
+}
+
+// ---------------------------------------------------------------------------
+// Pairing heap
+// ---------------------------------------------------------------------------
+
+// Both roots (sibling == NULL); the later one becomes the leftmost child
+static RqPairNode *meld(RqPairNode *a, RqPairNode *b)
+{
+    if (before(&b->e, &a->e))
+    {
+        RqPairNode *t = a;
+        a = b;
+        b = t;
+    }
+    b->sibling = a->child;
+    a->child = b;
+    return a;
+}
+
+// Two-pass merge of a sibling list: meld pairs left to right, then fold
+// the results right to left
+static RqPairNode *merge_pairs(RqPairNode *first)
+{
+    RqPairNode *pairs = NULL; // melded pairs, last one first
+
+    while (first != NULL)
+    {
+        RqPairNode *a = first;
+        RqPairNode *b = a->sibling;
+        if (b == NULL)
+        {
+            a->sibling = pairs;
+            pairs = a;
+            break;
+        }
+        first = b->sibling;
+        a->sibling = b->sibling = NULL;
+        RqPairNode *m = meld(a, b);
+        m->sibling = pairs;
+        pairs = m;
+    }
+
+    RqPairNode *root = NULL;
+    while (pairs != NULL)
+    {
+        RqPairNode *next = pairs->sibling;
+        pairs->sibling = NULL;
+        root = root != NULL ? meld(root, pairs) : pairs;
+        pairs = next;
+    }
+    return root;
+}
+
+static void pairing_push(ReadyQueue *q, RqEntry e)
+{
+    RqPairNode *n = q->spare;
+    q->spare = n->sibling;
+    n->e = e;
+    n->child = n->sibling = NULL;
+    q->root = q->root != NULL ? meld(q->root, n) : n;
+    q->size++;
+}
+
+static Process *pairing_pop(ReadyQueue *q)
+{
+    RqPairNode *top = q->root;
+    q->root = merge_pairs(top->child);
+    top->sibling = q->spare;
+    q->spare = top;
+    q->size--;
+    return top->e.p;
+}
+
+// ---------------------------------------------------------------------------
+// Buckets
+// ---------------------------------------------------------------------------
+
+// First non-empty bucket at or after `from`; -1 if none
+static int bucket_find(const ReadyQueue *q, int from)
+{
+    int words = q->num_buckets / 64;
+    int w = from / 64;
+    if (w >= words)
+        return -1;
+
+    uint64_t bits = q->occupied[w] & (~0ULL << (from % 64));
+    if (bits)
+        return w * 64 + __builtin_ctzll(bits);
+
+    // The next non-empty word, from the summary
+    w++;
+    for (int s = w / 64; w < words; s++, w = s * 64)
+    {
+        uint64_t sbits = q->summary[s] & (~0ULL << (w % 64));
+        if (sbits)
+        {
+            w = s * 64 + __builtin_ctzll(sbits);
+            return w * 64 + __builtin_ctzll(q->occupied[w]);
+        }
+    }
+    return -1;
+}
+
+static void bucket_push(ReadyQueue *q, RqEntry e)
+{
+    if (!(e.key < q->num_buckets))
+    {
+        pairing_push(q, e);
+        return;
+    }
+
+    int b = (int)e.key;
+    RqPairNode *n = q->spare;
+    q->spare = n->sibling;
+    n->e = e;
+    n->child = n->sibling = NULL;
+
+    // Appended: a bucket holds equal keys in push order
+    if (q->bucket_tail[b] != NULL)
+        q->bucket_tail[b]->sibling = n;
+    else
+        q->bucket_head[b] = n;
+    q->bucket_tail[b] = n;
+
+    q->occupied[b / 64] |= 1ULL << (b % 64);
+    q->summary[b / 4096] |= 1ULL << (b / 64 % 64);
+    if (b < q->low)
+        q->low = b;
+    q->size++;
+}
+
+static Process *bucket_pop(ReadyQueue *q)
+{
+    if (q->low == q->num_buckets)
+        return pairing_pop(q); // only keys past the buckets left
+
+    int b = q->low;
+    RqPairNode *n = q->bucket_head[b];
+    q->bucket_head[b] = n->sibling;
+    if (q->bucket_head[b] == NULL)
+    {
+        q->bucket_tail[b] = NULL;
+        q->occupied[b / 64] &= ~(1ULL << (b % 64));
+        if (q->occupied[b / 64] == 0)
+            q->summary[b / 4096] &= ~(1ULL << (b / 64 % 64));
+
+        int next = bucket_find(q, b + 1);
+        q->low = next < 0 ? q->num_buckets : next;
+    }
+
+    n->sibling = q->spare;
+    q->spare = n;
+    q->size--;
+    return n->e.p;
+}
+
+// ---------------------------------------------------------------------------
+// Skip list
+// ---------------------------------------------------------------------------
+
+// Geometric height, 1/4 of the nodes reach each next level
+static int skip_height(ReadyQueue *q)
+{
+    q->rng ^= q->rng << 13;
+    q->rng ^= q->rng >> 7;
+    q->rng ^= q->rng << 17;
+
+    uint64_t r = q->rng;
+    int h = 1;
+    while (h < RQ_SKIP_LEVELS && (r & 3) == 0)
+    {
+        h++;
+        r >>= 2;
+    }
+    return h;
+}
+
+static void skip_push(ReadyQueue *q, RqEntry e)
+{
+    RqSkipNode *update[RQ_SKIP_LEVELS];
+    RqSkipNode *x = q->head;
+    for (int l = q->levels - 1; l >= 0; l--)
+    {
+        while (x->next[l] != NULL && before(&x->next[l]->e, &e))
+            x = x->next[l];
+        update[l] = x;
+    }
+
+    int h = skip_height(q);
+    for (int l = q->levels; l < h; l++)
+        update[l] = q->head;
+    if (h > q->levels)
+        q->levels = h;
+
+    RqSkipNode *n = q->spare_skip[h - 1];
+    if (n != NULL)
+        q->spare_skip[h - 1] = n->next[0];
+    else
+        n = checked(malloc(sizeof(RqSkipNode) + h * sizeof(RqSkipNode *)));
+    n->e = e;
+    n->height = h;
+    for (int l = 0; l < h; l++)
+    {
+        n->next[l] = update[l]->next[l];
+        update[l]->next[l] = n;
+    }
+    q->size++;
+}
+
+static Process *skip_pop(ReadyQueue *q)
+{
+    // The first node is the minimum: every level that reaches it starts at head
+    RqSkipNode *n = q->head->next[0];
+    for (int l = 0; l < n->height; l++)
+        q->head->next[l] = n->next[l];
+    while (q->levels > 1 && q->head->next[q->levels - 1] == NULL)
+        q->levels--;
+
+    n->next[0] = q->spare_skip[n->height - 1];
+    q->spare_skip[n->height - 1] = n;
+    q->size--;
+    return n->e.p;
+}
+
+// ---------------------------------------------------------------------------
+// Public API
+// ---------------------------------------------------------------------------
+
+int rq_parse(const char *name)
+{
+    for (int k = 0; k < RQ_NUM_KINDS; k++)
+    {
+        if (strcmp(name, kind_names[k]) == 0)
+            return k;
+    }
+    return -1;
+}
+
+const char *rq_name(int kind)
+{
+    return kind >= 0 && kind < RQ_NUM_KINDS ? kind_names[kind] : "?";
+}
+
+void rq_configure(int kind)
+{
+    configured = kind;
+}
+
+sim_time_t rq_key_range(const Process processes[], int num_processes)
+{
+    sim_time_t longest = 0;
+    for (int i = 0; i < num_processes; i++)
+    {
+        for (int b = 0; b < processes[i].num_bursts; b++)
+        {
+            if (processes[i].cpu_bursts[b] > longest)
+                longest = processes[i].cpu_bursts[b];
+        }
+    }
+    return longest + 1;
+}
+
+int rq_choose(int num_processes, sim_time_t key_range)
+{
+    //* Predicted keys are fractional; buckets need whole numbers
+    if (configured == RQ_BUCKET && predict_enabled())
+        return RQ_PAIRING;
+    if (configured != RQ_AUTO)
+        return configured;
+
+    if (num_processes <= RQ_ARRAY_MAX)
+        return RQ_ARRAY;
+    if (!predict_enabled() && key_range <= RQ_BUCKET_MAX &&
+        (key_range <= RQ_BUCKET_DENSE || key_range <= 2 * (sim_time_t)num_processes))
+        return RQ_BUCKET;
+    return num_processes <= RQ_PAIRING_MAX ? RQ_PAIRING : RQ_HEAP;
+}
+
+void rq_init(ReadyQueue *q, int kind, int capacity, sim_time_t key_range)
+{
+    memset(q, 0, sizeof(*q));
+    q->kind = kind;
+    q->capacity = capacity;
+
+    switch (kind)
+    {
+    case RQ_BUCKET:
+        // A power of two, at least one bitmap word
+        q->num_buckets = 64;
+        while (q->num_buckets < key_range && q->num_buckets < RQ_BUCKET_MAX)
+            q->num_buckets *= 2;
+        q->low = q->num_buckets;
+        q->bucket_head = checked(calloc(q->num_buckets, sizeof(RqPairNode *)));
+        q->bucket_tail = checked(calloc(q->num_buckets, sizeof(RqPairNode *)));
+        q->occupied = checked(calloc(q->num_buckets / 64, sizeof(uint64_t)));
+        q->summary = checked(calloc((q->num_buckets / 64 + 63) / 64, sizeof(uint64_t)));
+        // The nodes come from the pairing heap's pool
+        // fall through
+    case RQ_PAIRING:
+        q->pool = checked(malloc((capacity > 0 ? capacity : 1) * sizeof(RqPairNode)));
+        q->stack = checked(malloc((capacity > 0 ? capacity : 1) * sizeof(RqPairNode *)));
+        for (int i = 0; i < capacity; i++)
+            q->pool[i].sibling = i + 1 < capacity ? &q->pool[i + 1] : NULL;
+        q->spare = capacity > 0 ? &q->pool[0] : NULL;
+        break;
+    case RQ_SKIPLIST:
+        q->head = checked(calloc(1, sizeof(RqSkipNode) + RQ_SKIP_LEVELS * sizeof(RqSkipNode *)));
+        q->head->height = RQ_SKIP_LEVELS;
+        q->levels = 1;
+        q->rng = 0x9e3779b97f4a7c15ULL;
+        break;
+    case RQ_HEAP:
+        q->path = checked(malloc((capacity > 0 ? capacity : 1) * sizeof(int)));
+        q->entries = checked(malloc((capacity > 0 ? capacity : 1) * sizeof(RqEntry)));
+        break;
+    default:
+        q->entries = checked(malloc((capacity > 0 ? capacity : 1) * sizeof(RqEntry)));
+        break;
+    }
+}
+
+void rq_free(ReadyQueue *q)
+{
+    free(q->entries);
+    free(q->path);
+    free(q->pool);
+    free(q->stack);
+    free(q->bucket_head);
+    free(q->bucket_tail);
+    free(q->occupied);
+    free(q->summary);
+
+    if (q->head != NULL)
+    {
+        RqSkipNode *n = q->head->next[0];
+        while (n != NULL)
+        {
+            RqSkipNode *next = n->next[0];
+            free(n);
+            n = next;
+        }
+        for (int h = 0; h < RQ_SKIP_LEVELS; h++)
+        {
+            for (n = q->spare_skip[h]; n != NULL; )
+            {
+                RqSkipNode *next = n->next[0];
+                free(n);
+                n = next;
+            }
+        }
+        free(q->head);
+    }
+    memset(q, 0, sizeof(*q));
+}
+
+void rq_push(ReadyQueue *q, Process *p, double key)
+{
+    if (q->size >= q->capacity)
+        return; // full: every process is already queued
+
+    RqEntry e = {key, q->seq++, p};
+    if (q->kind != RQ_ARRAY)
+    {
+        p->rq_prev = q->last;
+        p->rq_next = NULL;
+        if (q->last != NULL)
+            q->last->rq_next = p;
+        else
+            q->first = p;
+        q->last = p;
+    }
+
+    switch (q->kind)
+    {
+    case RQ_HEAP:
+        heap_push(q, e);
+        break;
+    case RQ_PAIRING:
+        pairing_push(q, e);
+        break;
+    case RQ_SKIPLIST:
+        skip_push(q, e);
+        break;
+    case RQ_BUCKET:
+        bucket_push(q, e);
+        break;
+    default:
+        q->entries[q->size++] = e;
+        break;
+    }
+}
+
+Process *rq_pop(ReadyQueue *q)
+{
+    if (q->size == 0)
+        return NULL;
+
+    Process *p;
+    switch (q->kind)
+    {
+    case RQ_HEAP:
+        p = heap_pop(q);
+        break;
+    case RQ_PAIRING:
+        p = pairing_pop(q);
+        break;
+    case RQ_SKIPLIST:
+        p = skip_pop(q);
+        break;
+    case RQ_BUCKET:
+        p = bucket_pop(q);
+        break;
+    default:
+        return array_pop(q);
+    }
+
+    if (p->rq_prev != NULL)
+        p->rq_prev->rq_next = p->rq_next;
+    else
+        q->first = p->rq_next;
+    if (p->rq_next != NULL)
+        p->rq_next->rq_prev = p->rq_prev;
+    else
+        q->last = p->rq_prev;
+    p->rq_prev = p->rq_next = NULL;
+    return p;
+}
+
+Process *rq_peek(const ReadyQueue *q)
+{
+    if (q->size == 0)
+        return NULL;
+
+    switch (q->kind)
+    {
+    case RQ_HEAP:
+        return q->entries[0].p;
+    case RQ_PAIRING:
+        return q->root->e.p;
+    case RQ_SKIPLIST:
+        return q->head->next[0]->e.p;
+    case RQ_BUCKET:
+        return q->low < q->num_buckets ? q->bucket_head[q->low]->e.p : q->root->e.p;
+    default:
+        return q->entries[array_min(q)].p;
+    }
+}
+
+double rq_min_key_if(const ReadyQueue *q, int (*ok)(const Process *p))
+{
+    double best = DBL_MAX;
+
+    switch (q->kind)
+    {
+    case RQ_HEAP:
+    {
+        // Depth-first from the root; a child is never smaller than its parent
+        int *stack = q->path;
+        int top = 0;
+        if (q->size > 0)
+            stack[top++] = 0;
+        while (top > 0)
+        {
+            int i = stack[--top];
+            if (q->entries[i].key >= best)
+                continue;
+            if (ok == NULL || ok(q->entries[i].p))
+            {
+                best = q->entries[i].key;
+                continue;
+            }
+            for (int c = 2 * i + 1; c <= 2 * i + 2 && c < q->size; c++)
+                stack[top++] = c;
+        }
+        break;
+    }
+    case RQ_BUCKET:
+        // Buckets in key order, each in push order: the first one that is
+        // ok is the smallest. If none is, search the keys past the buckets.
+        for (int b = q->low; b >= 0 && b < q->num_buckets; b = bucket_find(q, b + 1))
+        {
+            for (RqPairNode *n = q->bucket_head[b]; n != NULL; n = n->sibling)
+            {
+                if (ok == NULL || ok(n->e.p))
+                    return n->e.key;
+            }
+        }
+        // fall through
+    case RQ_PAIRING:
+    {
+        RqPairNode **stack = q->stack;
+        int top = 0;
+        if (q->root != NULL)
+            stack[top++] = q->root;
+        while (top > 0)
+        {
+            RqPairNode *n = stack[--top];
+            if (n->sibling != NULL)
+                stack[top++] = n->sibling; // siblings are not ordered among themselves
+            if (n->e.key >= best)
+                continue;
+            if (ok == NULL || ok(n->e.p))
+            {
+                best = n->e.key;
+                continue;
+            }
+            if (n->child != NULL)
+                stack[top++] = n->child;
+        }
+        break;
+    }
+    case RQ_SKIPLIST:
+        for (RqSkipNode *n = q->head->next[0]; n != NULL; n = n->next[0])
+        {
+            if (ok == NULL || ok(n->e.p))
+                return n->e.key; // in key order: the first one is the smallest
+        }
+        break;
+    default:
+        PROF_ADD(COUNT_QUEUE_SCAN, q->size);
+        for (int i = 0; i < q->size; i++)
+        {
+            if (q->entries[i].key < best && (ok == NULL || ok(q->entries[i].p)))
+                best = q->entries[i].key;
+        }
+        break;
+    }
+    return best;
+}
+
+int rq_snapshot(const ReadyQueue *q, Process **out)
+{
+    int n = 0;
+    if (q->kind == RQ_ARRAY)
+    {
+        for (; n < q->size; n++)
+            out[n] = q->entries[n].p;
+        return n;
+    }
+
+    for (Process *p = q->first; p != NULL; p = p->rq_next)
+        out[n++] = p;
+    return n;
+}
@@ -0,0 +1,141 @@
+#ifndef READYQ_H
+#define READYQ_H
+
+#include <stdint.h>
+
+#include "process.h"
+
+//* Keyed ready queue for SJF and STCF (--rq)
+//
+// Processes come out in increasing key order (burst_key()), ties in the
+// order they went in, whatever the structure underneath:
+//
+//   array      unsorted array, a linear scan on every pop and peek (the
+//              original SJF/STCF queue); fastest for a handful of processes
+//   heap       binary heap on (key, push order)
+//   pairing    pairing heap: O(1) push, O(log n) amortized pop
+//   skiplist   skip list on (key, push order), expected O(log n)
+//   bucket     one FIFO per whole-number key below the key range, found
+//              through a two-level occupancy bitmap: O(1) push, pop is a
+//              couple of bit scans. Keys past the range go to a pairing
+//              heap. Needs whole-number keys, i.e. no --predict.
+//   auto       chosen per run from the workload size and key range (default)
+//
+// A key does not change while its process is queued: a process's burst key
+// only moves while it runs, and it is pushed again with the new key when it
+// is preempted. `make rqbench` times the structures, and the circular
+// buffer FIFO and RR use, under scheduler-like operation mixes.
+
+typedef enum {
+    RQ_AUTO, RQ_ARRAY, RQ_HEAP, RQ_PAIRING, RQ_SKIPLIST, RQ_BUCKET, RQ_NUM_KINDS
+} rq_kind_t;
+
+//* auto, from rqbench:
+//   - the array up to RQ_ARRAY_MAX processes; it only keeps up for a handful
+//   - buckets when keys are whole numbers and the longest CPU burst is under
+//     RQ_BUCKET_DENSE, or under twice the process count; sparse buckets
+//     cost more bitmap words per pop than a heap spends comparing
+//   - else a pairing heap up to RQ_PAIRING_MAX processes, a binary heap
+//     above, where the pairing heap's pointer chasing misses the cache
+#define RQ_ARRAY_MAX 8
+#define RQ_BUCKET_DENSE 4096
+#define RQ_BUCKET_MAX (1 << 17)
+#define RQ_PAIRING_MAX 65536
+
+#define RQ_SKIP_LEVELS 16       // levels of 4x fewer nodes each
+
+typedef struct RqEntry
+{
+    double key;
+    unsigned long seq;          // push order, breaks ties between equal keys
+    Process *p;
+} RqEntry;
+
+typedef struct RqPairNode
+{
+    RqEntry e;
+    struct RqPairNode *child;   // leftmost child
+    struct RqPairNode *sibling; // next child of the same parent
+} RqPairNode;
+
+typedef struct RqSkipNode
+{
+    RqEntry e;
+    int height;
+    struct RqSkipNode *next[];  // one link per level below height
+} RqSkipNode;
+
+typedef struct ReadyQueue
+{
+    rq_kind_t kind;
+    int size;
+    int capacity;
+    unsigned long seq;
+
+    //* array: push order; heap: binary heap
+    RqEntry *entries;
+    int *path;                  // heap traversal scratch
+
+    //* pairing heap, nodes from a pool of capacity
+    RqPairNode *pool;
+    RqPairNode *spare;          // free nodes, linked through sibling
+    RqPairNode *root;
+    RqPairNode **stack;         // traversal scratch
+
+    //* bucket: pool nodes linked through sibling, one list per key; keys
+    // from num_buckets on go to the pairing heap above
+    RqPairNode **bucket_head, **bucket_tail;
+    uint64_t *occupied;         // bit per non-empty bucket
+    uint64_t *summary;          // bit per non-zero occupied word
+    int num_buckets;
+    int low;                    // lowest non-empty bucket, num_buckets if none
+
+    //* skip list; unlinked nodes are kept per height for reuse
+    RqSkipNode *head;
+    RqSkipNode *spare_skip[RQ_SKIP_LEVELS];
+    int levels;                 // levels in use
+    uint64_t rng;
+
+    //* Push order for printing (all but the array, which is in push order),
+    // linked through Process.rq_prev / rq_next
+    Process *first, *last;
+} ReadyQueue;
+
+// "auto", "array", "heap", "pairing", "skiplist", "bucket"; -1 if unknown
+int rq_parse(const char *name);
+const char *rq_name(int kind);
+
+// --rq for the runs that follow (RQ_AUTO by default)
+void rq_configure(int kind);
+
+// One past the longest CPU burst: burst keys stay below it (without --predict)
+sim_time_t rq_key_range(const Process processes[], int num_processes);
+
+// The configured kind, with auto resolved for this workload. bucket falls
+// back to pairing when --predict makes the keys fractional.
+int rq_choose(int num_processes, sim_time_t key_range);
+
+// Room for capacity processes, each queued at most once at a time.
+// key_range sizes the buckets (up to RQ_BUCKET_MAX); other kinds ignore it.
+void rq_init(ReadyQueue *q, int kind, int capacity, sim_time_t key_range);
+void rq_free(ReadyQueue *q);
+
+void rq_push(ReadyQueue *q, Process *p, double key);
+// Smallest key, earliest pushed among equals; NULL if empty
+Process *rq_pop(ReadyQueue *q);
+Process *rq_peek(const ReadyQueue *q);
+
+// Smallest key among the processes for which ok() holds (all if ok is
+// NULL; DBL_MAX if none). Subtrees that cannot beat the best so far are
+// skipped.
+double rq_min_key_if(const ReadyQueue *q, int (*ok)(const Process *p));
+
+// Queued processes in push order into out (room for q->size); returns the count
+int rq_snapshot(const ReadyQueue *q, Process **out);
+
+static inline int rq_size(const ReadyQueue *q)
+{
+    return q->size;
+}
+
+#endif
@@ -0,0 +1,216 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "readyq.h"
+
+//* Ready-queue micro-benchmark (make rqbench)
+//
+//   ./rqbench [queued ...]         default 16 256 4096 65536 1048576
+//
+// Every structure starts with `queued` processes and then runs
+// scheduler-like operation mixes at that steady size, timed until at
+// least BENCH_SECONDS have passed:
+//
+//   fifo    pop the head, push it back at the tail (RR / FIFO); keys are
+//           all equal, so order is push order. Also timed on the plain
+//           circular buffer FIFO and RR use.
+//   sjf     pop the shortest, push it back with a new burst (it ran the
+//           burst, did I/O and came back)
+//   stcf    push an arrival, peek (the preemption check); a quarter of the
+//           time the running process is preempted and pushed with its
+//           remaining time instead. The shortest is then popped to run.
+//
+// sjf and stcf draw integer bursts from a narrow (1..16 ticks) and a wide
+// (1..100000) range. Numbers are nanoseconds per cycle of the mix.
+
+#define BENCH_SECONDS 0.2
+#define BENCH_NARROW 16
+#define BENCH_WIDE 100000
+
+typedef enum {
+    MIX_FIFO, MIX_SJF, MIX_STCF
+} mix_t;
+
+static uint64_t rng = 0x2545f4914f6cdd1dULL;
+
+static unsigned next_random(void)
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    return (unsigned)(rng >> 32);
+}
+
+static double burst(int range)
+{
+    return range == 0 ? 0.0 : 1 + next_random() % range;
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+//* One cycle of the mix; the queue size is the same before and after.
+// out[0] is running, out[1] is about to arrive; neither is queued.
+static void cycle(ReadyQueue *q, mix_t mix, int range, Process *out[2])
+{
+    switch (mix)
+    {
+    case MIX_FIFO:
+        rq_push(q, rq_pop(q), 0.0);
+        break;
+    case MIX_SJF:
+        rq_push(q, rq_pop(q), burst(range));
+        break;
+    case MIX_STCF:
+        // arrival, then the preemption check: a quarter of the time the
+        // running process goes back with its remaining time
+        rq_push(q, out[1], burst(range));
+        if ((next_random() & 3) == 0)
+        {
+            rq_push(q, out[0], burst(range) / 2 + 1);
+            out[0] = rq_pop(q);
+        }
+        else
+            rq_peek(q);
+
+        // the running process finishes its burst and the shortest runs
+        out[1] = out[0];
+        out[0] = rq_pop(q);
+        break;
+    }
+}
+
+// Nanoseconds per cycle, or -1 if one cycle would take too long to time
+static double time_queue(int kind, mix_t mix, int range, int queued, Process *procs)
+{
+    if (kind == RQ_ARRAY && queued > 65536)
+        return -1;
+
+    ReadyQueue q;
+    rq_init(&q, kind, queued + 2, range + 1);
+    for (int i = 0; i < queued; i++)
+        rq_push(&q, &procs[i], mix == MIX_FIFO ? 0.0 : burst(range));
+
+    Process *out[2] = {&procs[queued], &procs[queued + 1]};
+    long cycles = 0;
+    long batch = 16;
+    double start = now(), elapsed;
+    do
+    {
+        for (long i = 0; i < batch; i++)
+            cycle(&q, mix, range, out);
+        cycles += batch;
+        batch *= 2;
+        elapsed = now() - start;
+    } while (elapsed < BENCH_SECONDS);
+
+    rq_free(&q);
+    return elapsed * 1e9 / cycles;
+}
+
+//* The circular buffer of fifo.c, for the fifo mix
+static double time_ring(int queued, Process *procs)
+{
+    int capacity = queued + 1;
+    Process **ring = malloc(capacity * sizeof(Process *));
+    int front = 0, rear = 0;
+    for (int i = 0; i < queued; i++)
+    {
+        ring[rear] = &procs[i];
+        rear = (rear + 1) % capacity;
+    }
+
+    long cycles = 0;
+    long batch = 16;
+    double start = now(), elapsed;
+    do
+    {
+        for (long i = 0; i < batch; i++)
+        {
+            Process *p = ring[front];
+            front = (front + 1) % capacity;
+            ring[rear] = p;
+            rear = (rear + 1) % capacity;
+        }
+        cycles += batch;
+        batch *= 2;
+        elapsed = now() - start;
+    } while (elapsed < BENCH_SECONDS);
+
+    free(ring);
+    return elapsed * 1e9 / cycles;
+}
+
+static void print_cell(double ns)
+{
+    if (ns < 0)
+        printf(" %9s", "-");
+    else
+        printf(" %9.1f", ns);
+}
+
+int main(int argc, char *argv[])
+{
+    int default_sizes[] = {16, 256, 4096, 65536, 1048576};
+    int num_sizes = argc > 1 ? argc - 1 : (int)(sizeof(default_sizes) / sizeof(default_sizes[0]));
+    int *sizes = argc > 1 ? malloc(num_sizes * sizeof(int)) : default_sizes;
+    for (int i = 1; i < argc; i++)
+    {
+        sizes[i - 1] = atoi(argv[i]);
+        if (sizes[i - 1] < 1)
+        {
+            printf("usage: %s [queued ...]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    static const struct
+    {
+        mix_t mix;
+        int range;
+        const char *name;
+        const char *keys;
+    } mixes[] = {
+        {MIX_FIFO, 0, "fifo", "-"},
+        {MIX_SJF, BENCH_NARROW, "sjf", "1..16"},
+        {MIX_SJF, BENCH_WIDE, "sjf", "1..100000"},
+        {MIX_STCF, BENCH_NARROW, "stcf", "1..16"},
+        {MIX_STCF, BENCH_WIDE, "stcf", "1..100000"},
+    };
+
+    printf("=== Ready-queue micro-benchmark (ns per cycle) ===\n");
+    printf("  %-5s %-10s %8s %9s", "mix", "keys", "queued", "ring");
+    for (int k = RQ_ARRAY; k < RQ_NUM_KINDS; k++)
+        printf(" %9s", rq_name(k));
+    printf("\n");
+
+    for (size_t m = 0; m < sizeof(mixes) / sizeof(mixes[0]); m++)
+    {
+        for (int s = 0; s < num_sizes; s++)
+        {
+            int queued = sizes[s];
+            Process *procs = calloc(queued + 2, sizeof(Process));
+
+            printf("  %-5s %-10s %8d", mixes[m].name, mixes[m].keys, queued);
+            print_cell(mixes[m].mix == MIX_FIFO ? time_ring(queued, procs) : -1);
+            for (int k = RQ_ARRAY; k < RQ_NUM_KINDS; k++)
+            {
+                print_cell(time_queue(k, mixes[m].mix, mixes[m].range, queued, procs));
+                fflush(stdout);
+            }
+            printf("\n");
+            free(procs);
+        }
+    }
+
+    printf("  (- not timed: no keyed order, or one cycle is a scan of a million entries)\n");
+    if (sizes != default_sizes)
+        free(sizes);
+    return 0;
+}
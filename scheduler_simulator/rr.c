@@ -152,12 +152,120 @@
 //* Handle accordingly: preempt to rear, I/O transition, or completion
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
 
 #include "process.h"
 #include "rr.h"
+#include "io_device.h"
+#include "cost.h"
+#include "power.h"
+#include "trace.h"
+#include "group.h"
+#include "profile.h"
+#include "quantile.h"
+#include "arrivals.h"
+#include "horizon.h"
+
+//* Bursts per sketch generation. Two overlapping sketches are kept and the
+//* older one answers, so the estimate covers the last 1-2 windows of bursts.
+#define ADAPTIVE_WINDOW 64
+
+typedef struct QuantumChange
+{
+    sim_time_t time;
+    int quantum;
+} QuantumChange;
+
+typedef struct AdaptiveQuantum
+{
+    P2Quantile generation[2];
+    int older;
+    int seen;               // bursts added since the last generation swap
+
+    QuantumChange *trajectory;
+    int changes;
+    int capacity;
+} AdaptiveQuantum;
+
+static double adaptive_percentile = 0.0;
+
+//* The last run's, kept for rr_report()
+static AdaptiveQuantum adaptive;
+
+void rr_set_adaptive(double percentile)
+{
+    adaptive_percentile = percentile;
+    adaptive.changes = 0;
+}
+
+void rr_reset(void)
+{
+    adaptive_percentile = 0.0;
+    adaptive.changes = 0;
+}
+
+static void adaptive_init(AdaptiveQuantum *a)
+{
+    p2_init(&a->generation[0], adaptive_percentile / 100.0);
+    p2_init(&a->generation[1], adaptive_percentile / 100.0);
+    a->older = 0;
+    a->seen = 0;
+    a->changes = 0;     // the trajectory buffer is reused across runs
+}
+
+static void adaptive_record(AdaptiveQuantum *a, sim_time_t time, int quantum)
+{
+    if (a->changes == a->capacity)
+    {
+        a->capacity = a->capacity ? a->capacity * 2 : 16;
+        a->trajectory = realloc(a->trajectory, a->capacity * sizeof(QuantumChange));
+    }
+    a->trajectory[a->changes++] = (QuantumChange){time, quantum};
+}
+
+// Feed one completed CPU burst, return the quantum to use from now on
+static int adaptive_observe(AdaptiveQuantum *a, sim_time_t burst)
+{
+    p2_add(&a->generation[0], burst);
+    p2_add(&a->generation[1], burst);
+
+    double estimate = p2_value(&a->generation[a->older]);
 
-void init_q(ReadyQue *rq)
+    if (++a->seen == ADAPTIVE_WINDOW)
+    {
+        // retire the older generation; the younger one already has a window of history
+        p2_init(&a->generation[a->older], adaptive_percentile / 100.0);
+        a->older = 1 - a->older;
+        a->seen = 0;
+    }
+
+    //* Bursts are 64-bit, the quantum (and its counter) stays an int
+    if (estimate >= INT_MAX)
+        return INT_MAX;
+    int quantum = (int)estimate;
+    if (quantum < estimate)
+        quantum++;
+    return quantum < 1 ? 1 : quantum;
+}
+
+void rr_report(void)
+{
+    if (adaptive_percentile <= 0 || adaptive.changes == 0)
+        return;
+
+    printf("\n=== Quantum trajectory (p%g of recent CPU bursts) ===\n", adaptive_percentile);
+    for (int i = 0; i < adaptive.changes; i++)
+    {
+        printf("  t=%-8" PRIdTIME " quantum=%d%s\n", adaptive.trajectory[i].time, adaptive.trajectory[i].quantum,
+               i == 0 ? " (initial)" : "");
+    }
+}
+
+void init_q(ReadyQue *rq, int capacity)
 {
+    rq->queue = malloc(capacity * sizeof(Process *));
+    rq->capacity = capacity;
     rq->front = 0;
     rq->rear = 0;
     rq->size = 0;
@@ -166,12 +274,13 @@ void init_q(ReadyQue *rq)
 // Add process to back of queue
 void enq(ReadyQue *rq, Process *p)
 {
+    PROF_COUNT(COUNT_ENQUEUE);
     // if queue is full
-    if (rq->size >= MAX_PROCESSES)
+    if (rq->size >= rq->capacity)
         return;
 
     rq->queue[rq->rear] = p;
-    rq->rear = (rq->rear + 1) % MAX_PROCESSES; //* Wrap around
+    rq->rear = (rq->rear + 1) % rq->capacity; //* Wrap around
     p->in_queue = 1;
     rq->size++;
 }
@@ -179,11 +288,12 @@ void enq(ReadyQue *rq, Process *p)
 // Dequeue from front of the queue
 Process *deq(ReadyQue *rq)
 {
+    PROF_COUNT(COUNT_DEQUEUE);
     if (rq->size == 0)
         return NULL;
 
     Process *p = rq->queue[rq->front];
-    rq->front = (rq->front + 1) % MAX_PROCESSES;
+    rq->front = (rq->front + 1) % rq->capacity;
     rq->size--;
     p->in_queue = 0;
     return p;
@@ -195,25 +305,23 @@ int isempty(ReadyQue *rq)
 }
 
 
-void print(Process processes[], int num_processes, int current_time, Process *running_process, ReadyQue rq, int completed)
+void print(Process processes[], int num_processes, sim_time_t current_time, Process *running_process, ReadyQue rq, int completed)
 {
-    printf("\n=== Time %d ===\n", current_time);
+    trace_line(TEXT_TICK, NULL, current_time, 0, 0);
 
     // Print what happened during I/O completions
     for (int i = 0; i < num_processes; i++)
     {
         if (processes[i].state == BLOCKED && processes[i].io_end_time == current_time)
         {
-            printf("  ✓ %s completed I/O, ", processes[i].pid);
             if (processes[i].current_burst + 1 < processes[i].num_bursts)
             {
-                printf("moving to CPU burst %d (duration: %d)\n",
-                       processes[i].current_burst + 1,
-                       processes[i].cpu_bursts[processes[i].current_burst + 1]);
+                trace_line(TEXT_IO_DONE, &processes[i], current_time, processes[i].current_burst + 1,
+                           processes[i].cpu_bursts[processes[i].current_burst + 1]);
             }
             else
             {
-                printf("all bursts completed - FINISHED\n");
+                trace_line(TEXT_IO_DONE, &processes[i], current_time, -1, 0);
             }
         }
     }
@@ -223,7 +331,7 @@ void print(Process processes[], int num_processes, int current_time, Process *ru
     {
         if (processes[i].arrival_time == current_time)
         {
-            printf("  → %s arrived and added to ready queue\n", processes[i].pid);
+            trace_line(TEXT_ARRIVED, &processes[i], current_time, 0, 0);
         }
     }
 
@@ -232,129 +340,146 @@ void print(Process processes[], int num_processes, int current_time, Process *ru
     {
         Process *next = rq.queue[rq.front]; // Front of circular queue
 
-        printf("  🖥️  CPU assigned to %s (burst %d, duration: %d)\n",
-               next->pid, next->current_burst, next->remaining_time);
+        trace_line(TEXT_ASSIGNED, next, current_time, 0, 0);
+        trace_line(TEXT_ASSIGNED_REST, next, current_time, next->current_burst, next->remaining_time);
     }
 
     // Print execution
     if (running_process != NULL)
     {
-        printf("  ⚡ %s executing (remaining: %d → %d)\n",
-               running_process->pid,
-               running_process->remaining_time,
-               running_process->remaining_time - 1);
+        trace_line(TEXT_EXECUTING, running_process, current_time, running_process->remaining_time, 0);
 
         // Check if this will complete the burst
         if (running_process->remaining_time == 1)
         {
             if (running_process->current_burst == running_process->num_bursts - 1)
             {
-                printf("     └─ Will FINISH after this tick\n");
+                trace_line(TEXT_WILL_FINISH, running_process, current_time, 0, 0);
             }
             else
             {
-                int io_duration = running_process->io_times[running_process->current_burst];
-                printf("     └─ Will go to I/O (duration: %d) after this tick\n", io_duration);
+                sim_time_t io_duration = running_process->io_times[running_process->current_burst];
+                trace_line(TEXT_WILL_IO, running_process, current_time, io_duration, 0);
             }
         }
     }
     else
     {
-        printf("  💤 CPU: IDLE\n");
+        trace_line(TEXT_IDLE_NOTE, NULL, current_time, 0, 0);
     }
 
     // Print current system state
-    printf("  📊 System State:\n");
-    printf("     Running: ");
+    trace_line(TEXT_STATE, NULL, current_time, 0, 0);
     if (running_process != NULL)
     {
-        printf("%s (burst %d, remaining: %d after execution)\n",
-               running_process->pid, running_process->current_burst,
-               running_process->remaining_time - 1);
+        trace_line(TEXT_RUNNING, running_process, current_time, 0, 0);
+        trace_line(TEXT_RUNNING_REST, running_process, current_time, running_process->current_burst,
+                   running_process->remaining_time - 1);
     }
     else
     {
-        printf("None\n");
+        trace_line(TEXT_RUNNING_NONE, NULL, current_time, 0, 0);
     }
 
-    printf("     Ready Queue: [");
+    trace_line(TEXT_READY_OPEN, NULL, current_time, 0, 0);
     for (int i = 0; i < rq.size; i++)
     {
-        int actual_index = (rq.front + i) % MAX_PROCESSES; // Circular queue logic
-        printf("%s", rq.queue[actual_index]->pid);
-        if (i < rq.size - 1)
-            printf(", ");
+        int actual_index = (rq.front + i) % rq.capacity; // Circular queue logic
+        trace_line(TEXT_ITEM, rq.queue[actual_index], current_time, 0, 0);
     }
-    printf("]\n");
+    trace_line(TEXT_CLOSE, NULL, current_time, 0, 0);
 
-    printf("     Blocked (I/O): [");
-    int first_blocked = 1;
+    trace_line(TEXT_BLOCKED_OPEN, NULL, current_time, 0, 0);
     for (int i = 0; i < num_processes; i++)
     {
         if (processes[i].state == BLOCKED)
         {
-            if (!first_blocked)
-                printf(", ");
-            printf("%s(ends@%d)", processes[i].pid, processes[i].io_end_time);
-            first_blocked = 0;
+            if (io_is_queued(&processes[i]))
+                trace_line(TEXT_ITEM_QUEUED, &processes[i], current_time, 0, 0);
+            else
+                trace_line(TEXT_ITEM_ENDS, &processes[i], current_time, processes[i].io_end_time, 0);
         }
     }
-    printf("]\n");
+    trace_line(TEXT_CLOSE, NULL, current_time, 0, 0);
 
-    printf("     Completed: %d/%d\n", completed, num_processes);
+    trace_line(TEXT_COMPLETED, NULL, current_time, completed, num_processes);
 }
 
 void rr_schedule(Process processes[], int num_processes, int quantum)
 {
     ReadyQue rq;
-    init_q(&rq);
+    init_q(&rq, num_processes);
+    ArrivalCursor arrivals;
+    arrivals_begin(&arrivals, processes, num_processes);
 
     Process *running_process = NULL;
 
     int completed = 0;
-    int current_time = 0;
+    sim_time_t current_time = 0;
 
     int quantum_counter = 0;
-    const int QUANTUM = quantum; // or whatever quantum size
+    int QUANTUM = quantum; // fixed unless the adaptive quantum is on
+
+    adaptive.changes = 0;
+    if (adaptive_percentile > 0)
+    {
+        adaptive_init(&adaptive);
+        adaptive_record(&adaptive, 0, QUANTUM);
+    }
 
     while (completed < num_processes)
     {
-        //* 1) Check for I/O Completions
-        for (int i = 0; i < num_processes; i++)
-        {
-            if (processes[i].state == BLOCKED && processes[i].io_end_time == current_time)
-            { // i/o burst completed
+        PROF_COUNT(COUNT_TICKS);
+        PROF_BEGIN(PHASE_IO);
 
-                processes[i].state = READY;
-                
-                processes[i].current_burst++;
+        //* 0) Advance I/O devices (frees units, starts queued requests)
+        io_tick(current_time);
 
-                // check if CPU Bursts are remaining or not
-                if (processes[i].current_burst < processes[i].num_bursts)
-                {
+        // Groups whose period rolled over hand their parked processes back
+        Process *released;
+        while ((released = group_release(current_time)) != NULL)
+            enq(&rq, released);
 
-                    processes[i].remaining_time = processes[i].cpu_bursts[processes[i].current_burst];
+        //* 1) Check for I/O Completions
+        Process *done;
+        while ((done = io_next_done(current_time)) != NULL)
+        { // i/o burst completed
+            int i = done - processes;
+            PROF_COUNT(COUNT_PROCESS_SCAN);
+
+            processes[i].state = READY;
+            trace_event(TRACE_UNBLOCK, i, current_time);
+            
+            processes[i].current_burst++;
 
-                    if (!processes[i].in_queue)
-                    {
-                        enq(&rq, &processes[i]);
-                    }
-                }
-                else
-                { // No more CPU bursts - process is finished
+            // check if CPU Bursts are remaining or not
+            if (processes[i].current_burst < processes[i].num_bursts)
+            {
 
-                    processes[i].state = FINISHED;
-                    processes[i].completed_flag = 1;
-                    completed++;
+                processes[i].remaining_time = processes[i].cpu_bursts[processes[i].current_burst];
+
+                if (!processes[i].in_queue)
+                {
+                    enq(&rq, &processes[i]);
                 }
             }
+            else
+            { // No more CPU bursts - process is finished
+
+                processes[i].state = FINISHED;
+                processes[i].completed_flag = 1;
+                completed++;
+                trace_event(TRACE_FINISH, i, current_time);
+            }
         }
 
+        PROF_END(PHASE_IO);
+        PROF_BEGIN(PHASE_ARRIVALS);
+
         //* 2) Check for new arrivals
-        for (int i = 0; i < num_processes; i++)
+        for (int i; (i = arrivals_next(&arrivals, processes, current_time)) >= 0; )
         {
-            if (processes[i].arrival_time == current_time && processes[i].completed_flag == 0 && !processes[i].in_queue &&
-        processes[i].state != RUNNING)
+            if (processes[i].completed_flag == 0 && !processes[i].in_queue && processes[i].state != RUNNING)
             {
                 processes[i].state = READY;
                 // Initialize first CPU burst
@@ -364,28 +489,86 @@ void rr_schedule(Process processes[], int num_processes, int quantum)
             }
         }
 
+        PROF_END(PHASE_ARRIVALS);
+        PROF_BEGIN(PHASE_SELECT);
+
         //* 3) If no process is running, dequeue from front of Ready Queue
-        if (running_process == NULL && !isempty(&rq))
+        while (running_process == NULL && !isempty(&rq))
         {
             running_process = deq(&rq);
+            if (group_throttled(running_process))
+            {
+                // Group is out of quota: the process waits there, try the next one
+                group_park(running_process, current_time);
+                running_process = NULL;
+                continue;
+            }
             running_process->state = RUNNING;
+            cost_dispatch(running_process, 0, current_time);
+            trace_event(TRACE_DISPATCH, running_process - processes, current_time);
+            PROF_COUNT(COUNT_DISPATCH);
 
             quantum_counter = 0; // Fresh quantum for new process
         }
 
-        //* 4) Run current process for 1 tick
-        if (running_process != NULL)
-        {
-            print(processes, num_processes, current_time, running_process, rq, completed);
+        PROF_END(PHASE_SELECT);
+        PROF_BEGIN(PHASE_EXECUTE);
+
+        //* 4) Run current process for 1 tick (switch ticks don't use up the quantum)
+        int slowed = power_tick(0, running_process != NULL, current_time);
 
-            running_process->remaining_time--;
+        if (running_process != NULL && slowed != POWER_RUN)
+        {
+            // Waking from an idle state / below top frequency: busy, no progress
+            if (trace_text)
+            {
+                if (slowed == POWER_WAKING)
+                    trace_line(TEXT_WAKING, running_process, current_time, 0, 0);
+                else
+                    trace_line_ghz(TEXT_SLOW, running_process, current_time, power_frequency(0));
+            }
+        }
+        else if (running_process != NULL && cost_stalled(0))
+        {
+            // Context switch / cache refill: CPU busy, process makes no progress
+            if (trace_text)
+            {
+                trace_line(TEXT_SWITCHING, running_process, current_time, 0, 0);
+            }
+        }
+        else if (running_process != NULL)
+        {
+            if (trace_text)
+            {
+                PROF_BEGIN(PHASE_PRINT);
+                print(processes, num_processes, current_time, running_process, rq, completed);
+                PROF_END(PHASE_PRINT);
+            }
+            //* Up to the next event at once when nothing needs every tick (horizon.h)
+            sim_time_t run = horizon_run(&arrivals, processes, current_time,
+                                         running_process->remaining_time, current_time + QUANTUM - quantum_counter);
+            PROF_ADD(COUNT_TICKS, run - 1);
+            current_time += run - 1;
+            running_process->last_ran = current_time;
+            running_process->remaining_time -= run;
+            int throttled = group_charge(running_process, current_time);
 
-            quantum_counter++; // Track quantum usage
+            quantum_counter += run; // Track quantum usage
 
             
             // Check if current CPU burst is complete
             if (running_process->remaining_time == 0)
             {
+                if (adaptive_percentile > 0)
+                {
+                    int next = adaptive_observe(&adaptive, running_process->cpu_bursts[running_process->current_burst]);
+                    if (next != QUANTUM)
+                    {
+                        QUANTUM = next;
+                        adaptive_record(&adaptive, current_time + 1, QUANTUM);
+                    }
+                }
+
                 //* Check if this was the last CPU burst
                 if (running_process->current_burst == running_process->num_bursts - 1)
                 {
@@ -393,36 +576,66 @@ void rr_schedule(Process processes[], int num_processes, int quantum)
                     running_process->state = FINISHED;
                     running_process->completed_flag = 1;
                     completed++;
+                    trace_event(TRACE_FINISH, running_process - processes, current_time + 1);
                     running_process = NULL;
                 }
                 else
                 {
                     // Move to I/O
                     running_process->state = BLOCKED;
-                    int io_duration = running_process->io_times[running_process->current_burst];
-                    running_process->io_end_time = current_time + io_duration + 1;
+                    io_submit(running_process, current_time);
+                    trace_event(TRACE_BLOCK, running_process - processes, current_time + 1);
                     running_process = NULL;
                 }
             }
             
+            else if (throttled)
+            {
+                // Group ran out of quota: off the CPU until its next period
+                running_process->state = READY;
+                group_park(running_process, current_time + 1);
+                trace_event(TRACE_PREEMPT, running_process - processes, current_time + 1);
+                PROF_COUNT(COUNT_PREEMPT);
+                running_process = NULL;
+                quantum_counter = 0;
+            }
+
             //* 5) Check quantum expiration first
             else if (quantum_counter >= QUANTUM)
             {
                 // Quantum expired - preempt (back of line)
                 running_process->state = READY;
                 enq(&rq, running_process);
+                trace_event(TRACE_PREEMPT, running_process - processes, current_time + 1);
+                PROF_COUNT(COUNT_PREEMPT);
                 running_process = NULL;
                 quantum_counter = 0;
             }
         }
         else
         {
-            printf("[Time %d] ", current_time);
-            printf("CPU: IDLE \n");
+            PROF_COUNT(COUNT_IDLE_TICKS);
+            if (trace_text)
+            {
+                trace_line_str(TEXT_IDLE, NULL, current_time, 0, power_idle_name(0));
+            }
+
+            // Idle until the next event (horizon.h)
+            sim_time_t last = horizon_idle(&arrivals, processes, current_time);
+            PROF_ADD(COUNT_TICKS, last - current_time);
+            PROF_ADD(COUNT_IDLE_TICKS, last - current_time);
+            current_time = last;
         }
 
+        PROF_END(PHASE_EXECUTE);
+
         current_time++;
+        progress_tick(current_time, completed);
 
-        printf("\n=== FINAL: All %d processes completed ===\n", completed);
+        if (trace_text)
+            trace_line(TEXT_FINAL, NULL, current_time, completed, 0);
     }
-}
\ No newline at end of file
+
+    arrivals_end(&arrivals);
+    free(rq.queue);
+}
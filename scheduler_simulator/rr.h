@@ -3,10 +3,9 @@
 
 #include "process.h"
 
-#define MAX_PROCESSES 100
-
 typedef struct {
-    Process* queue[MAX_PROCESSES];
+    Process** queue;    // sized to the workload at init
+    int capacity;
     int front;   // where to take from
     int rear;    // where to add
     int size;    // how many processes in queue
@@ -14,4 +13,14 @@ typedef struct {
 
 void rr_schedule(Process processes[], int num_processes, int quantum);
 
+//* Adaptive quantum: instead of a fixed --quantum, use the given percentile
+//* (0-100) of recently completed CPU bursts. 0 turns it off.
+void rr_set_adaptive(double percentile);
+
+// Fixed quantum again and no changes recorded (between runs)
+void rr_reset(void);
+
+// The last run's quantum changes, if it used the adaptive quantum
+void rr_report(void);
+
 #endif
\ No newline at end of file
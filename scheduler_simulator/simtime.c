@@ -0,0 +1,111 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "simtime.h"
+
+int64_t sim_tick_ns = SIM_NS_PER_MS;
+
+// Durations sim_parse_duration() had to round, and the first of them
+static long rounded;
+static int64_t first_rounded_ns;
+
+static const struct
+{
+    const char *suffix;
+    int64_t ns;
+} units[] = {
+    {"ns", 1}, {"us", 1000}, {"ms", SIM_NS_PER_MS}, {"s", 1000 * (int64_t)SIM_NS_PER_MS},
+};
+
+// "1.5ms" -> 1500000 ns, without going through floating point. Returns
+// -1 if s is not a number followed by a unit (no unit: *has_unit = 0).
+static int parse_ns(const char *s, int64_t *ns, int *has_unit)
+{
+    int64_t whole = 0, fraction = 0, scale = 1;
+    const char *c = s;
+
+    if (*c < '0' || *c > '9')
+        return -1;
+    for (; *c >= '0' && *c <= '9'; c++)
+    {
+        if (whole > (INT64_MAX - 9) / 10)
+            return -1;
+        whole = whole * 10 + (*c - '0');
+    }
+    if (*c == '.')
+    {
+        for (c++; *c >= '0' && *c <= '9'; c++)
+        {
+            //* Digits past nanoseconds cannot change the result
+            if (scale < 1000 * (int64_t)SIM_NS_PER_MS)
+            {
+                fraction = fraction * 10 + (*c - '0');
+                scale *= 10;
+            }
+        }
+    }
+
+    *has_unit = *c != '\0';
+    if (!*has_unit)
+    {
+        *ns = whole;
+        return fraction == 0 ? 0 : -1;
+    }
+
+    for (size_t u = 0; u < sizeof(units) / sizeof(units[0]); u++)
+    {
+        if (strcmp(c, units[u].suffix) != 0)
+            continue;
+        if (whole > INT64_MAX / units[u].ns)
+            return -1;
+        *ns = whole * units[u].ns + fraction * units[u].ns / scale;
+        return 0;
+    }
+    return -1;
+}
+
+int sim_set_tick(const char *spec)
+{
+    int64_t ns;
+    int has_unit;
+    if (parse_ns(spec, &ns, &has_unit) != 0 || !has_unit || ns < 1)
+    {
+        printf("--tick takes a length with a unit, e.g. 1ms, 10us or 500ns.\n");
+        return -1;
+    }
+    sim_tick_ns = ns;
+    return 0;
+}
+
+int sim_parse_duration(const char *s, sim_time_t *ticks)
+{
+    int64_t value;
+    int has_unit;
+    if (parse_ns(s, &value, &has_unit) != 0)
+        return -1;
+
+    if (!has_unit)
+    {
+        *ticks = value;
+        return 0;
+    }
+    if (value % sim_tick_ns != 0 && rounded++ == 0)
+        first_rounded_ns = value;
+    *ticks = sim_ns_to_ticks(value);
+    return 0;
+}
+
+long sim_rounded_durations(int64_t *first_ns)
+{
+    long count = rounded;
+    if (first_ns != NULL)
+        *first_ns = first_rounded_ns;
+    rounded = 0;
+    return count;
+}
+
+sim_time_t sim_ns_to_ticks(int64_t ns)
+{
+    sim_time_t ticks = ns / sim_tick_ns + (ns % sim_tick_ns >= (sim_tick_ns + 1) / 2);
+    return ticks < 1 && ns > 0 ? 1 : ticks;
+}
@@ -0,0 +1,57 @@
+#ifndef SIMTIME_H
+#define SIMTIME_H
+
+#include <stdint.h>
+#include <inttypes.h>
+
+//* Simulated time
+//
+// Times and durations are 64-bit tick counts, so runs and bursts are not
+// limited to 2^31 ticks. Print them with "%" PRIdTIME.
+//
+// A tick is 1 ms unless --tick says otherwise. Workload durations written
+// with a unit (250us, 1.5ms, 2s, 800ns) are converted to ticks of that
+// length; plain numbers are ticks. The conversion is exact integer
+// arithmetic on nanoseconds, rounding to the nearest tick (at least one),
+// so a trace recorded in microseconds runs on a 1us tick without loss.
+// Durations that are not whole ticks are counted, and the loader warns
+// about them: the schedule then runs on rounded times.
+//
+// A fine tick costs little: with --quiet the single-CPU engines skip from
+// one event to the next instead of stepping every tick (see horizon.h).
+// Time is still a tick count, not nanoseconds, so the tick must be at
+// least as fine as the finest duration to be exact.
+
+typedef int64_t sim_time_t;
+
+#define PRIdTIME PRId64
+#define SIM_TIME_MAX INT64_MAX
+
+#define SIM_NS_PER_MS 1000000
+
+//* Tick length in nanoseconds (--tick)
+extern int64_t sim_tick_ns;
+
+// "1ms", "10us", "500ns"; returns -1 (after saying why) if malformed
+int sim_set_tick(const char *spec);
+
+// Workload duration: "25" ticks or "25us", "1.5ms", ... converted to
+// ticks. Returns -1 if malformed.
+int sim_parse_duration(const char *s, sim_time_t *ticks);
+
+// A duration in nanoseconds as ticks, rounded like sim_parse_duration().
+// Model constants are given in nanoseconds and converted with this when
+// they are configured, so they do not change with --tick.
+sim_time_t sim_ns_to_ticks(int64_t ns);
+
+// How many durations sim_parse_duration() rounded since the last call
+// (the first one in *first_ns), and start counting again
+long sim_rounded_durations(int64_t *first_ns);
+
+// Tick length in milliseconds (for per-tick energy)
+static inline double sim_tick_ms(void)
+{
+    return (double)sim_tick_ns / SIM_NS_PER_MS;
+}
+
+#endif
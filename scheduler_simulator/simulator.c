@@ -0,0 +1,164 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#include "simulator.h"
+#include "workload.h"
+#include "io_device.h"
+#include "group.h"
+#include "power.h"
+#include "smp.h"
+#include "rr.h"
+#include "predict.h"
+#include "trace.h"
+
+struct Simulator
+{
+    char *path;             // NULL = processes belong to the caller
+    Process *processes;
+    int num_processes;
+    char error[160];
+};
+
+//* Set while a run or reset has the schedulers' process-wide state
+static atomic_flag in_use = ATOMIC_FLAG_INIT;
+
+static void claim(const char *caller)
+{
+    if (atomic_flag_test_and_set_explicit(&in_use, memory_order_acquire))
+    {
+        fprintf(stderr, "%s: another simulation is running in this process\n", caller);
+        abort();
+    }
+}
+
+static void release(void)
+{
+    atomic_flag_clear_explicit(&in_use, memory_order_release);
+}
+
+Simulator *sim_create(const char *workload_path)
+{
+    Simulator *sim = calloc(1, sizeof(Simulator));
+    if (sim == NULL)
+        return NULL;
+
+    if (load_workload(workload_path, &sim->processes, &sim->num_processes) != 0)
+    {
+        free(sim);
+        return NULL;
+    }
+    sim->path = strdup(workload_path);
+    return sim;
+}
+
+Simulator *sim_create_from(Process processes[], int num_processes)
+{
+    Simulator *sim = calloc(1, sizeof(Simulator));
+    if (sim == NULL)
+        return NULL;
+
+    sim->processes = processes;
+    sim->num_processes = num_processes;
+    return sim;
+}
+
+void sim_destroy(Simulator *sim)
+{
+    if (sim == NULL)
+        return;
+
+    if (sim->path != NULL)
+        free_workload(sim->processes, sim->num_processes);
+    free(sim->path);
+    free(sim);
+}
+
+static void reset(Simulator *sim)
+{
+    workload_reset(sim->processes, sim->num_processes);
+    io_reset();
+    group_reset();
+    cost_reset();
+    power_reset();
+    predict_reset();
+    rr_reset();
+    smp_reset();
+}
+
+void sim_reset(Simulator *sim)
+{
+    claim("sim_reset");
+    reset(sim);
+    release();
+}
+
+int sim_run(Simulator *sim, const RunConfig *run, SimResults *results)
+{
+    memset(results, 0, sizeof(*results));
+    sim->error[0] = '\0';
+
+    const char *problem = run_check(run);
+    if (problem != NULL)
+    {
+        snprintf(sim->error, sizeof(sim->error), "%s", problem);
+        return -1;
+    }
+
+    // @note 1. workload and every module back to its pre-run state
+    // @note 2. this run's knobs, then simulate silently with metrics recording
+    claim("sim_run");
+    reset(sim);
+    run_configure(run);
+
+    int text = trace_text;
+    trace_text = 0;
+    metrics_open(sim->processes, sim->num_processes);
+    int result = run_schedule(run, sim->processes, sim->num_processes);
+    trace_text = text;
+
+    if (result != 0)
+    {
+        if (result < 0)
+            snprintf(sim->error, sizeof(sim->error), "Unknown scheduling algorithm %s", run->algorithm);
+        else
+            snprintf(sim->error, sizeof(sim->error), "The workload cannot run under %s", run->algorithm);
+        metrics_close();
+        release();
+        return -1;
+    }
+
+    metrics_summarize(&results->summary);
+    metrics_close();
+
+    RunSummary *s = &results->summary;
+    results->cost = cost_totals();
+    long busy = s->cpu_ticks + results->cost.switch_ticks + results->cost.cache_ticks;
+    int cpus = run->smp.cpus > 0 ? run->smp.cpus : 1;
+    results->utilization = s->makespan > 0 ? (double)busy / ((double)s->makespan * cpus) : 0.0;
+
+    results->energy_j = power_energy();
+    results->avg_power_w = power_average();
+    results->remote_fraction = smp_remote_fraction();
+    results->cross_node_migrations = smp_cross_node_migrations();
+    results->cross_node_wakeups = smp_cross_node_wakeups();
+    release();
+    return 0;
+}
+
+const char *sim_error(const Simulator *sim)
+{
+    return sim->error;
+}
+
+const char *sim_workload(const Simulator *sim)
+{
+    return sim->path;
+}
+
+Process *sim_processes(const Simulator *sim, int *num_processes)
+{
+    *num_processes = sim->num_processes;
+    return sim->processes;
+}
@@ -0,0 +1,75 @@
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+
+#include "process.h"
+#include "experiment.h"
+#include "metrics.h"
+#include "cost.h"
+
+//* Embedding API (libscheduler.a / libscheduler.so)
+//
+// Load a workload once, then run it as often as needed; every run starts
+// from the workload's initial state, and resetting costs O(processes):
+//
+//   Simulator *sim = sim_create("big.txt");
+//   RunConfig run;
+//   run_config_defaults(&run);
+//   run.algorithm = "RR";
+//   for (int q = 1; q <= 8; q++)
+//   {
+//       SimResults r;
+//       run.quantum = q;
+//       if (sim_run(sim, &run, &r) == 0)
+//           printf("%d %.2f\n", q, r.summary.avg_turnaround);
+//   }
+//   sim_destroy(sim);
+//
+// Runs are silent (no per-tick trace). Devices and groups (io_configure(),
+// group_configure()) must be declared before sim_create() if the workload
+// uses them, and so must the tick length (sim_set_tick()) if it gives
+// durations with units.
+//
+// The schedulers keep their state in globals, shared with the host threads
+// of an --cpus run, so a process runs one simulation at a time: sim_run()
+// and sim_reset() abort if another thread is inside either of them. Run
+// simulators side by side in separate processes (as --replications does).
+
+typedef struct Simulator Simulator;
+
+typedef struct SimResults
+{
+    RunSummary summary;
+    CostStats cost;
+    double utilization;             // busy CPU time / (makespan x CPUs)
+    double energy_j;                // 0 without run.dvfs
+    double avg_power_w;
+    double remote_fraction;         // 0 without run.numa
+    long cross_node_migrations;
+    long cross_node_wakeups;
+} SimResults;
+
+// NULL (after saying why) if the workload cannot be loaded
+Simulator *sim_create(const char *workload_path);
+
+// Simulate processes the caller owns; they must outlive the simulator
+Simulator *sim_create_from(Process processes[], int num_processes);
+
+// Simulate with run (run->workload_path is ignored). Returns 0 and fills
+// results, or -1 if run is not valid for this simulator (see sim_error()).
+int sim_run(Simulator *sim, const RunConfig *run, SimResults *results);
+
+// Workload and every module's run state (devices, groups, CPUs, power,
+// burst prediction, the adaptive quantum) back to their pre-run state.
+// sim_run() does this itself before every run.
+void sim_reset(Simulator *sim);
+
+// Why the last sim_run() failed
+const char *sim_error(const Simulator *sim);
+
+// The workload path (NULL for sim_create_from()) and its processes
+const char *sim_workload(const Simulator *sim);
+Process *sim_processes(const Simulator *sim, int *num_processes);
+
+void sim_destroy(Simulator *sim);
+
+#endif
@@ -2,14 +2,9 @@
 #define SJF_H
 
 #include "process.h"
+#include "readyq.h"
 
-#define MAX_PROCESSES 100
-
-typedef struct readyQ
-{
-    Process* queue[MAX_PROCESSES];
-    int size;
-}readyQ;
+typedef ReadyQueue readyQ;  // ordered by burst_key(), see readyq.h
 
 void sjf_schedule(Process processes[], int num_processes);
 
@@ -0,0 +1,781 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#include "smp.h"
+#include "io_device.h"
+#include "metrics.h"
+#include "numa.h"
+#include "power.h"
+#include "trace.h"
+
+typedef enum {
+    EV_ARRIVE, EV_WAKE, EV_MIGRATE
+} smp_event_t;
+
+typedef struct SmpEvent
+{
+    sim_time_t time;
+    int index;              // process index
+    smp_event_t kind;
+} SmpEvent;
+
+//* Mailbox message. A process has at most one in flight (it is either
+//* migrating or waiting to be woken up elsewhere), so there is one
+//* preallocated message per process.
+typedef struct SmpMessage
+{
+    struct SmpMessage *next;
+    sim_time_t time;
+    int cpu;
+    smp_event_t kind;
+} SmpMessage;
+
+typedef struct SmpCpu
+{
+    //* Run queue, circular, grows on demand
+    Process **queue;
+    int front;
+    int size;
+    int capacity;
+
+    Process *running;
+    int quantum_used;
+    int credit;             // NUMA: hundredths of a tick toward the next tick of progress
+
+    //* Pending arrivals / wakeups / migrations, min-heap (see event_before)
+    SmpEvent *events;
+    int num_events;
+    int events_capacity;
+    int inbound;            // migrations heading here, counted as load
+
+    //* Set between windows by the planner
+    int load;
+    int migrate_to;
+    int migrate_count;
+    int sibling_busy;       // an SMT sibling had work at the snapshot
+
+    // stats
+    long busy_ticks;
+    long dispatches;
+    long migrations;
+    long remote_wakeups;
+    long completed;
+    long transitions;       // dispatch, preempt, block, wake and finish, for --progress
+    long numa_ticks;        // ticks a process was on the CPU past the switch / power stalls
+    long remote_ticks;      // ... with its memory on another node
+    long slowed_ticks;      // ... without progress (remote memory or busy sibling)
+    long cross_node_migrations;
+    long cross_node_wakeups;
+} __attribute__((aligned(64))) SmpCpu;
+
+typedef struct SmpPartition
+{
+    struct SmpMachine *m;
+    int first;              // CPUs [first, last)
+    int last;
+    _Atomic(SmpMessage *) inbox;
+    pthread_t thread;
+    LatencyStats latency;   // processes finished here, merged after the run
+} SmpPartition;
+
+typedef struct SmpMachine
+{
+    Process *processes;
+    int num_processes;
+    SmpCpu *cpus;
+    int num_cpus;
+    SmpPartition *parts;
+    int num_parts;
+    int *owner;             // CPU -> partition
+    SmpMessage *messages;   // one per process
+    sim_time_t *finish;     // finish time per process
+    int *home;              // NUMA home node per process (-1 = not yet run)
+    int window;
+    int quantum;
+
+    pthread_barrier_t barrier;
+
+    //* Written by the planner between windows, read-only during one
+    sim_time_t window_start;
+    int *order;             // planner scratch: CPUs by load
+    int *node_order;        // planner scratch: CPUs by node, then load
+    int done;
+    long windows;
+} SmpMachine;
+
+static void *checked(void *ptr)
+{
+    if (ptr == NULL)
+    {
+        fprintf(stderr, "smp: out of memory\n");
+        exit(1);
+    }
+    return ptr;
+}
+
+// ---------------------------------------------------------------------------
+// Per-CPU run queue and event heap (touched only by the owning thread)
+// ---------------------------------------------------------------------------
+
+static void rq_push(SmpCpu *c, Process *p)
+{
+    if (c->size == c->capacity)
+    {
+        int capacity = c->capacity ? c->capacity * 2 : 16;
+        Process **grown = checked(malloc(capacity * sizeof(Process *)));
+        for (int i = 0; i < c->size; i++)
+            grown[i] = c->queue[(c->front + i) % c->capacity];
+        free(c->queue);
+        c->queue = grown;
+        c->front = 0;
+        c->capacity = capacity;
+    }
+    c->queue[(c->front + c->size) % c->capacity] = p;
+    c->size++;
+}
+
+static Process *rq_pop_front(SmpCpu *c)
+{
+    Process *p = c->queue[c->front];
+    c->front = (c->front + 1) % c->capacity;
+    c->size--;
+    return p;
+}
+
+static Process *rq_pop_back(SmpCpu *c)
+{
+    c->size--;
+    return c->queue[(c->front + c->size) % c->capacity];
+}
+
+// (time, arrivals last, index): same-tick order matches the single-CPU
+// schedulers, which check I/O completions before new arrivals
+static int event_before(const SmpEvent *a, const SmpEvent *b)
+{
+    if (a->time != b->time)
+        return a->time < b->time;
+    if ((a->kind == EV_ARRIVE) != (b->kind == EV_ARRIVE))
+        return b->kind == EV_ARRIVE;
+    return a->index < b->index;
+}
+
+static void event_push(SmpCpu *c, SmpEvent ev)
+{
+    if (c->num_events == c->events_capacity)
+    {
+        c->events_capacity = c->events_capacity ? c->events_capacity * 2 : 16;
+        c->events = checked(realloc(c->events, c->events_capacity * sizeof(SmpEvent)));
+    }
+
+    int i = c->num_events++;
+    while (i > 0)
+    {
+        int parent = (i - 1) / 2;
+        if (!event_before(&ev, &c->events[parent]))
+            break;
+        c->events[i] = c->events[parent];
+        i = parent;
+    }
+    c->events[i] = ev;
+}
+
+static SmpEvent event_pop(SmpCpu *c)
+{
+    SmpEvent top = c->events[0];
+    SmpEvent last = c->events[--c->num_events];
+
+    int i = 0;
+    while (1)
+    {
+        int child = 2 * i + 1;
+        if (child >= c->num_events)
+            break;
+        if (child + 1 < c->num_events && event_before(&c->events[child + 1], &c->events[child]))
+            child++;
+        if (!event_before(&c->events[child], &last))
+            break;
+        c->events[i] = c->events[child];
+        i = child;
+    }
+    if (c->num_events > 0)
+        c->events[i] = last;
+    return top;
+}
+
+// ---------------------------------------------------------------------------
+// Cross-CPU messages
+// ---------------------------------------------------------------------------
+
+static void deliver(SmpMachine *m, int cpu, int index, sim_time_t time, smp_event_t kind)
+{
+    event_push(&m->cpus[cpu], (SmpEvent){time, index, kind});
+    if (kind == EV_MIGRATE)
+        m->cpus[cpu].inbound++;
+}
+
+// Called by the thread owning `from`. time is always past the current window.
+static void send(SmpMachine *m, SmpPartition *from, int index, int cpu, sim_time_t time, smp_event_t kind)
+{
+    SmpPartition *to = &m->parts[m->owner[cpu]];
+    if (to == from)
+    {
+        deliver(m, cpu, index, time, kind);
+        return;
+    }
+
+    //* MPSC push: any number of partitions may post to `to` concurrently
+    SmpMessage *msg = &m->messages[index];
+    msg->time = time;
+    msg->cpu = cpu;
+    msg->kind = kind;
+
+    SmpMessage *head = atomic_load_explicit(&to->inbox, memory_order_relaxed);
+    do
+    {
+        msg->next = head;
+    } while (!atomic_compare_exchange_weak_explicit(&to->inbox, &head, msg,
+                                                    memory_order_release, memory_order_relaxed));
+}
+
+// Owner side: take the whole mailbox at once, between windows
+static void drain(SmpMachine *m, SmpPartition *part)
+{
+    SmpMessage *msg = atomic_exchange_explicit(&part->inbox, NULL, memory_order_acquire);
+    for (; msg != NULL; msg = msg->next)
+        deliver(m, msg->cpu, (int)(msg - m->messages), msg->time, msg->kind);
+}
+
+// ---------------------------------------------------------------------------
+// Simulation
+// ---------------------------------------------------------------------------
+
+static void block(SmpMachine *m, SmpPartition *part, int cpu, Process *p, sim_time_t t)
+{
+    int index = (int)(p - m->processes);
+    sim_time_t wake = io_default_end(t, p->io_times[p->current_burst]);
+    int target = cpu;
+
+    //* Overloaded as of the last snapshot: wake up on the CPU the balancer
+    //* paired this one with, which costs a cross-CPU hop
+    if (m->cpus[cpu].migrate_count > 0)
+    {
+        target = m->cpus[cpu].migrate_to;
+        if (wake < t + 1 + m->window)
+            wake = t + 1 + m->window;
+        m->cpus[cpu].remote_wakeups++;
+        if (numa_enabled && numa_node(target) != numa_node(cpu))
+            m->cpus[cpu].cross_node_wakeups++;
+    }
+
+    p->state = BLOCKED;
+    send(m, part, index, target, wake, EV_WAKE);
+}
+
+static void migrate(SmpMachine *m, SmpPartition *part, int cpu, sim_time_t start)
+{
+    SmpCpu *c = &m->cpus[cpu];
+    for (int k = 0; k < c->migrate_count && c->size > 0; k++)
+    {
+        Process *p = rq_pop_back(c);
+        send(m, part, (int)(p - m->processes), c->migrate_to, start + m->window, EV_MIGRATE);
+        c->migrations++;
+        if (numa_enabled && numa_node(c->migrate_to) != numa_node(cpu))
+            c->cross_node_migrations++;
+    }
+}
+
+// Remote memory and a busy SMT sibling slow the process down: true while
+// the CPU has not yet put in a full tick of progress
+static int numa_stalled(SmpMachine *m, SmpCpu *c, int cpu, int index)
+{
+    int home = m->home[index];
+    c->numa_ticks++;
+    if (home != numa_node(cpu))
+        c->remote_ticks++;
+
+    c->credit += 100;
+    int cost = numa_tick_cost(cpu, home, c->sibling_busy);
+    if (c->credit < cost)
+    {
+        c->slowed_ticks++;
+        return 1;
+    }
+    c->credit -= cost;
+    return 0;
+}
+
+static void run_window(SmpMachine *m, SmpPartition *part, int cpu, sim_time_t start, sim_time_t end)
+{
+    SmpCpu *c = &m->cpus[cpu];
+
+    for (sim_time_t t = start; t < end; t++)
+    {
+        //* 1) Arrivals, I/O completions and migrations due now
+        while (c->num_events > 0 && c->events[0].time <= t)
+        {
+            SmpEvent ev = event_pop(c);
+            Process *p = &m->processes[ev.index];
+
+            if (ev.kind == EV_ARRIVE)
+            {
+                p->remaining_time = p->cpu_bursts[0];
+            }
+            else if (ev.kind == EV_WAKE)
+            {
+                p->remaining_time = p->cpu_bursts[++p->current_burst];
+                metrics_event(TRACE_UNBLOCK, ev.index, t);
+                c->transitions++;
+            }
+            else
+            {
+                c->inbound--;
+            }
+
+            p->state = READY;
+            rq_push(c, p);
+        }
+
+        //* 2) Nothing to run: jump to the next event, or to the end of the window
+        if (c->running == NULL && c->size == 0)
+        {
+            power_tick(cpu, 0, t);
+            if (c->num_events == 0 || c->events[0].time >= end)
+                break;
+            t = c->events[0].time - 1;
+            continue;
+        }
+
+        //* 3) Dispatch
+        if (c->running == NULL)
+        {
+            c->running = rq_pop_front(c);
+            c->running->state = RUNNING;
+            c->quantum_used = 0;
+            c->dispatches++;
+            cost_dispatch(c->running, cpu, t);
+            metrics_event(TRACE_DISPATCH, (int)(c->running - m->processes), t);
+            c->transitions++;
+
+            //* First touch: memory goes to the node the process first runs on
+            if (numa_enabled && m->home[c->running - m->processes] < 0)
+                m->home[c->running - m->processes] = numa_node(cpu);
+        }
+
+        //* 4) Execute
+        c->busy_ticks++;
+        if (power_tick(cpu, 1, t) != POWER_RUN || cost_stalled(cpu))
+            continue;
+        if (numa_enabled && numa_stalled(m, c, cpu, (int)(c->running - m->processes)))
+            continue;
+
+        Process *p = c->running;
+        p->last_ran = t;
+        p->remaining_time--;
+        c->quantum_used++;
+
+        if (p->remaining_time == 0)
+        {
+            if (p->current_burst == p->num_bursts - 1)
+            {
+                p->state = FINISHED;
+                p->completed_flag = 1;
+                m->finish[p - m->processes] = t + 1;
+                c->completed++;
+                c->transitions++;
+                if (metrics != NULL)
+                    latency_record(&part->latency, metrics, (int)(p - m->processes), t + 1);
+            }
+            else
+            {
+                block(m, part, cpu, p, t);
+                c->transitions++;
+            }
+            c->running = NULL;
+        }
+        else if (m->quantum > 0 && c->quantum_used >= m->quantum)
+        {
+            p->state = READY;
+            rq_push(c, p);
+            c->running = NULL;
+            metrics_event(TRACE_PREEMPT, (int)(p - m->processes), t + 1);
+            c->transitions++;
+        }
+    }
+}
+
+#define LOAD_BUCKETS 256
+
+// Pair the most loaded of n CPUs (order: least loaded first) with the
+// least loaded, the second with the second, ... and even each pair out
+static void pair_cpus(SmpMachine *m, const int *order, int n)
+{
+    for (int lo = 0, hi = n - 1; lo < hi; lo++, hi--)
+    {
+        SmpCpu *from = &m->cpus[order[hi]];
+        SmpCpu *to = &m->cpus[order[lo]];
+        if (from->load - to->load < 2)
+            break;
+        from->migrate_to = order[lo];
+        from->migrate_count = (from->load - to->load) / 2;
+        from->load -= from->migrate_count;
+        to->load += from->migrate_count;
+    }
+}
+
+//* Topology-aware balancing: even out the CPUs of each node first, then
+//* move work from the busiest node to the idlest one, but only past
+//* NUMA_IMBALANCE, since the moved processes will run away from their memory
+static void pair_numa(SmpMachine *m)
+{
+    int nodes = numa_topology.sockets;
+    int per_node = m->num_cpus / nodes;
+    int fill[NUMA_MAX_NODES];
+    long node_load[NUMA_MAX_NODES] = {0};
+
+    for (int n = 0; n < nodes; n++)
+        fill[n] = n * per_node;
+    for (int k = 0; k < m->num_cpus; k++)
+        m->node_order[fill[numa_node(m->order[k])]++] = m->order[k];
+
+    for (int n = 0; n < nodes; n++)
+    {
+        pair_cpus(m, m->node_order + n * per_node, per_node);
+        for (int k = 0; k < per_node; k++)
+            node_load[n] += m->cpus[m->node_order[n * per_node + k]].load;
+    }
+
+    int heavy = 0, light = 0;
+    for (int n = 1; n < nodes; n++)
+    {
+        if (node_load[n] > node_load[heavy])
+            heavy = n;
+        if (node_load[n] < node_load[light])
+            light = n;
+    }
+    if (heavy == light)
+        return;
+
+    const int *from_order = m->node_order + heavy * per_node;
+    const int *to_order = m->node_order + light * per_node;
+    for (int k = 0; k < per_node; k++)
+    {
+        SmpCpu *from = &m->cpus[from_order[per_node - 1 - k]];
+        SmpCpu *to = &m->cpus[to_order[k]];
+        int excess = from->load - to->load - NUMA_IMBALANCE;
+        if (from->migrate_count > 0 || to->migrate_count > 0 || excess < 2)
+            continue;
+        from->migrate_to = to_order[k];
+        from->migrate_count = excess / 2;
+        from->load -= from->migrate_count;
+        to->load += from->migrate_count;
+    }
+}
+
+// Runs on one thread between windows, after every mailbox has been drained
+static void plan_window(SmpMachine *m)
+{
+    long completed = 0;
+    long transitions = 0;
+    int busy = 0;
+    sim_time_t next_event = SIM_TIME_MAX;
+    int counts[LOAD_BUCKETS + 1] = {0};
+
+    for (int i = 0; i < m->num_cpus; i++)
+    {
+        SmpCpu *c = &m->cpus[i];
+        completed += c->completed;
+        transitions += c->transitions;
+        busy |= c->running != NULL || c->size > 0;
+        if (c->num_events > 0 && c->events[0].time < next_event)
+            next_event = c->events[0].time;
+
+        c->load = c->size + (c->running != NULL) + c->inbound;
+        c->migrate_count = 0;
+        counts[(c->load < LOAD_BUCKETS ? c->load : LOAD_BUCKETS - 1) + 1]++;
+    }
+
+    progress_publish(m->windows > 0 ? m->window_start + m->window : m->window_start, completed, transitions);
+
+    if (completed == m->num_processes || (!busy && next_event == SIM_TIME_MAX))
+    {
+        m->done = 1;
+        return;
+    }
+
+    //* Counting sort by load (capped). Ties go round-robin from a different
+    //* CPU every window, so the low CPU ids don't take every migration.
+    for (int b = 0; b < LOAD_BUCKETS; b++)
+        counts[b + 1] += counts[b];
+    int rotate = (int)(m->windows % m->num_cpus);
+    for (int k = 0; k < m->num_cpus; k++)
+    {
+        int i = (k + rotate) % m->num_cpus;
+        int load = m->cpus[i].load;
+        m->order[counts[load < LOAD_BUCKETS ? load : LOAD_BUCKETS - 1]++] = i;
+    }
+
+    //* SMT siblings slow each other down while both have work
+    if (numa_enabled && numa_topology.threads > 1)
+    {
+        for (int i = 0; i < m->num_cpus; i++)
+        {
+            int first = numa_first_sibling(i);
+            int busy = 0;
+            for (int s = first; s < first + numa_topology.threads; s++)
+                busy |= s != i && m->cpus[s].load > 0;
+            m->cpus[i].sibling_busy = busy;
+        }
+    }
+
+    if (numa_enabled)
+        pair_numa(m);
+    else
+        pair_cpus(m, m->order, m->num_cpus);
+
+    //* Every CPU idle until next_event: skip the empty windows
+    m->window_start += m->window;
+    if (!busy && next_event > m->window_start)
+        m->window_start = next_event;
+    m->windows++;
+}
+
+static void *partition_main(void *arg)
+{
+    SmpPartition *part = arg;
+    SmpMachine *m = part->m;
+
+    while (1)
+    {
+        drain(m, part);
+
+        if (pthread_barrier_wait(&m->barrier) == PTHREAD_BARRIER_SERIAL_THREAD)
+            plan_window(m);
+        pthread_barrier_wait(&m->barrier);
+
+        if (m->done)
+            break;
+
+        sim_time_t start = m->window_start;
+        for (int cpu = part->first; cpu < part->last; cpu++)
+            migrate(m, part, cpu, start);
+        for (int cpu = part->first; cpu < part->last; cpu++)
+            run_window(m, part, cpu, start, start + m->window);
+
+        pthread_barrier_wait(&m->barrier);
+    }
+
+    return NULL;
+}
+
+// ---------------------------------------------------------------------------
+// Setup and report
+// ---------------------------------------------------------------------------
+
+//* Summary of the last smp_schedule() run, printed by smp_report()
+static struct
+{
+    int ran;
+    int cpus;
+    int quantum;
+    int window;
+    int threads;
+    int processes;
+    sim_time_t makespan;
+    long windows;
+    long busy;
+    long min_busy;
+    long max_busy;
+    long dispatches;
+    long migrations;
+    long remote_wakeups;
+    int numa;
+    long numa_ticks;
+    long remote_ticks;
+    long slowed_ticks;
+    long cross_node_migrations;
+    long cross_node_wakeups;
+    double turnaround;
+    unsigned long long digest;
+} summary;
+
+static void collect(SmpMachine *m)
+{
+    memset(&summary, 0, sizeof(summary));
+    summary.ran = 1;
+    summary.cpus = m->num_cpus;
+    summary.quantum = m->quantum;
+    summary.window = m->window;
+    summary.threads = m->num_parts;
+    summary.processes = m->num_processes;
+    summary.windows = m->windows;
+    summary.numa = numa_enabled;
+    summary.min_busy = __LONG_MAX__;
+    summary.digest = 14695981039346656037ULL; // FNV-1a
+
+    for (int i = 0; i < m->num_cpus; i++)
+    {
+        SmpCpu *c = &m->cpus[i];
+        summary.busy += c->busy_ticks;
+        summary.dispatches += c->dispatches;
+        summary.migrations += c->migrations;
+        summary.remote_wakeups += c->remote_wakeups;
+        summary.numa_ticks += c->numa_ticks;
+        summary.remote_ticks += c->remote_ticks;
+        summary.slowed_ticks += c->slowed_ticks;
+        summary.cross_node_migrations += c->cross_node_migrations;
+        summary.cross_node_wakeups += c->cross_node_wakeups;
+        if (c->busy_ticks < summary.min_busy)
+            summary.min_busy = c->busy_ticks;
+        if (c->busy_ticks > summary.max_busy)
+            summary.max_busy = c->busy_ticks;
+    }
+
+    for (int i = 0; i < m->num_processes; i++)
+    {
+        if (m->finish[i] > summary.makespan)
+            summary.makespan = m->finish[i];
+        summary.turnaround += m->finish[i] - m->processes[i].arrival_time;
+        summary.digest = (summary.digest ^ (unsigned int)m->finish[i]) * 1099511628211ULL;
+    }
+}
+
+void smp_report(void)
+{
+    if (!summary.ran)
+        return;
+
+    sim_time_t makespan = summary.makespan > 0 ? summary.makespan : 1;
+    double capacity = (double)summary.cpus * makespan;
+
+    printf("\n=== SMP: %d CPUs, %s, window %d, %d thread%s ===\n",
+           summary.cpus, summary.quantum > 0 ? "RR" : "FIFO", summary.window,
+           summary.threads, summary.threads == 1 ? "" : "s");
+    printf("  processes:       %d\n", summary.processes);
+    printf("  makespan:        %" PRIdTIME " ticks (%ld windows)\n", summary.makespan, summary.windows);
+    printf("  utilization:     %.1f%% (per CPU min %.1f%%, max %.1f%%)\n",
+           100.0 * summary.busy / capacity,
+           100.0 * summary.min_busy / makespan,
+           100.0 * summary.max_busy / makespan);
+    printf("  avg turnaround:  %.2f ticks\n", summary.processes ? summary.turnaround / summary.processes : 0.0);
+    printf("  dispatches:      %ld\n", summary.dispatches);
+    printf("  migrations:      %ld\n", summary.migrations);
+    printf("  remote wakeups:  %ld\n", summary.remote_wakeups);
+    if (summary.numa)
+    {
+        printf("  numa:            %s\n", numa_describe());
+        printf("  remote memory:   %.1f%% of execution ticks (%ld ticks without progress)\n",
+               100.0 * smp_remote_fraction(), summary.slowed_ticks);
+        printf("  cross-node:      %ld migrations, %ld wakeups\n",
+               summary.cross_node_migrations, summary.cross_node_wakeups);
+    }
+    printf("  schedule digest: %016llx\n", summary.digest);
+}
+
+void smp_reset(void)
+{
+    memset(&summary, 0, sizeof(summary));
+}
+
+double smp_remote_fraction(void)
+{
+    if (!numa_enabled || summary.numa_ticks == 0)
+        return 0.0;
+    return (double)summary.remote_ticks / summary.numa_ticks;
+}
+
+long smp_cross_node_migrations(void)
+{
+    return numa_enabled ? summary.cross_node_migrations : 0;
+}
+
+long smp_cross_node_wakeups(void)
+{
+    return numa_enabled ? summary.cross_node_wakeups : 0;
+}
+
+void smp_schedule(Process processes[], int num_processes, const SmpConfig *config)
+{
+    SmpMachine m;
+    memset(&m, 0, sizeof(m));
+
+    m.processes = processes;
+    m.num_processes = num_processes;
+    m.num_cpus = config->cpus;
+    m.window = config->window;
+    m.quantum = config->quantum;
+    m.num_parts = config->threads < config->cpus ? config->threads : config->cpus;
+
+    m.cpus = checked(aligned_alloc(64, m.num_cpus * sizeof(SmpCpu)));
+    memset(m.cpus, 0, m.num_cpus * sizeof(SmpCpu));
+    m.parts = checked(calloc(m.num_parts, sizeof(SmpPartition)));
+    m.owner = checked(malloc(m.num_cpus * sizeof(int)));
+    m.order = checked(malloc(m.num_cpus * sizeof(int)));
+    m.node_order = checked(malloc(m.num_cpus * sizeof(int)));
+    m.home = checked(malloc((num_processes > 0 ? num_processes : 1) * sizeof(int)));
+    m.messages = checked(calloc(num_processes > 0 ? num_processes : 1, sizeof(SmpMessage)));
+    m.finish = checked(calloc(num_processes > 0 ? num_processes : 1, sizeof(sim_time_t)));
+
+    //* Contiguous CPU ranges per partition
+    for (int k = 0; k < m.num_parts; k++)
+    {
+        SmpPartition *part = &m.parts[k];
+        part->m = &m;
+        part->first = (int)((long)k * m.num_cpus / m.num_parts);
+        part->last = (int)((long)(k + 1) * m.num_cpus / m.num_parts);
+        atomic_init(&part->inbox, NULL);
+        for (int cpu = part->first; cpu < part->last; cpu++)
+            m.owner[cpu] = k;
+    }
+
+    //* Initial placement: round-robin over CPUs by workload position. With a
+    //* NUMA topology, processes with a home node spread over that node's
+    //* cores, the rest over the machine's, before doubling up on SMT siblings.
+    int placed[NUMA_MAX_NODES + 1] = {0};
+    for (int i = 0; i < num_processes; i++)
+    {
+        int cpu = i % m.num_cpus;
+        m.home[i] = -1;
+        if (numa_enabled)
+        {
+            if (processes[i].home_node >= 0)
+                m.home[i] = processes[i].home_node % numa_topology.sockets;
+            cpu = numa_spread(m.home[i], placed[m.home[i] + 1]++);
+        }
+        deliver(&m, cpu, i, processes[i].arrival_time, EV_ARRIVE);
+    }
+
+    // Start at the first arrival
+    m.window_start = -m.window;
+
+    pthread_barrier_init(&m.barrier, NULL, m.num_parts);
+    for (int k = 1; k < m.num_parts; k++)
+        pthread_create(&m.parts[k].thread, NULL, partition_main, &m.parts[k]);
+    partition_main(&m.parts[0]);
+    for (int k = 1; k < m.num_parts; k++)
+        pthread_join(m.parts[k].thread, NULL);
+    pthread_barrier_destroy(&m.barrier);
+
+    if (metrics != NULL)
+    {
+        for (int k = 0; k < m.num_parts; k++)
+            latency_merge(&metrics->latency, &m.parts[k].latency);
+    }
+    collect(&m);
+
+    for (int i = 0; i < m.num_cpus; i++)
+    {
+        free(m.cpus[i].queue);
+        free(m.cpus[i].events);
+    }
+    free(m.cpus);
+    free(m.parts);
+    free(m.owner);
+    free(m.order);
+    free(m.node_order);
+    free(m.home);
+    free(m.messages);
+    free(m.finish);
+}
@@ -0,0 +1,57 @@
+#ifndef SMP_H
+#define SMP_H
+
+#include "process.h"
+#include "cost.h"
+
+#define SMP_MAX_CPUS COST_MAX_CPUS
+
+//* Partitioned SMP simulation (--cpus)
+//
+// Every simulated CPU has its own run queue (FIFO, or RR with a quantum)
+// and takes arrivals, I/O completions and migrations from its own event
+// heap in a fixed (time, process index) order. The CPUs are split into
+// contiguous partitions, one per host thread.
+//
+// Time advances in windows of `window` ticks. All cross-CPU traffic
+// (load-balancing migrations, wakeups on another CPU) takes at least
+// `window` ticks to land, so during a window every CPU only depends on
+// its own state and the partitions can run without talking to each other.
+// Messages to another partition go through a lock-free MPSC mailbox that
+// its owner drains at the next barrier; the fixed heap order makes
+// the drain order irrelevant. Between windows one thread plans the next:
+// it snapshots per-CPU load, pairs the most and least loaded CPUs for
+// migration and skips over stretches where every CPU is idle.
+//
+// None of those decisions depend on how CPUs map to threads, so results
+// are identical for any --threads; the report prints a digest of all
+// finish times to check that.
+//
+// With --numa (see numa.h) placement and balancing follow the topology:
+// CPUs even out within a node first, and work moves across nodes only
+// when the nodes' loads differ by more than NUMA_IMBALANCE per CPU pair.
+//
+// I/O uses the default device timing (no --devices contention).
+
+typedef struct SmpConfig
+{
+    int cpus;
+    int threads;
+    int window;     // lookahead: migration / remote wakeup latency in ticks
+    int quantum;    // 0 = FIFO (run each burst to completion), else RR
+} SmpConfig;
+
+void smp_schedule(Process processes[], int num_processes, const SmpConfig *config);
+
+// Summary of the last run
+void smp_report(void);
+
+// Forget the last run's summary (between runs)
+void smp_reset(void);
+
+// NUMA stats of the last run, 0 without --numa
+double smp_remote_fraction(void);
+long smp_cross_node_migrations(void);
+long smp_cross_node_wakeups(void);
+
+#endif
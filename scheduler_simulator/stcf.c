@@ -106,54 +106,51 @@
 
 
 #include <stdio.h>
+#include <stdlib.h>
 #include "stcf.h"
+#include "io_device.h"
+#include "cost.h"
+#include "power.h"
+#include "trace.h"
+#include "group.h"
+#include "profile.h"
+#include "predict.h"
+#include "arrivals.h"
+#include "horizon.h"
+
+static void *checked(void *ptr)
+{
+    if (ptr == NULL)
+    {
+        fprintf(stderr, "stcf: out of memory\n");
+        exit(1);
+    }
+    return ptr;
+}
 
-// Initialize empty queue
-void Init_Queue(ReadyQ *q)
+// Initialize empty queue, the structure chosen for this workload (--rq)
+void Init_Queue(ReadyQ *q, Process processes[], int num_processes)
 {
-    q->size = 0;
+    sim_time_t key_range = rq_key_range(processes, num_processes);
+    rq_init(q, rq_choose(num_processes, key_range), num_processes, key_range);
 }
 
-// Enqueue logic
+// Enqueue logic: keyed by the burst key, which stays put while queued
 void Enqueue_(ReadyQ *q, Process *p)
 {
-    if (q->size >= MAX_PROCESSES)
-        return; // Queue full
-
-    q->queue[q->size] = p; // Add at the end
+    PROF_COUNT(COUNT_ENQUEUE);
+    rq_push(q, p, burst_key(p));
     p->in_queue = 1;
-    q->size++;
 }
 
 // dequeue laogic
 Process *dequeue_Shortest(ReadyQ *q)
 {
-    if (q->size == 0)
+    Process *shortest_process = rq_pop(q);
+    if (shortest_process == NULL)
         return NULL; // Queue empty
 
-    int shortest_time = __INT_MAX__;
-    int shortest_index = 0;
-
-    for (int i = 0; i < q->size; i++)
-    {
-        if (q->queue[i]->remaining_time < shortest_time)
-        {
-            shortest_time = q->queue[i]->remaining_time;
-            shortest_index = i;
-        }
-    }
-
-    Process *shortest_process = q->queue[shortest_index];
-
-    // Shift all elements left
-    for (int i = shortest_index; i < q->size - 1; i++)
-    {
-        q->queue[i] = q->queue[i + 1];
-    }
-
-    q->queue[q->size - 1] = NULL; // Optional safety step
-    q->size--;
-
+    PROF_COUNT(COUNT_DEQUEUE);
     shortest_process->in_queue = 0;
 
     return shortest_process;
@@ -162,57 +159,53 @@ Process *dequeue_Shortest(ReadyQ *q)
 // Check if queue is empty
 int Is_Empty(ReadyQ *q)
 {
-    return q->size == 0;
+    return rq_size(q) == 0;
 }
 
-void Check_New_Arrivals(Process processes[], int num_processes, int current_time, ReadyQ *q)
+void Check_New_Arrivals(Process processes[], ArrivalCursor *arrivals, sim_time_t current_time, ReadyQ *q)
 {
-    for (int i = 0; i < num_processes; i++)
+    for (int i; (i = arrivals_next(arrivals, processes, current_time)) >= 0; )
     {
-        if (processes[i].arrival_time == current_time && processes[i].completed_flag == 0)
+        if (processes[i].completed_flag == 0)
         {
             Enqueue_(q, &processes[i]);
         }
     }
 }
 
-int find_shortest_in_queue(ReadyQ *q) {
-    
-    if (q->size == 0)
-        return __INT_MAX__;  // No processes in queue
-        
-    int shortest_time = __INT_MAX__;
-    
-    for (int i = 0; i < q->size; i++) 
-    {
-        if (q->queue[i]->remaining_time < shortest_time) 
-        {
-            shortest_time = q->queue[i]->remaining_time;
-        }
-    }
+static int runnable(const Process *p)
+{
+    return !group_throttled(p);
+}
+
+double find_shortest_in_queue(ReadyQ *q) {
     
-    return shortest_time;
+    if (rq_size(q) == 0)
+        return __DBL_MAX__;  // No processes in queue
+
+    // Throttled processes can't run now, so they can't preempt either
+    return rq_min_key_if(q, groups_enabled ? runnable : NULL);
 }
 
-void Printing_(Process processes[], int num_processes, int current_time, Process *running_process, ReadyQ rq, int completed)
+// ready: room for every process, to list the ready queue in
+void Printing_(Process processes[], int num_processes, sim_time_t current_time, Process *running_process, ReadyQ rq, int completed,
+               Process **ready)
 {
-    printf("\n=== Time %d ===\n", current_time);
+    trace_line(TEXT_TICK, NULL, current_time, 0, 0);
 
     // Print what happened during I/O completions
     for (int i = 0; i < num_processes; i++)
     {
         if (processes[i].state == BLOCKED && processes[i].io_end_time == current_time)
         {
-            printf("  ✓ %s completed I/O, ", processes[i].pid);
             if (processes[i].current_burst + 1 < processes[i].num_bursts)
             {
-                printf("moving to CPU burst %d (duration: %d)\n",
-                       processes[i].current_burst + 1,
-                       processes[i].cpu_bursts[processes[i].current_burst + 1]);
+                trace_line(TEXT_IO_DONE, &processes[i], current_time, processes[i].current_burst + 1,
+                           processes[i].cpu_bursts[processes[i].current_burst + 1]);
             }
             else
             {
-                printf("all bursts completed - FINISHED\n");
+                trace_line(TEXT_IO_DONE, &processes[i], current_time, -1, 0);
             }
         }
     }
@@ -222,102 +215,90 @@ void Printing_(Process processes[], int num_processes, int current_time, Process
     {
         if (processes[i].arrival_time == current_time)
         {
-            printf("  → %s arrived and added to ready queue\n", processes[i].pid);
+            trace_line(TEXT_ARRIVED, &processes[i], current_time, 0, 0);
         }
     }
 
     // Print CPU assignment
     if (running_process == NULL && !Is_Empty(&rq))
     {
-        int shortest_idx = 0;
-        for (int i = 1; i < rq.size; i++)
-        {
-            if (rq.queue[i]->remaining_time < rq.queue[shortest_idx]->remaining_time)
-            {
-                shortest_idx = i;
-            }
-        }
-        Process *next = rq.queue[shortest_idx];
+        Process *next = rq_peek(&rq);
 
-        printf("  🖥️  CPU assigned to %s (burst %d, duration: %d)\n",
-               next->pid, next->current_burst, next->remaining_time);
+        trace_line(TEXT_ASSIGNED, next, current_time, 0, 0);
+        trace_line(TEXT_ASSIGNED_REST, next, current_time, next->current_burst, next->remaining_time);
     }
 
     // Print execution
     if (running_process != NULL)
     {
-        printf("  ⚡ %s executing (remaining: %d → %d)\n",
-               running_process->pid,
-               running_process->remaining_time,
-               running_process->remaining_time - 1);
+        trace_line(TEXT_EXECUTING, running_process, current_time, running_process->remaining_time, 0);
 
         // Check if this will complete the burst
         if (running_process->remaining_time == 1)
         {
             if (running_process->current_burst == running_process->num_bursts - 1)
             {
-                printf("     └─ Will FINISH after this tick\n");
+                trace_line(TEXT_WILL_FINISH, running_process, current_time, 0, 0);
             }
             else
             {
-                int io_duration = running_process->io_times[running_process->current_burst];
-                printf("     └─ Will go to I/O (duration: %d) after this tick\n", io_duration);
+                sim_time_t io_duration = running_process->io_times[running_process->current_burst];
+                trace_line(TEXT_WILL_IO, running_process, current_time, io_duration, 0);
             }
         }
     }
     else
     {
-        printf("  💤 CPU: IDLE\n");
+        trace_line(TEXT_IDLE_NOTE, NULL, current_time, 0, 0);
     }
 
     // Print current system state
-    printf("  📊 System State:\n");
-    printf("     Running: ");
+    trace_line(TEXT_STATE, NULL, current_time, 0, 0);
     if (running_process != NULL)
     {
-        printf("%s (burst %d, remaining: %d after execution)\n",
-               running_process->pid, running_process->current_burst,
-               running_process->remaining_time - 1);
+        trace_line(TEXT_RUNNING, running_process, current_time, 0, 0);
+        trace_line(TEXT_RUNNING_REST, running_process, current_time, running_process->current_burst,
+                   running_process->remaining_time - 1);
     }
     else
     {
-        printf("None\n");
+        trace_line(TEXT_RUNNING_NONE, NULL, current_time, 0, 0);
     }
 
-    printf("     Ready Queue: [");
-    for (int i = 0; i < rq.size; i++)
-    {
-        printf("%s", rq.queue[i]->pid);
-        if (i < rq.size - 1)
-            printf(", ");
-    }
-    printf("]\n");
+    trace_line(TEXT_READY_OPEN, NULL, current_time, 0, 0);
+    int num_ready = rq_snapshot(&rq, ready);
+    for (int i = 0; i < num_ready; i++)
+        trace_line(TEXT_ITEM, ready[i], current_time, 0, 0);
+    trace_line(TEXT_CLOSE, NULL, current_time, 0, 0);
 
-    printf("     Blocked (I/O): [");
-    int first_blocked = 1;
+    trace_line(TEXT_BLOCKED_OPEN, NULL, current_time, 0, 0);
     for (int i = 0; i < num_processes; i++)
     {
         if (processes[i].state == BLOCKED)
         {
-            if (!first_blocked)
-                printf(", ");
-            printf("%s(ends@%d)", processes[i].pid, processes[i].io_end_time);
-            first_blocked = 0;
+            if (io_is_queued(&processes[i]))
+                trace_line(TEXT_ITEM_QUEUED, &processes[i], current_time, 0, 0);
+            else
+                trace_line(TEXT_ITEM_ENDS, &processes[i], current_time, processes[i].io_end_time, 0);
         }
     }
-    printf("]\n");
+    trace_line(TEXT_CLOSE, NULL, current_time, 0, 0);
 
-    printf("     Completed: %d/%d\n", completed, num_processes);
+    trace_line(TEXT_COMPLETED, NULL, current_time, completed, num_processes);
 }
 
 void stcf_schedule(Process processes[], int num_processes)
 {
     ReadyQ rq;
-    Init_Queue(&rq);
+    Init_Queue(&rq, processes, num_processes);
+    //* Scratch for the text trace's ready-queue listing, reused every tick
+    Process **ready = checked(malloc((num_processes > 0 ? num_processes : 1) * sizeof(Process *)));
+    ArrivalCursor arrivals;
+    arrivals_begin(&arrivals, processes, num_processes);
 
     Process *running_process = NULL;
 
-    int current_time = 0;
+    sim_time_t current_time = 0;
     int completed = 0;
 
     // @note
@@ -331,72 +312,140 @@ void stcf_schedule(Process processes[], int num_processes)
 
     while (completed < num_processes)
     {
+        PROF_COUNT(COUNT_TICKS);
+        PROF_BEGIN(PHASE_IO);
+
+        //* 0) Advance I/O devices (frees units, starts queued requests)
+        io_tick(current_time);
+
+        // Groups whose period rolled over hand their parked processes back
+        Process *released;
+        while ((released = group_release(current_time)) != NULL)
+            Enqueue_(&rq, released);
+
         //* 1) Check I/O completions (blocked -> ready)
-        for (int i = 0; i < num_processes; i++)
-        {
-            if (processes[i].state == BLOCKED && processes[i].io_end_time == current_time)
-            { // i/o burst completed
-
-                processes[i].state = READY;
-                processes[i].current_burst++; // Move to next CPU burst
-
-                // Check if CPU bursts are remaining or not
-                if (processes[i].current_burst < processes[i].num_bursts)
-                { // More CPU bursts remaining
-
-                    processes[i].remaining_time = processes[i].cpu_bursts[processes[i].current_burst];
-                    
-                    if (!processes[i].in_queue)
-                    {
-                        Enqueue_(&rq, &processes[i]);
-                    }
-                }
-                else
+        Process *done;
+        while ((done = io_next_done(current_time)) != NULL)
+        { // i/o burst completed
+            int i = done - processes;
+            PROF_COUNT(COUNT_PROCESS_SCAN);
+
+            processes[i].state = READY;
+            trace_event(TRACE_UNBLOCK, i, current_time);
+            processes[i].current_burst++; // Move to next CPU burst
+
+            // Check if CPU bursts are remaining or not
+            if (processes[i].current_burst < processes[i].num_bursts)
+            { // More CPU bursts remaining
+
+                processes[i].remaining_time = processes[i].cpu_bursts[processes[i].current_burst];
+                
+                if (!processes[i].in_queue)
                 {
-                    // No more CPU bursts - process is finished
-                    processes[i].state = FINISHED;
-                    processes[i].completed_flag = 1;
-                    completed++;
+                    Enqueue_(&rq, &processes[i]);
                 }
             }
+            else
+            {
+                // No more CPU bursts - process is finished
+                processes[i].state = FINISHED;
+                processes[i].completed_flag = 1;
+                completed++;
+                trace_event(TRACE_FINISH, i, current_time);
+            }
         }
 
+        PROF_END(PHASE_IO);
+        PROF_BEGIN(PHASE_ARRIVALS);
+
         //* 2) Check new arrivals
-        Check_New_Arrivals(processes, num_processes, current_time, &rq);
+        Check_New_Arrivals(processes, &arrivals, current_time, &rq);
+
 
+        PROF_END(PHASE_ARRIVALS);
+        PROF_BEGIN(PHASE_SELECT);
 
         //* 3) Check if currently running process needs to be preempted
         if (running_process != NULL && !Is_Empty(&rq)) {
             // Find shortest in ready queue
-            int shortest_remaining = find_shortest_in_queue(&rq);
-            if (shortest_remaining < running_process->remaining_time) 
+            double shortest_remaining = find_shortest_in_queue(&rq);
+            if (shortest_remaining < burst_key(running_process)) 
             {
                 // Preempt: move current process back to ready queue
                 running_process->state = READY;
                 Enqueue_(&rq, running_process);
+                trace_event(TRACE_PREEMPT, running_process - processes, current_time);
+                PROF_COUNT(COUNT_PREEMPT);
                 running_process = NULL;  // Will be reassigned in next step
             }
         }
 
 
         //* 4) Assign CPU if needed
-        if (running_process == NULL && !Is_Empty(&rq))
+        while (running_process == NULL && !Is_Empty(&rq))
         {
             running_process = dequeue_Shortest(&rq);
+            if (group_throttled(running_process))
+            {
+                // Group is out of quota: the process waits there, try the next one
+                group_park(running_process, current_time);
+                running_process = NULL;
+                continue;
+            }
             running_process->state = RUNNING;
+            cost_dispatch(running_process, 0, current_time);
+            trace_event(TRACE_DISPATCH, running_process - processes, current_time);
+            PROF_COUNT(COUNT_DISPATCH);
         }
 
+        PROF_END(PHASE_SELECT);
+        PROF_BEGIN(PHASE_EXECUTE);
+
         //* 5) Execution
-        if (running_process != NULL)
+        int slowed = power_tick(0, running_process != NULL, current_time);
+
+        if (running_process != NULL && slowed != POWER_RUN)
+        {
+            // Waking from an idle state / below top frequency: busy, no progress
+            if (trace_text)
+            {
+                if (slowed == POWER_WAKING)
+                    trace_line(TEXT_WAKING, running_process, current_time, 0, 0);
+                else
+                    trace_line_ghz(TEXT_SLOW, running_process, current_time, power_frequency(0));
+            }
+        }
+        else if (running_process != NULL && cost_stalled(0))
+        {
+            // Context switch / cache refill: CPU busy, process makes no progress
+            if (trace_text)
+            {
+                trace_line(TEXT_SWITCHING, running_process, current_time, 0, 0);
+            }
+        }
+        else if (running_process != NULL)
         {
             // printf("Running: %s (remaining: %d) \n", running_process->pid, running_process->remaining_time);
-            Printing_(processes, num_processes, current_time, running_process, rq, completed);
+            if (trace_text)
+            {
+                PROF_BEGIN(PHASE_PRINT);
+                Printing_(processes, num_processes, current_time, running_process, rq, completed, ready);
+                PROF_END(PHASE_PRINT);
+            }
+            //* Up to the next event at once when nothing needs every tick (horizon.h)
+            sim_time_t run = horizon_run(&arrivals, processes, current_time,
+                                         running_process->remaining_time, SIM_TIME_MAX);
+            PROF_ADD(COUNT_TICKS, run - 1);
+            current_time += run - 1;
+            running_process->last_ran = current_time;
             // ! run and try to understand which of the two will be up and down
-            running_process->remaining_time--;
+            running_process->remaining_time -= run;
+            int throttled = group_charge(running_process, current_time);
 
             // Check if current CPU burst is complete
             if (running_process->remaining_time == 0)
             {
+                predict_observe(running_process);
 
                 // Check if this was the last CPU burst
                 if (running_process->current_burst == running_process->num_bursts - 1)
@@ -405,24 +454,50 @@ void stcf_schedule(Process processes[], int num_processes)
                     running_process->state = FINISHED;
                     running_process->completed_flag = 1;
                     completed++;
+                    trace_event(TRACE_FINISH, running_process - processes, current_time + 1);
                     running_process = NULL;
                 }
                 else
                 {
                     // Move to I/O
                     running_process->state = BLOCKED;
-                    int io_duration = running_process->io_times[running_process->current_burst];
-                    running_process->io_end_time = current_time + io_duration + 1;
+                    io_submit(running_process, current_time);
+                    trace_event(TRACE_BLOCK, running_process - processes, current_time + 1);
                     running_process = NULL;
                 }
             }
+            else if (throttled)
+            {
+                // Group ran out of quota: off the CPU until its next period
+                running_process->state = READY;
+                group_park(running_process, current_time + 1);
+                trace_event(TRACE_PREEMPT, running_process - processes, current_time + 1);
+                PROF_COUNT(COUNT_PREEMPT);
+                running_process = NULL;
+            }
         }
         else
         {
-            printf("[Time %d] ", current_time);
-            printf("CPU: IDLE \n");
+            PROF_COUNT(COUNT_IDLE_TICKS);
+            if (trace_text)
+            {
+                trace_line_str(TEXT_IDLE, NULL, current_time, 0, power_idle_name(0));
+            }
+
+            // Idle until the next event (horizon.h)
+            sim_time_t last = horizon_idle(&arrivals, processes, current_time);
+            PROF_ADD(COUNT_TICKS, last - current_time);
+            PROF_ADD(COUNT_IDLE_TICKS, last - current_time);
+            current_time = last;
         }
 
+        PROF_END(PHASE_EXECUTE);
+
         current_time++;
+        progress_tick(current_time, completed);
     }
-}
\ No newline at end of file
+
+    arrivals_end(&arrivals);
+    rq_free(&rq);
+    free(ready);
+}
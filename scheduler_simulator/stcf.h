@@ -2,14 +2,9 @@
 #define STCF_H
 
 #include "process.h"
+#include "readyq.h"
 
-#define MAX_PROCESSES 100
-
-typedef struct ReadyQ
-{
-    Process* queue[MAX_PROCESSES];
-    int size;
-}ReadyQ;
+typedef ReadyQueue ReadyQ;  // ordered by burst_key(), see readyq.h
 
 void stcf_schedule(Process processes[], int num_processes);
 
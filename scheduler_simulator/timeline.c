@@ -0,0 +1,214 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "timeline.h"
+#include "trace.h"
+
+#define TIMELINE_MAGIC "SCTL"
+#define TIMELINE_VERSION 2
+
+Timeline *timeline = NULL;
+
+static const char *state_names[] = {"READY", "RUNNING", "BLOCKED"};
+
+static void *checked(void *ptr)
+{
+    if (ptr == NULL)
+    {
+        fprintf(stderr, "timeline: out of memory\n");
+        exit(1);
+    }
+    return ptr;
+}
+
+static void flush_block(Timeline *t)
+{
+    if (t->columnar == NULL || t->count == 0)
+        return;
+
+    uint32_t count = (uint32_t)t->count;
+    fwrite(&count, sizeof(count), 1, t->columnar);
+    fwrite(t->col_pid, sizeof(int32_t), t->count, t->columnar);
+    fwrite(t->col_cpu, sizeof(int32_t), t->count, t->columnar);
+    fwrite(t->col_start, sizeof(int64_t), t->count, t->columnar);
+    fwrite(t->col_end, sizeof(int64_t), t->count, t->columnar);
+    fwrite(t->col_state, 1, t->count, t->columnar);
+    t->count = 0;
+}
+
+static void write_span(Timeline *t, int pid_index, int state, sim_time_t start, sim_time_t end)
+{
+    int cpu = state == SPAN_RUNNING ? 0 : -1; // single-CPU schedulers
+    t->spans++;
+
+    if (t->csv != NULL)
+    {
+        fprintf(t->csv, "%s,%d,%" PRIdTIME ",%" PRIdTIME ",%s\n",
+                t->processes[pid_index].pid, cpu, start, end, state_names[state]);
+    }
+
+    if (t->columnar != NULL)
+    {
+        t->col_pid[t->count] = pid_index;
+        t->col_cpu[t->count] = cpu;
+        t->col_start[t->count] = start;
+        t->col_end[t->count] = end;
+        t->col_state[t->count] = (unsigned char)state;
+        if (++t->count == TIMELINE_BLOCK)
+            flush_block(t);
+    }
+}
+
+// Close the open span of pid_index at `end`. The last closed span is held
+// back so that RUNNING -> (0-tick READY) -> RUNNING, e.g. RR re-picking the
+// only ready process, comes out as one run.
+static void emit(Timeline *t, int pid_index, sim_time_t end)
+{
+    int state = t->state[pid_index];
+    sim_time_t start = t->start[pid_index];
+    if (state == SPAN_CLOSED || end <= start)
+        return; // nothing open, or a zero-length span
+
+    if (t->held_state[pid_index] == state && t->held_end[pid_index] == start)
+    {
+        t->held_end[pid_index] = end;
+        return;
+    }
+
+    if (t->held_state[pid_index] != SPAN_CLOSED)
+        write_span(t, pid_index, t->held_state[pid_index], t->held_start[pid_index], t->held_end[pid_index]);
+
+    t->held_state[pid_index] = (unsigned char)state;
+    t->held_start[pid_index] = start;
+    t->held_end[pid_index] = end;
+}
+
+void timeline_event(Timeline *t, int type, int pid_index, sim_time_t time)
+{
+    emit(t, pid_index, time);
+
+    switch (type)
+    {
+    case TRACE_DISPATCH:
+        t->state[pid_index] = SPAN_RUNNING;
+        break;
+    case TRACE_PREEMPT:
+    case TRACE_UNBLOCK:
+        t->state[pid_index] = SPAN_READY;
+        break;
+    case TRACE_BLOCK:
+        t->state[pid_index] = SPAN_BLOCKED;
+        break;
+    default:
+        t->state[pid_index] = SPAN_CLOSED;
+        break;
+    }
+    t->start[pid_index] = time;
+}
+
+int timeline_open(const char *csv_path, const char *columnar_path, Process processes[], int num_processes)
+{
+    Timeline *t = checked(calloc(1, sizeof(Timeline)));
+
+    if (csv_path != NULL)
+    {
+        t->csv = fopen(csv_path, "w");
+        if (t->csv == NULL)
+        {
+            perror(csv_path);
+            free(t);
+            return -1;
+        }
+        fprintf(t->csv, "pid,cpu,start,end,state\n");
+    }
+
+    if (columnar_path != NULL)
+    {
+        t->columnar = fopen(columnar_path, "wb");
+        if (t->columnar == NULL)
+        {
+            perror(columnar_path);
+            if (t->csv != NULL)
+                fclose(t->csv);
+            free(t);
+            return -1;
+        }
+
+        uint8_t version = TIMELINE_VERSION;
+        uint32_t n = (uint32_t)num_processes;
+        fwrite(TIMELINE_MAGIC, 1, 4, t->columnar);
+        fwrite(&version, 1, 1, t->columnar);
+        fwrite(&n, sizeof(n), 1, t->columnar);
+        for (int i = 0; i < num_processes; i++)
+        {
+            size_t len = strlen(processes[i].pid);
+            uint16_t len16 = (uint16_t)(len > UINT16_MAX ? UINT16_MAX : len);
+            fwrite(&len16, sizeof(len16), 1, t->columnar);
+            fwrite(processes[i].pid, 1, len16, t->columnar);
+        }
+
+        t->col_pid = checked(malloc(TIMELINE_BLOCK * sizeof(int32_t)));
+        t->col_cpu = checked(malloc(TIMELINE_BLOCK * sizeof(int32_t)));
+        t->col_start = checked(malloc(TIMELINE_BLOCK * sizeof(int64_t)));
+        t->col_end = checked(malloc(TIMELINE_BLOCK * sizeof(int64_t)));
+        t->col_state = checked(malloc(TIMELINE_BLOCK));
+    }
+
+    //* Every process starts READY at its arrival; its first event is a dispatch
+    t->processes = processes;
+    t->num_processes = num_processes;
+    size_t slots = num_processes > 0 ? num_processes : 1;
+    t->state = checked(malloc(slots));
+    t->start = checked(malloc(slots * sizeof(sim_time_t)));
+    t->held_state = checked(malloc(slots));
+    t->held_start = checked(malloc(slots * sizeof(sim_time_t)));
+    t->held_end = checked(malloc(slots * sizeof(sim_time_t)));
+    for (int i = 0; i < num_processes; i++)
+    {
+        t->state[i] = SPAN_READY;
+        t->start[i] = processes[i].arrival_time;
+        t->held_state[i] = SPAN_CLOSED;
+    }
+
+    timeline = t;
+    return 0;
+}
+
+void timeline_close(void)
+{
+    Timeline *t = timeline;
+    if (t == NULL)
+        return;
+
+    for (int i = 0; i < t->num_processes; i++)
+    {
+        if (t->held_state[i] != SPAN_CLOSED)
+            write_span(t, i, t->held_state[i], t->held_start[i], t->held_end[i]);
+    }
+
+    if (t->csv != NULL)
+        fclose(t->csv);
+
+    if (t->columnar != NULL)
+    {
+        flush_block(t);
+        uint32_t end = 0;
+        fwrite(&end, sizeof(end), 1, t->columnar);
+        fclose(t->columnar);
+    }
+
+    free(t->col_pid);
+    free(t->col_cpu);
+    free(t->col_start);
+    free(t->col_end);
+    free(t->col_state);
+    free(t->state);
+    free(t->start);
+    free(t->held_state);
+    free(t->held_start);
+    free(t->held_end);
+    free(t);
+    timeline = NULL;
+}
@@ -0,0 +1,64 @@
+#ifndef TIMELINE_H
+#define TIMELINE_H
+
+#include <stdio.h>
+
+#include "process.h"
+
+//* Gantt/timeline export
+//
+// Instead of per-tick rows, each process's life is run-length encoded into
+// intervals [start, end) spent in one state, emitted when the state
+// changes. Cost and output size scale with the number of transitions, not
+// with simulated time.
+//
+// CSV:      pid,cpu,start,end,state        (cpu is -1 off-CPU)
+//
+// Columnar: little-endian, blocks of up to TIMELINE_BLOCK records
+//   "SCTL" <u8 version> <u32 num_processes> { <u16 len> <pid bytes> }...
+//   per block: <u32 count> <i32 pid_index[count]> <i32 cpu[count]>
+//              <i64 start[count]> <i64 end[count]> <u8 state[count]>
+//   <u32 0> terminates the file
+
+#define TIMELINE_BLOCK 65536
+
+typedef enum {
+    SPAN_READY, SPAN_RUNNING, SPAN_BLOCKED,
+    SPAN_CLOSED = 0xff      // no open span (not arrived / finished)
+} span_state_t;
+
+typedef struct Timeline
+{
+    FILE *csv;
+    FILE *columnar;
+
+    Process *processes;
+    int num_processes;
+    unsigned char *state;   // open span per process
+    sim_time_t *start;
+    unsigned char *held_state;  // last closed span, held back for merging
+    sim_time_t *held_start;
+    sim_time_t *held_end;
+
+    // columnar block being filled
+    int *col_pid;
+    int *col_cpu;
+    sim_time_t *col_start;
+    sim_time_t *col_end;
+    unsigned char *col_state;
+    int count;
+
+    long spans;
+} Timeline;
+
+extern Timeline *timeline;
+
+// Either path may be NULL
+int timeline_open(const char *csv_path, const char *columnar_path, Process processes[], int num_processes);
+void timeline_close(void);
+
+// State transition of processes[pid_index] at tick boundary `time`
+// (type is a trace_event_t)
+void timeline_event(Timeline *t, int type, int pid_index, sim_time_t time);
+
+#endif
@@ -0,0 +1,429 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+#include <sys/stat.h>
+
+#include "trace.h"
+
+#define TRACE_MAGIC "SCHT"
+#define TRACE_VERSION 1
+#define TRACE_BUFFER_SIZE (1 << 16)
+#define VARINT_MAX_BYTES 10
+
+int trace_text = 1;
+TraceWriter *trace_writer = NULL;
+
+static const char *event_names[] = {
+    "?", "DISPATCH", "PREEMPT", "BLOCK", "UNBLOCK", "FINISH"
+};
+
+const char *trace_event_name(int type)
+{
+    return type >= TRACE_DISPATCH && type <= TRACE_FINISH ? event_names[type] : "?";
+}
+
+// ---------------------------------------------------------------------------
+// Text trace
+// ---------------------------------------------------------------------------
+
+#define LINE_BUFFER_SIZE 256
+
+int trace_format_line(char *buf, size_t room, const TraceRecord *r, const char *pid, int *first)
+{
+    switch (r->type)
+    {
+    case TEXT_TICK:
+        return snprintf(buf, room, "\n=== Time %" PRIdTIME " ===\n", r->time);
+    case TEXT_IO_DONE:
+        if (r->a < 0)
+            return snprintf(buf, room, "  ✓ %s completed I/O, all bursts completed - FINISHED\n", pid);
+        return snprintf(buf, room, "  ✓ %s completed I/O, moving to CPU burst %d (duration: %" PRIdTIME ")\n",
+                        pid, (int)r->a, r->b);
+    case TEXT_ARRIVED:
+        return snprintf(buf, room, "  → %s arrived and added to ready queue\n", pid);
+    case TEXT_ARRIVED_PRIO:
+        return snprintf(buf, room, "  → %s arrived (priority %d) and added to ready queue\n", pid, (int)r->a);
+    case TEXT_ASSIGNED:
+        return snprintf(buf, room, "  🖥️  CPU assigned to %s (", pid);
+    case TEXT_PRIORITY:
+        return snprintf(buf, room, "priority %d, ", (int)r->a);
+    case TEXT_ASSIGNED_REST:
+        return snprintf(buf, room, "burst %d, duration: %" PRIdTIME ")\n", (int)r->a, r->b);
+    case TEXT_EXECUTING:
+        return snprintf(buf, room, "  ⚡ %s executing (remaining: %" PRIdTIME " → %" PRIdTIME ")\n",
+                        pid, r->a, r->a - 1);
+    case TEXT_WILL_FINISH:
+        return snprintf(buf, room, "     └─ Will FINISH after this tick\n");
+    case TEXT_WILL_IO:
+        return snprintf(buf, room, "     └─ Will go to I/O (duration: %" PRIdTIME ") after this tick\n", r->a);
+    case TEXT_IDLE_NOTE:
+        return snprintf(buf, room, "  💤 CPU: IDLE\n");
+    case TEXT_STATE:
+        return snprintf(buf, room, "  📊 System State:\n     Running: ");
+    case TEXT_RUNNING:
+        return snprintf(buf, room, "%s (", pid);
+    case TEXT_RUNNING_REST:
+        return snprintf(buf, room, "burst %d, remaining: %" PRIdTIME " after execution)\n", (int)r->a, r->b);
+    case TEXT_RUNNING_NONE:
+        return snprintf(buf, room, "None\n");
+    case TEXT_READY_OPEN:
+        *first = 1;
+        return snprintf(buf, room, "     Ready Queue: [");
+    case TEXT_BLOCKED_OPEN:
+        *first = 1;
+        return snprintf(buf, room, "     Blocked (I/O): [");
+    case TEXT_ITEM:
+    case TEXT_ITEM_PRIO:
+    case TEXT_ITEM_QUEUED:
+    case TEXT_ITEM_ENDS:
+    {
+        const char *separator = *first ? "" : ", ";
+        *first = 0;
+        if (r->type == TEXT_ITEM_PRIO)
+            return snprintf(buf, room, "%s%s(p%d)", separator, pid, (int)r->a);
+        if (r->type == TEXT_ITEM_QUEUED)
+            return snprintf(buf, room, "%s%s(queued)", separator, pid);
+        if (r->type == TEXT_ITEM_ENDS)
+            return snprintf(buf, room, "%s%s(ends@%" PRIdTIME ")", separator, pid, r->a);
+        return snprintf(buf, room, "%s%s", separator, pid);
+    }
+    case TEXT_CLOSE:
+        return snprintf(buf, room, "]\n");
+    case TEXT_COMPLETED:
+        return snprintf(buf, room, "     Completed: %d/%d\n", (int)r->a, (int)r->b);
+    case TEXT_WAKING:
+        return snprintf(buf, room, "[Time %" PRIdTIME "] CPU: WAKING UP for %s \n", r->time, pid);
+    case TEXT_SLOW:
+        return snprintf(buf, room, "[Time %" PRIdTIME "] CPU: %s at %.1f GHz, no progress this tick \n",
+                        r->time, pid, r->ghz);
+    case TEXT_SWITCHING:
+        return snprintf(buf, room, "[Time %" PRIdTIME "] CPU: SWITCHING to %s \n", r->time, pid);
+    case TEXT_IDLE:
+        return snprintf(buf, room, "[Time %" PRIdTIME "] CPU: IDLE %s\n", r->time, r->s);
+    case TEXT_FINAL:
+        return snprintf(buf, room, "\n=== FINAL: All %d processes completed ===\n", (int)r->a);
+    case TEXT_THROTTLED:
+        return snprintf(buf, room, "  ⏸  %s throttled at %" PRIdTIME ": group %s out of quota until %" PRIdTIME "\n",
+                        pid, r->time, r->s, r->a);
+    case TEXT_UNTHROTTLED:
+        return snprintf(buf, room, "  ▶  %s unthrottled at %" PRIdTIME "\n", pid, r->time);
+    }
+    return 0;
+}
+
+static void emit(TraceRecord *r, const Process *p)
+{
+    if (trace_pipe != NULL)
+    {
+        r->pid_index = p != NULL ? (int)(p - trace_pipe->processes) : -1;
+        tracepipe_push_record(trace_pipe, r);
+        return;
+    }
+
+    static int first = 1;
+    const char *pid = p != NULL ? p->pid : "";
+    char line[LINE_BUFFER_SIZE];
+    int was_first = first;
+    int len = trace_format_line(line, sizeof(line), r, pid, &first);
+    if (len < (int)sizeof(line))
+    {
+        fwrite(line, 1, len, stdout);
+        return;
+    }
+
+    // Long pid or group path: format again into a buffer that fits
+    char *long_line = malloc(len + 1);
+    first = was_first;
+    trace_format_line(long_line, len + 1, r, pid, &first);
+    fwrite(long_line, 1, len, stdout);
+    free(long_line);
+}
+
+void trace_line(text_line_t type, const Process *p, sim_time_t time, sim_time_t a, sim_time_t b)
+{
+    TraceRecord r = {.time = time, .type = type, .a = a, .b = b};
+    emit(&r, p);
+}
+
+void trace_line_str(text_line_t type, const Process *p, sim_time_t time, sim_time_t a, const char *s)
+{
+    TraceRecord r = {.time = time, .type = type, .a = a, .s = s};
+    emit(&r, p);
+}
+
+void trace_line_ghz(text_line_t type, const Process *p, sim_time_t time, double ghz)
+{
+    TraceRecord r = {.time = time, .type = type, .ghz = ghz};
+    emit(&r, p);
+}
+
+// ---------------------------------------------------------------------------
+// Writing
+// ---------------------------------------------------------------------------
+
+static void flush(TraceWriter *w)
+{
+    fwrite(w->buffer, 1, w->used, w->file);
+    w->used = 0;
+}
+
+static void put_varint(TraceWriter *w, uint64_t v)
+{
+    while (v >= 0x80)
+    {
+        w->buffer[w->used++] = (unsigned char)(v | 0x80);
+        v >>= 7;
+    }
+    w->buffer[w->used++] = (unsigned char)v;
+}
+
+int trace_open(const char *path, Process processes[], int num_processes)
+{
+    FILE *f = fopen(path, "wb");
+    if (f == NULL)
+    {
+        perror(path);
+        return -1;
+    }
+
+    TraceWriter *w = calloc(1, sizeof(TraceWriter));
+    w->file = f;
+    w->buffer = malloc(TRACE_BUFFER_SIZE);
+
+    fwrite(TRACE_MAGIC, 1, 4, f);
+    fputc(TRACE_VERSION, f);
+
+    put_varint(w, num_processes);
+    for (int i = 0; i < num_processes; i++)
+    {
+        int len = (int)strlen(processes[i].pid);
+        if (w->used + VARINT_MAX_BYTES + len > TRACE_BUFFER_SIZE)
+            flush(w);
+        put_varint(w, len);
+        if (len > TRACE_BUFFER_SIZE - w->used)
+        {
+            flush(w);
+            fwrite(processes[i].pid, 1, len, f); // absurdly long pid, write through
+            continue;
+        }
+        memcpy(w->buffer + w->used, processes[i].pid, len);
+        w->used += len;
+    }
+
+    trace_writer = w;
+    return 0;
+}
+
+void trace_write(TraceWriter *w, trace_event_t type, int pid_index, sim_time_t time)
+{
+    if (w->used > TRACE_BUFFER_SIZE - 2 * VARINT_MAX_BYTES)
+        flush(w);
+
+    put_varint(w, (uint64_t)(time - w->last_time));
+    put_varint(w, ((unsigned int)pid_index << 3) | type);
+    w->last_time = time;
+    w->events++;
+}
+
+void trace_close(void)
+{
+    TraceWriter *w = trace_writer;
+    if (w == NULL)
+        return;
+
+    flush(w);
+    fclose(w->file);
+    free(w->buffer);
+    free(w);
+    trace_writer = NULL;
+}
+
+// ---------------------------------------------------------------------------
+// Reading / diff
+// ---------------------------------------------------------------------------
+
+typedef struct TraceReader
+{
+    const char *path;
+    FILE *file;
+    int num_processes;
+    char **pids;
+
+    // current event
+    long index;
+    sim_time_t time;
+    int type;
+    int pid_index;
+} TraceReader;
+
+// Returns 0 on success, 1 on clean end of file, -1 on truncation
+static int get_varint(FILE *f, uint64_t *out)
+{
+    uint64_t v = 0;
+    int shift = 0;
+    int c;
+
+    while ((c = fgetc(f)) != EOF)
+    {
+        v |= (uint64_t)(c & 0x7f) << shift;
+        if (!(c & 0x80))
+        {
+            *out = v;
+            return 0;
+        }
+        shift += 7;
+        if (shift > 63)
+            return -1;
+    }
+    return shift == 0 ? 1 : -1;
+}
+
+static void reader_close(TraceReader *r)
+{
+    if (r->pids != NULL)
+    {
+        for (int i = 0; i < r->num_processes; i++)
+            free(r->pids[i]);
+        free(r->pids);
+    }
+    if (r->file != NULL)
+        fclose(r->file);
+}
+
+static int reader_open(TraceReader *r, const char *path)
+{
+    memset(r, 0, sizeof(*r));
+    r->path = path;
+    r->index = -1;
+    r->file = fopen(path, "rb");
+    if (r->file == NULL)
+    {
+        perror(path);
+        return -1;
+    }
+
+    char magic[4];
+    uint64_t count;
+    if (fread(magic, 1, 4, r->file) != 4 || memcmp(magic, TRACE_MAGIC, 4) != 0 ||
+        fgetc(r->file) != TRACE_VERSION || get_varint(r->file, &count) != 0)
+    {
+        fprintf(stderr, "%s: not a scheduler trace\n", path);
+        reader_close(r);
+        return -1;
+    }
+
+    //* The header is untrusted: every pid takes at least its length byte,
+    //* so neither the count nor a length can exceed what is left of the file
+    struct stat st;
+    long offset = ftell(r->file);
+    uint64_t left = fstat(fileno(r->file), &st) == 0 && offset >= 0 && st.st_size > offset ?
+                    (uint64_t)(st.st_size - offset) : 0;
+    if (count > left || count > INT_MAX)
+    {
+        fprintf(stderr, "%s: corrupt header (%" PRIu64 " processes)\n", path, count);
+        reader_close(r);
+        return -1;
+    }
+
+    r->num_processes = (int)count;
+    r->pids = calloc(count, sizeof(char *));
+    for (uint64_t i = 0; i < count; i++)
+    {
+        uint64_t len;
+        if (get_varint(r->file, &len) != 0 || len > left)
+        {
+            fprintf(stderr, "%s: truncated header\n", path);
+            reader_close(r);
+            return -1;
+        }
+        r->pids[i] = calloc(len + 1, 1);
+        if (fread(r->pids[i], 1, len, r->file) != len)
+        {
+            fprintf(stderr, "%s: truncated header\n", path);
+            reader_close(r);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// Returns 0 with the next event loaded, 1 at end of trace, -1 on corruption
+static int reader_next(TraceReader *r)
+{
+    uint64_t delta, packed;
+    int status = get_varint(r->file, &delta);
+    if (status != 0)
+        return status;
+    if (get_varint(r->file, &packed) != 0)
+        return -1;
+
+    if ((packed >> 3) > INT_MAX)
+        return -1;
+
+    r->index++;
+    r->time += (sim_time_t)delta;
+    r->type = packed & 7;
+    r->pid_index = (int)(packed >> 3);
+    return 0;
+}
+
+static void describe(TraceReader *r, int status)
+{
+    if (status == 1)
+    {
+        printf("  %s: <end of trace after %ld events>\n", r->path, r->index + 1);
+        return;
+    }
+
+    const char *pid = r->pid_index >= 0 && r->pid_index < r->num_processes ? r->pids[r->pid_index] : "?";
+    printf("  %s: t=%" PRIdTIME " %-8s %s (#%d)\n", r->path, r->time, trace_event_name(r->type), pid, r->pid_index);
+}
+
+int trace_diff(const char *path_a, const char *path_b)
+{
+    TraceReader a, b;
+    if (reader_open(&a, path_a) != 0)
+        return -1;
+    if (reader_open(&b, path_b) != 0)
+    {
+        reader_close(&a);
+        return -1;
+    }
+
+    if (a.num_processes != b.num_processes)
+        printf("warning: traces cover different workloads (%d vs %d processes)\n",
+               a.num_processes, b.num_processes);
+
+    int result = 0;
+    while (1)
+    {
+        int sa = reader_next(&a);
+        int sb = reader_next(&b);
+
+        if (sa < 0 || sb < 0)
+        {
+            fprintf(stderr, "%s: corrupt or truncated trace\n", sa < 0 ? path_a : path_b);
+            result = -1;
+            break;
+        }
+        if (sa == 1 && sb == 1)
+        {
+            printf("Traces identical (%ld events)\n", a.index + 1);
+            break;
+        }
+        if (sa != sb || a.time != b.time || a.type != b.type || a.pid_index != b.pid_index)
+        {
+            printf("First divergence at event %ld:\n", (sa == 0 ? a.index : b.index));
+            describe(&a, sa);
+            describe(&b, sb);
+            result = 1;
+            break;
+        }
+    }
+
+    reader_close(&a);
+    reader_close(&b);
+    return result;
+}
@@ -0,0 +1,128 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdio.h>
+
+#include "process.h"
+#include "timeline.h"
+#include "tracepipe.h"
+#include "metrics.h"
+#include "progress.h"
+
+//* Per-tick text trace (the printing()/Printing_() blocks). --quiet turns it off.
+extern int trace_text;
+
+//* Text trace lines (and pieces of lines), for trace_line()
+//
+// The engines describe each tick as a sequence of these instead of calling
+// printf. Without the trace pipe each one is formatted and written to
+// stdout at once; with it, it is queued as a fixed-size record and the
+// writer thread formats it, so the text trace never blocks the simulation
+// on stdout. Both paths go through trace_format_line(), so they print the
+// same bytes.
+typedef enum {
+    TEXT_TICK = 8,          // "=== Time t ===" (after the trace_event_t types)
+    TEXT_IO_DONE,           // a = next CPU burst (-1 = finished), b = its length
+    TEXT_ARRIVED,
+    TEXT_ARRIVED_PRIO,      // a = priority
+    TEXT_ASSIGNED,          // "CPU assigned to pid (" ...
+    TEXT_PRIORITY,          // ... "priority a, " ...
+    TEXT_ASSIGNED_REST,     // ... "burst a, duration: b)"
+    TEXT_EXECUTING,         // a = remaining
+    TEXT_WILL_FINISH,
+    TEXT_WILL_IO,           // a = I/O length
+    TEXT_IDLE_NOTE,         // "CPU: IDLE" in the state dump
+    TEXT_STATE,             // "System State:" and "Running: "
+    TEXT_RUNNING,           // "pid (" ...
+    TEXT_RUNNING_REST,      // ... "burst a, remaining: b after execution)"
+    TEXT_RUNNING_NONE,
+    TEXT_READY_OPEN,        // "Ready Queue: ["
+    TEXT_BLOCKED_OPEN,      // "Blocked (I/O): ["
+    TEXT_ITEM,              // list entries, comma-separated: pid
+    TEXT_ITEM_PRIO,         // pid(pa)
+    TEXT_ITEM_QUEUED,       // pid(queued)
+    TEXT_ITEM_ENDS,         // pid(ends@a)
+    TEXT_CLOSE,             // "]"
+    TEXT_COMPLETED,         // "Completed: a/b"
+    TEXT_WAKING,            // "[Time t] CPU: WAKING UP for pid"
+    TEXT_SLOW,              // "[Time t] CPU: pid at ghz GHz, no progress this tick"
+    TEXT_SWITCHING,         // "[Time t] CPU: SWITCHING to pid"
+    TEXT_IDLE,              // "[Time t] CPU: IDLE s" (s = idle state label)
+    TEXT_FINAL,             // a = completed
+    TEXT_THROTTLED,         // at t, a = period end, s = group path
+    TEXT_UNTHROTTLED
+} text_line_t;
+
+// Emit one text line; p may be NULL for lines without a process. s must
+// be a string that outlives the run (labels, group paths).
+void trace_line(text_line_t type, const Process *p, sim_time_t time, sim_time_t a, sim_time_t b);
+void trace_line_str(text_line_t type, const Process *p, sim_time_t time, sim_time_t a, const char *s);
+void trace_line_ghz(text_line_t type, const Process *p, sim_time_t time, double ghz);
+
+// Format r like snprintf, returning the length it needs; pid is r's
+// process's. *first carries the list separator state from one record to
+// the next.
+int trace_format_line(char *buf, size_t room, const TraceRecord *r, const char *pid, int *first);
+
+//* Binary event trace
+//
+// File layout:
+//   "SCHT" <version byte> <varint num_processes> { <varint len> <pid bytes> }...
+//   then one record per event:
+//   <varint time delta since previous event> <varint (pid_index << 3) | type>
+//
+// pid_index is the process's position in the workload array and time is the
+// tick boundary where the transition takes effect (a burst that ends during
+// tick t blocks/finishes at t + 1). Two runs that schedule identically
+// produce byte-identical traces.
+
+typedef enum {
+    TRACE_DISPATCH = 1,
+    TRACE_PREEMPT,
+    TRACE_BLOCK,
+    TRACE_UNBLOCK,
+    TRACE_FINISH
+} trace_event_t;
+
+typedef struct TraceWriter
+{
+    FILE *file;
+    unsigned char *buffer;
+    int used;
+    sim_time_t last_time;
+    long events;
+} TraceWriter;
+
+extern TraceWriter *trace_writer;
+
+int trace_open(const char *path, Process processes[], int num_processes);
+void trace_close(void);
+
+void trace_write(TraceWriter *w, trace_event_t type, int pid_index, sim_time_t time);
+
+// Hot-path hook for every state transition: feeds the run metrics, the
+// binary trace and the timeline export, a couple of branches when all are
+// off. With the trace pipe on, output only queues a record for the writer
+// thread. --progress counts it.
+static inline void trace_event(trace_event_t type, int pid_index, sim_time_t time)
+{
+    metrics_event(type, pid_index, time);
+    progress_event();
+    if (trace_pipe != NULL)
+    {
+        tracepipe_push(trace_pipe, type, pid_index, time);
+        return;
+    }
+    if (trace_writer != NULL)
+        trace_write(trace_writer, type, pid_index, time);
+    if (timeline != NULL)
+        timeline_event(timeline, type, pid_index, time);
+}
+
+const char *trace_event_name(int type);
+
+// Compare two trace files; prints the first divergence.
+// Returns 0 if identical, 1 if they differ, -1 on read error.
+int trace_diff(const char *path_a, const char *path_b);
+
+#endif
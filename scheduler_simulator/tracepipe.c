@@ -0,0 +1,288 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sched.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "tracepipe.h"
+#include "trace.h"
+#include "timeline.h"
+
+#define LOG_BUFFER_SIZE (1 << 20)
+#define TEXT_BUFFER_SIZE (1 << 20)
+#define PUBLISH_EVERY 1024      // records consumed between head updates
+#define SPIN_ROUNDS 64          // empty polls before the writer starts sleeping
+
+TracePipe *trace_pipe = NULL;
+
+static pthread_t writer;
+
+//* Text event log, owned by the writer thread
+static int log_fd = -1;
+static char *log_buffer;
+static int log_used;
+static Process *log_processes;
+
+//* Text trace, owned by the writer thread while the pipe is open
+static char *text_buffer;
+static int text_used;
+static int text_first = 1;
+static long text_records;
+
+// Totals kept for tracepipe_report() after the pipe is gone
+static int was_open = 0;
+static long total_records, total_lines, total_dropped, total_stalls;
+static unsigned long total_capacity;
+static pipe_policy_t total_policy;
+
+// ---------------------------------------------------------------------------
+// Writer thread
+// ---------------------------------------------------------------------------
+
+static void write_all(int fd, const char *data, size_t len)
+{
+    while (len > 0)
+    {
+        ssize_t n = write(fd, data, len);
+        if (n < 0)
+        {
+            perror("event log");
+            return;
+        }
+        data += n;
+        len -= n;
+    }
+}
+
+static void log_flush(void)
+{
+    write_all(log_fd, log_buffer, log_used);
+    log_used = 0;
+}
+
+static void log_record(const TraceRecord *r)
+{
+    const char *pid = log_processes[r->pid_index].pid;
+    int room = LOG_BUFFER_SIZE - log_used;
+    int len = snprintf(log_buffer + log_used, room, "%" PRIdTIME " %s %s\n", r->time, trace_event_name(r->type), pid);
+
+    if (len >= room)
+    {
+        log_flush();
+        len = snprintf(log_buffer, LOG_BUFFER_SIZE, "%" PRIdTIME " %s %s\n", r->time, trace_event_name(r->type), pid);
+        if (len >= LOG_BUFFER_SIZE)
+        {
+            dprintf(log_fd, "%" PRIdTIME " %s %s\n", r->time, trace_event_name(r->type), pid); // absurdly long pid
+            len = 0;
+        }
+    }
+    log_used += len;
+}
+
+static void text_flush(void)
+{
+    write_all(STDOUT_FILENO, text_buffer, text_used);
+    text_used = 0;
+}
+
+static void text_record(const TracePipe *pipe, const TraceRecord *r)
+{
+    const char *pid = r->pid_index >= 0 ? pipe->processes[r->pid_index].pid : "";
+    int was_first = text_first;
+    int room = TEXT_BUFFER_SIZE - text_used;
+    int len = trace_format_line(text_buffer + text_used, room, r, pid, &text_first);
+
+    if (len >= room)
+    {
+        text_flush();
+        text_first = was_first;
+        len = trace_format_line(text_buffer, TEXT_BUFFER_SIZE, r, pid, &text_first);
+        if (len >= TEXT_BUFFER_SIZE)
+        {
+            char *line = malloc(len + 1);   // absurdly long pid or group path
+            text_first = was_first;
+            trace_format_line(line, len + 1, r, pid, &text_first);
+            write_all(STDOUT_FILENO, line, len);
+            free(line);
+            len = 0;
+        }
+    }
+    text_used += len;
+}
+
+static void consume(const TracePipe *pipe, const TraceRecord *r)
+{
+    if (r->type >= TEXT_TICK)
+    {
+        text_records++;
+        text_record(pipe, r);
+        return;
+    }
+    if (trace_writer != NULL)
+        trace_write(trace_writer, r->type, r->pid_index, r->time);
+    if (timeline != NULL)
+        timeline_event(timeline, r->type, r->pid_index, r->time);
+    if (log_fd >= 0)
+        log_record(r);
+}
+
+static void backoff(int *idle)
+{
+    if (++*idle < SPIN_ROUNDS)
+    {
+        sched_yield();
+        return;
+    }
+    struct timespec pause = {0, 100 * 1000};
+    nanosleep(&pause, NULL);
+}
+
+static void *writer_main(void *arg)
+{
+    TracePipe *pipe = arg;
+    unsigned long head = atomic_load_explicit(&pipe->head, memory_order_relaxed);
+    int idle = 0;
+
+    while (1)
+    {
+        unsigned long tail = atomic_load_explicit(&pipe->tail, memory_order_acquire);
+
+        if (head == tail)
+        {
+            // closing is set after the last push, so one more look at the
+            // tail after seeing it catches everything
+            if (atomic_load_explicit(&pipe->closing, memory_order_acquire) &&
+                atomic_load_explicit(&pipe->tail, memory_order_acquire) == head)
+                break;
+            backoff(&idle);
+            continue;
+        }
+        idle = 0;
+
+        while (head != tail)
+        {
+            consume(pipe, &pipe->ring[head & pipe->mask]);
+            head++;
+            if ((head & (PUBLISH_EVERY - 1)) == 0)
+                atomic_store_explicit(&pipe->head, head, memory_order_release);
+        }
+        atomic_store_explicit(&pipe->head, head, memory_order_release);
+    }
+
+    if (log_fd >= 0)
+        log_flush();
+    text_flush();
+    return NULL;
+}
+
+// ---------------------------------------------------------------------------
+// Simulation side
+// ---------------------------------------------------------------------------
+
+void tracepipe_wait(TracePipe *pipe)
+{
+    unsigned long tail = atomic_load_explicit(&pipe->tail, memory_order_relaxed);
+    pipe->stalls++;
+
+    do
+    {
+        sched_yield();
+        pipe->head_cache = atomic_load_explicit(&pipe->head, memory_order_acquire);
+    } while (tail - pipe->head_cache > pipe->mask);
+}
+
+int tracepipe_open(int capacity, pipe_policy_t policy, const char *event_log, Process processes[])
+{
+    if (event_log != NULL)
+    {
+        log_fd = open(event_log, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (log_fd < 0)
+        {
+            perror(event_log);
+            return -1;
+        }
+        log_buffer = malloc(LOG_BUFFER_SIZE);
+        log_used = 0;
+        log_processes = processes;
+        write_all(log_fd, "# time event pid\n", 17);
+    }
+
+    unsigned long size = 1;
+    while (size < (unsigned long)(capacity > 1 ? capacity : 2))
+        size <<= 1;
+
+    TracePipe *pipe = aligned_alloc(64, sizeof(TracePipe));
+    memset(pipe, 0, sizeof(*pipe));
+    pipe->ring = malloc(size * sizeof(TraceRecord));
+    pipe->mask = size - 1;
+    pipe->policy = policy;
+    pipe->processes = processes;
+
+    //* The writer writes the text trace to stdout directly: whatever is
+    //* still buffered there goes first
+    fflush(stdout);
+    text_buffer = malloc(TEXT_BUFFER_SIZE);
+    text_used = 0;
+    text_first = 1;
+    text_records = 0;
+
+    if (pthread_create(&writer, NULL, writer_main, pipe) != 0)
+    {
+        fprintf(stderr, "trace pipe: cannot start writer thread\n");
+        free(text_buffer);
+        free(pipe->ring);
+        free(pipe);
+        return -1;
+    }
+
+    trace_pipe = pipe;
+    was_open = 1;
+    total_capacity = size;
+    total_policy = policy;
+    return 0;
+}
+
+void tracepipe_close(void)
+{
+    TracePipe *pipe = trace_pipe;
+    if (pipe == NULL)
+        return;
+
+    atomic_store_explicit(&pipe->closing, 1, memory_order_release);
+    pthread_join(writer, NULL);
+    trace_pipe = NULL;
+
+    total_lines = text_records;
+    total_records = (long)atomic_load(&pipe->tail) - total_lines;
+    total_dropped = pipe->dropped;
+    total_stalls = pipe->stalls;
+
+    if (log_fd >= 0)
+    {
+        close(log_fd);
+        free(log_buffer);
+        log_fd = -1;
+    }
+    free(text_buffer);
+    text_buffer = NULL;
+    free(pipe->ring);
+    free(pipe);
+}
+
+void tracepipe_report(void)
+{
+    if (!was_open)
+        return;
+
+    printf("\n=== Trace Pipe ===\n");
+    printf("  ring:     %lu records, %s when full\n", total_capacity,
+           total_policy == PIPE_DROP ? "drop" : "block");
+    printf("  written:  %ld events\n", total_records);
+    if (total_lines > 0)
+        printf("  text:     %ld trace lines\n", total_lines);
+    printf("  dropped:  %ld\n", total_dropped);
+    printf("  stalls:   %ld\n", total_stalls);
+}
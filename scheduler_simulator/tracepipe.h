@@ -0,0 +1,103 @@
+#ifndef TRACEPIPE_H
+#define TRACEPIPE_H
+
+#include <stdatomic.h>
+
+#include "process.h"
+
+//* Asynchronous event output
+//
+// With the pipe on, trace_event() and the per-tick text trace
+// (trace_line(), see trace.h) only store a fixed-size record in a
+// single-producer/single-consumer ring. A writer thread drains the ring
+// and does everything else: binary trace encoding (--trace), timeline
+// spans (--timeline*), the text event log (--event-log) and the text
+// trace, which it formats into large buffers and hands to write(2) in
+// big chunks (the text trace to stdout).
+//
+// When the ring is full the simulation thread either waits for the
+// writer (block, lossless) or throws the record away and counts it
+// (drop, the simulation never waits; --trace/--timeline lose events and
+// the text trace loses lines).
+
+typedef enum {
+    PIPE_BLOCK, PIPE_DROP
+} pipe_policy_t;
+
+typedef struct TraceRecord
+{
+    sim_time_t time;
+    int pid_index;          // -1 = no process (text lines)
+    int type;               // trace_event_t, or a text line's text_line_t
+
+    //* Text lines only: their numbers, or a frequency or static string
+    sim_time_t a;
+    union {
+        sim_time_t b;
+        double ghz;
+        const char *s;
+    };
+} TraceRecord;
+
+typedef struct TracePipe
+{
+    //* Producer side (simulation thread)
+    _Alignas(64) _Atomic unsigned long tail;
+    unsigned long head_cache;   // last head seen, re-read only when the ring looks full
+    long dropped;
+    long stalls;                // pushes that had to wait (block policy)
+
+    //* Consumer side (writer thread)
+    _Alignas(64) _Atomic unsigned long head;
+    _Atomic int closing;
+
+    _Alignas(64) TraceRecord *ring;
+    unsigned long mask;         // capacity - 1, capacity is a power of two
+    pipe_policy_t policy;
+    Process *processes;         // pid_index base
+} TracePipe;
+
+extern TracePipe *trace_pipe;
+
+// Starts the writer thread. capacity is rounded up to a power of two.
+// event_log may be NULL. Returns 0 on success.
+int tracepipe_open(int capacity, pipe_policy_t policy, const char *event_log, Process processes[]);
+
+// Waits for the writer to drain the ring, then stops it. Call before
+// trace_close()/timeline_close().
+void tracepipe_close(void);
+
+void tracepipe_wait(TracePipe *pipe);
+
+// Hot path: one record store and a release of the tail index
+static inline void tracepipe_push_record(TracePipe *pipe, const TraceRecord *r)
+{
+    unsigned long tail = atomic_load_explicit(&pipe->tail, memory_order_relaxed);
+
+    if (tail - pipe->head_cache > pipe->mask)
+    {
+        pipe->head_cache = atomic_load_explicit(&pipe->head, memory_order_acquire);
+        if (tail - pipe->head_cache > pipe->mask)
+        {
+            if (pipe->policy == PIPE_DROP)
+            {
+                pipe->dropped++;
+                return;
+            }
+            tracepipe_wait(pipe);
+        }
+    }
+
+    pipe->ring[tail & pipe->mask] = *r;
+    atomic_store_explicit(&pipe->tail, tail + 1, memory_order_release);
+}
+
+static inline void tracepipe_push(TracePipe *pipe, int type, int pid_index, sim_time_t time)
+{
+    TraceRecord r = {.time = time, .pid_index = pid_index, .type = type};
+    tracepipe_push_record(pipe, &r);
+}
+
+void tracepipe_report(void);
+
+#endif
@@ -0,0 +1,362 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "workload.h"
+#include "io_device.h"
+#include "priority.h"
+#include "group.h"
+#include "numa.h"
+#include "montecarlo.h"
+#include "arrivals.h"
+#include "packed.h"
+
+#define MAX_TOKENS 4096
+
+static int parse_int(const char *s, int *out)
+{
+    char *end;
+    long v = strtol(s, &end, 10);
+    if (end == s || *end != '\0' || v < 0 || v > __INT_MAX__)
+        return -1;
+    *out = (int)v;
+    return 0;
+}
+
+// "[device:]duration[@position]"
+static int parse_io_burst(char *token, int *device, sim_time_t *duration, int *position)
+{
+    *device = DEFAULT_DEVICE;
+    *position = 0;
+
+    char *at = strchr(token, '@');
+    if (at != NULL)
+    {
+        *at++ = '\0';
+        if (parse_int(at, position) != 0)
+            return -1;
+    }
+
+    char *colon = strchr(token, ':');
+    if (colon != NULL)
+    {
+        *colon++ = '\0';
+        *device = io_find_device(token);
+        if (*device < 0)
+        {
+            fprintf(stderr, "unknown device '%s' (declare it with --devices)\n", token);
+            return -1;
+        }
+        token = colon;
+    }
+
+    return sim_parse_duration(token, duration);
+}
+
+// "key=value" attributes that may follow the bursts
+static int parse_attribute(char *token, Process *p)
+{
+    char *value = strchr(token, '=');
+    *value++ = '\0';
+
+    if (strcmp(token, "prio") == 0)
+    {
+        if (parse_int(value, &p->priority) != 0 || p->priority >= PRIORITY_LEVELS)
+        {
+            fprintf(stderr, "priority must be 0..%d\n", PRIORITY_LEVELS - 1);
+            return -1;
+        }
+        return 0;
+    }
+
+    if (strcmp(token, "job") == 0)
+    {
+        if (parse_int(value, &p->job) != 0 || p->job == 0)
+        {
+            fprintf(stderr, "job must be a positive job number\n");
+            return -1;
+        }
+        return 0;
+    }
+
+    if (strcmp(token, "node") == 0)
+    {
+        if (parse_int(value, &p->home_node) != 0 || p->home_node >= NUMA_MAX_NODES)
+        {
+            fprintf(stderr, "node must be 0..%d\n", NUMA_MAX_NODES - 1);
+            return -1;
+        }
+        return 0;
+    }
+
+    if (strcmp(token, "dist") == 0)
+    {
+        if (mc_parse_dist(value, &p->dist, &p->dist_spread) != 0)
+        {
+            fprintf(stderr, "dist must be fixed, exp, uniform[:P] or normal[:P]\n");
+            return -1;
+        }
+        return 0;
+    }
+
+    if (strcmp(token, "group") == 0)
+    {
+        p->group = group_find(value);
+        if (p->group == NULL)
+        {
+            fprintf(stderr, "unknown group '%s' (declare it with --groups)\n", value);
+            return -1;
+        }
+        return 0;
+    }
+
+    fprintf(stderr, "unknown attribute '%s'\n", token);
+    return -1;
+}
+
+static int parse_process(char *line, Process *p)
+{
+    char *tokens[MAX_TOKENS];
+    int num_tokens = 0;
+    char *save = NULL;
+
+    memset(p, 0, sizeof(*p));
+    p->home_node = -1;
+
+    char *attributes[MAX_TOKENS];
+    int num_attributes = 0;
+
+    for (char *t = strtok_r(line, " \t\r\n", &save); t != NULL; t = strtok_r(NULL, " \t\r\n", &save))
+    {
+        if (num_tokens == MAX_TOKENS || num_attributes == MAX_TOKENS)
+            return -1;
+        if (strchr(t, '=') != NULL)
+            attributes[num_attributes++] = t;
+        else
+            tokens[num_tokens++] = t;
+    }
+
+    // pid, arrival and an odd number of bursts (CPU, I/O, CPU, ...)
+    if (num_tokens < 3 || (num_tokens - 2) % 2 == 0)
+        return -1;
+
+    p->num_bursts = (num_tokens - 1) / 2;
+    p->pid = strdup(tokens[0]);
+    p->cpu_bursts = malloc(p->num_bursts * sizeof(sim_time_t));
+
+    if (p->num_bursts > 1)
+    {
+        p->io_times = malloc((p->num_bursts - 1) * sizeof(sim_time_t));
+        p->io_devices = malloc((p->num_bursts - 1) * sizeof(int));
+        p->io_positions = malloc((p->num_bursts - 1) * sizeof(int));
+    }
+
+    if (sim_parse_duration(tokens[1], &p->arrival_time) != 0)
+        return -1;
+
+    for (int b = 0; b < p->num_bursts; b++)
+    {
+        if (sim_parse_duration(tokens[2 + 2 * b], &p->cpu_bursts[b]) != 0 || p->cpu_bursts[b] == 0)
+            return -1;
+
+        if (b < p->num_bursts - 1 &&
+            parse_io_burst(tokens[3 + 2 * b], &p->io_devices[b], &p->io_times[b], &p->io_positions[b]) != 0)
+            return -1;
+    }
+
+    for (int a = 0; a < num_attributes; a++)
+    {
+        if (parse_attribute(attributes[a], p) != 0)
+            return -1;
+    }
+
+    workload_set_service(p);
+    p->current_burst = 0;
+    p->remaining_time = p->cpu_bursts[0];
+    p->state = READY;
+    p->io_end_time = -1;
+    p->last_cpu = -1;
+    return 0;
+}
+
+static void free_process(Process *p)
+{
+    free(p->pid);
+    free(p->cpu_bursts);
+    free(p->io_times);
+    free(p->io_devices);
+    free(p->io_positions);
+}
+
+int load_workload(const char *path, Process **processes, int *num_processes)
+{
+    //* Packed binary workloads are stored ready to use, in their own order
+    if (packed_detect(path))
+        return packed_load(path, processes, num_processes);
+
+    //* --sort-workload: read the arrival-sorted copy, built on first use
+    char *sorted = NULL;
+    if (arrivals_sort_enabled())
+    {
+        if ((sorted = arrivals_sorted_workload(path)) == NULL)
+            return -1;
+        path = sorted;
+    }
+
+    FILE *f = fopen(path, "r");
+    if (f == NULL)
+    {
+        perror(path);
+        free(sorted);
+        return -1;
+    }
+    sim_rounded_durations(NULL);    // only this file's, not the sort's
+
+    Process *list = NULL;
+    int count = 0;
+    int capacity = 0;
+
+    char *line = NULL;
+    size_t line_capacity = 0;
+    int line_no = 0;
+
+    while (getline(&line, &line_capacity, f) != -1)
+    {
+        line_no++;
+
+        char *comment = strchr(line, '#');
+        if (comment != NULL)
+            *comment = '\0';
+        if (strspn(line, " \t\r\n") == strlen(line))
+            continue; // blank line
+
+        if (count == capacity)
+        {
+            capacity = capacity ? capacity * 2 : 64;
+            list = realloc(list, capacity * sizeof(Process));
+        }
+
+        if (parse_process(line, &list[count]) != 0)
+        {
+            fprintf(stderr, "%s:%d: malformed process line\n", path, line_no);
+            free_process(&list[count]);
+            free_workload(list, count);
+            free(line);
+            fclose(f);
+            free(sorted);
+            return -1;
+        }
+        count++;
+    }
+
+    free(line);
+    fclose(f);
+
+    if (count == 0)
+    {
+        fprintf(stderr, "%s: workload has no processes\n", path);
+        free(list);
+        free(sorted);
+        return -1;
+    }
+    free(sorted);
+
+    int64_t first_ns;
+    long rounded = sim_rounded_durations(&first_ns);
+    if (rounded > 0)
+        fprintf(stderr, "%s: warning: %ld duration%s not a whole number of %" PRId64 "ns ticks"
+                " (first: %" PRId64 "ns), rounded; a finer --tick keeps them exact\n",
+                path, rounded, rounded == 1 ? " is" : "s are", sim_tick_ns, first_ns);
+
+    *processes = list;
+    *num_processes = count;
+    return 0;
+}
+
+static void write_process(FILE *f, const Process *p)
+{
+    fprintf(f, "%s %" PRIdTIME " %" PRIdTIME, p->pid, p->arrival_time, p->cpu_bursts[0]);
+    for (int b = 1; b < p->num_bursts; b++)
+    {
+        int device = p->io_devices != NULL ? p->io_devices[b - 1] : DEFAULT_DEVICE;
+        int position = p->io_positions != NULL ? p->io_positions[b - 1] : 0;
+
+        fputc(' ', f);
+        if (device != DEFAULT_DEVICE)
+            fprintf(f, "%s:", io_device_name(device));
+        fprintf(f, "%" PRIdTIME, p->io_times[b - 1]);
+        if (position != 0)
+            fprintf(f, "@%d", position);
+        fprintf(f, " %" PRIdTIME, p->cpu_bursts[b]);
+    }
+
+    if (p->priority != 0)
+        fprintf(f, " prio=%d", p->priority);
+    if (p->group != NULL)
+        fprintf(f, " group=%s", p->group->path);
+    if (p->job != 0)
+        fprintf(f, " job=%d", p->job);
+    if (p->home_node >= 0)
+        fprintf(f, " node=%d", p->home_node);
+    if (p->dist == DIST_UNIFORM || p->dist == DIST_NORMAL)
+        fprintf(f, " dist=%s:%d", mc_dist_name(p->dist), p->dist_spread);
+    else if (p->dist != DIST_DEFAULT)
+        fprintf(f, " dist=%s", mc_dist_name(p->dist));
+    fputc('\n', f);
+}
+
+int save_workload(const char *path, const Process processes[], int num_processes)
+{
+    FILE *f = fopen(path, "w");
+    if (f == NULL)
+    {
+        perror(path);
+        return -1;
+    }
+
+    for (int i = 0; i < num_processes; i++)
+        write_process(f, &processes[i]);
+
+    int failed = ferror(f);
+    if (fclose(f) != 0 || failed)
+    {
+        perror(path);
+        return -1;
+    }
+    return 0;
+}
+
+void workload_set_service(Process *p)
+{
+    p->service = 0;
+    for (int b = 0; b < p->num_bursts; b++)
+        p->service += p->cpu_bursts[b];
+}
+
+void workload_reset(Process *processes, int num_processes)
+{
+    for (int i = 0; i < num_processes; i++)
+    {
+        Process *p = &processes[i];
+        p->current_burst = 0;
+        p->remaining_time = p->cpu_bursts[0];
+        p->state = READY;
+        p->io_end_time = -1;
+        p->last_cpu = -1;
+        p->last_ran = 0;
+        p->burst_estimate = 0.0f;
+        p->burst_error = 0.0f;
+        p->prio_key = 0;
+        p->next_ready = NULL;
+        p->rq_prev = p->rq_next = NULL;
+        p->completed_flag = 0;
+        p->in_queue = 0;
+    }
+}
+
+void free_workload(Process *processes, int num_processes)
+{
+    for (int i = 0; i < num_processes; i++)
+        free_process(&processes[i]);
+    free(processes);
+}
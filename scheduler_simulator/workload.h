@@ -0,0 +1,55 @@
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include "process.h"
+
+// Workload file format, one process per line ('#' starts a comment):
+//
+//   <pid> <arrival> <cpu> [<io> <cpu>]...
+//
+// Times are ticks, or durations with a unit (ns, us, ms, s) converted at
+// the --tick length: P1 0 250us 1.2ms 80us.
+//
+// An I/O burst may be tagged with the device that serves it and, for
+// elevator-scheduled devices, a seek position:
+//
+//   P1 0  3 disk:2@120 2 net:4 1
+//   P2 2  3 1 1                    <- untagged I/O: unlimited default device
+//
+// key=value attributes may appear anywhere after the pid:
+//
+//   prio=N      base priority for --algorithm PRIORITY (0 = highest, default 0)
+//   group=PATH  CPU bandwidth group, e.g. group=web/api (default: root)
+//   job=N       thread of parallel job N, gang-scheduled by --algorithm GANG
+//               (default: a single-thread job of its own)
+//   node=N      NUMA node holding its memory, with --numa (default: the
+//               node it first runs on)
+//   dist=D      burst distribution for --replications: fixed, exp,
+//               uniform[:P] or normal[:P] (default: --burst-dist)
+//
+// Devices (--devices) and groups (--groups) must be declared before the
+// workload is loaded. With --sort-workload the processes are read from an
+// arrival-sorted copy of the file (see arrivals.h), so they are numbered
+// and reported in arrival order. A packed workload (see packed.h) is
+// recognized by its contents and loaded as it is, without sorting.
+// Returns 0 on success; on error prints the offending line and returns -1.
+int load_workload(const char *path, Process **processes, int *num_processes);
+
+void free_workload(Process *processes, int num_processes);
+
+// Write processes back out in the text format (--unpack-workload), one
+// line each: times in ticks (reload it at the same --tick), single
+// spaces, a device tag or seek position only where there is one, and the
+// attributes that are set, in the order prio, group, job, node, dist.
+// Returns 0 on success; on error says why and returns -1.
+int save_workload(const char *path, const Process processes[], int num_processes);
+
+// Sum p's CPU bursts into p->service. The loaders call it once per
+// process, and whatever redraws the bursts calls it again.
+void workload_set_service(Process *p);
+
+// Put every process back in its pre-run state so the same workload can be
+// simulated again
+void workload_reset(Process *processes, int num_processes);
+
+#endif